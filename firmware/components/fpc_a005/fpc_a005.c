@@ -68,6 +68,7 @@ struct fpc_a005_dev_s {
 };
 
 // Helper functions
+static esp_err_t fpc_a005_transmit(fpc_a005_handle_t handle, spi_transaction_t *trans);
 static esp_err_t fpc_a005_write_cmd(fpc_a005_handle_t handle, uint8_t cmd);
 static esp_err_t fpc_a005_write_data(fpc_a005_handle_t handle, const uint8_t *data, size_t len);
 static esp_err_t fpc_a005_reset(fpc_a005_handle_t handle);
@@ -209,6 +210,19 @@ esp_err_t fpc_a005_deinit(fpc_a005_handle_t handle) {
     return ESP_OK;
 }
 
+static esp_err_t fpc_a005_transmit(fpc_a005_handle_t handle, spi_transaction_t *trans) {
+    if (handle->config.bus_hook) {
+        handle->config.bus_hook(true, handle->config.bus_hook_arg);
+    }
+    
+    esp_err_t ret = spi_device_transmit(handle->spi_handle, trans);
+    
+    if (handle->config.bus_hook) {
+        handle->config.bus_hook(false, handle->config.bus_hook_arg);
+    }
+    return ret;
+}
+
 static esp_err_t fpc_a005_write_cmd(fpc_a005_handle_t handle, uint8_t cmd) {
     gpio_set_level(handle->config.dc_io, 0); // Command mode
     
@@ -217,7 +231,7 @@ static esp_err_t fpc_a005_write_cmd(fpc_a005_handle_t handle, uint8_t cmd) {
         .tx_buffer = &cmd,
     };
     
-    return spi_device_transmit(handle->spi_handle, &trans);
+    return fpc_a005_transmit(handle, &trans);
 }
 
 static esp_err_t fpc_a005_write_data(fpc_a005_handle_t handle, const uint8_t *data, size_t len) {
@@ -230,7 +244,7 @@ static esp_err_t fpc_a005_write_data(fpc_a005_handle_t handle, const uint8_t *da
         .tx_buffer = data,
     };
     
-    return spi_device_transmit(handle->spi_handle, &trans);
+    return fpc_a005_transmit(handle, &trans);
 }
 
 static esp_err_t fpc_a005_reset(fpc_a005_handle_t handle) {
@@ -463,6 +477,30 @@ esp_err_t fpc_a005_draw_bitmap(fpc_a005_handle_t handle, uint16_t x, uint16_t y,
     return ESP_OK;
 }
 
+esp_err_t fpc_a005_hash_region(fpc_a005_handle_t handle, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint32_t *hash) {
+    if (!handle || !handle->is_initialized || !hash) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // FNV-1a over the packed bytes of each row; two pixels per byte
+    uint32_t value = 2166136261u;
+    if (x < FPC_A005_WIDTH && y < FPC_A005_HEIGHT && w > 0 && h > 0) {
+        uint16_t x_end = (x + w > FPC_A005_WIDTH) ? FPC_A005_WIDTH : x + w;
+        uint16_t y_end = (y + h > FPC_A005_HEIGHT) ? FPC_A005_HEIGHT : y + h;
+        
+        for (uint16_t py = y; py < y_end; py++) {
+            uint32_t first = (py * FPC_A005_WIDTH + x) / 2;
+            uint32_t last = (py * FPC_A005_WIDTH + x_end - 1) / 2;
+            for (uint32_t i = first; i <= last; i++) {
+                value = (value ^ handle->framebuffer[i]) * 16777619u;
+            }
+        }
+    }
+    
+    *hash = value;
+    return ESP_OK;
+}
+
 esp_err_t fpc_a005_refresh(fpc_a005_handle_t handle, fpc_a005_refresh_mode_t mode) {
     if (!handle || !handle->is_initialized) {
         return ESP_ERR_INVALID_ARG;
@@ -36,6 +36,9 @@ typedef enum {
     FPC_A005_REFRESH_FAST      // Fast refresh (local update)
 } fpc_a005_refresh_mode_t;
 
+// Called with true before and false after each SPI transfer, e.g. to hold a clock lock
+typedef void (*fpc_a005_bus_hook_t)(bool active, void *arg);
+
 // Configuration structure
 typedef struct {
     spi_host_device_t spi_host;
@@ -46,6 +49,8 @@ typedef struct {
     int rst_io;
     int busy_io;
     int spi_clock_speed_hz;
+    fpc_a005_bus_hook_t bus_hook;   // Optional; not held while waiting for BUSY
+    void *bus_hook_arg;
 } fpc_a005_config_t;
 
 // Device handle
@@ -143,6 +148,23 @@ esp_err_t fpc_a005_draw_circle(fpc_a005_handle_t handle, uint16_t x, uint16_t y,
  */
 esp_err_t fpc_a005_draw_bitmap(fpc_a005_handle_t handle, uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t *bitmap);
 
+/**
+ * @brief Hash the framebuffer contents of a region
+ *
+ * Lets callers tell whether a redraw actually changed any pixels before
+ * paying for a panel refresh. Edge bytes shared with neighbouring pixels
+ * are included, so a change just outside the region may also show up.
+ *
+ * @param handle Device handle
+ * @param x X coordinate
+ * @param y Y coordinate
+ * @param w Width
+ * @param h Height
+ * @param hash Output hash
+ * @return ESP_OK on success
+ */
+esp_err_t fpc_a005_hash_region(fpc_a005_handle_t handle, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint32_t *hash);
+
 /**
  * @brief Refresh the display
  * @param handle Device handle
@@ -28,8 +28,11 @@ extern "C" {
 // Maximum text length per element
 #define PIN_CANVAS_MAX_TEXT_LEN 512
 
-// Maximum image size (64KB)
-#define PIN_CANVAS_MAX_IMAGE_SIZE (64 * 1024)
+// Images live on the SPIFFS partition; their size is limited by free flash
+#define PIN_CANVAS_SPIFFS_BASE_PATH "/spiffs"
+
+// Maximum canvases tracked by the metadata index
+#define PIN_CANVAS_INDEX_MAX 50
 
 // Canvas element types
 typedef enum {
@@ -143,9 +146,29 @@ typedef struct {
     pin_canvas_element_t elements[PIN_CANVAS_MAX_ELEMENTS];
 } pin_canvas_t;
 
+// Canvas summary kept in the metadata index
+typedef struct {
+    char id[32];
+    char name[64];
+    uint32_t created_time;
+    uint32_t modified_time;
+    uint16_t element_count;
+} pin_canvas_meta_t;
+
+// Stored image details
+typedef struct {
+    pin_canvas_image_format_t format;  // Detected from the data
+    size_t size;
+    uint32_t stored_time;
+    uint8_t sha256[32];
+} pin_canvas_image_info_t;
+
 // Canvas manager handle
 typedef struct pin_canvas_manager* pin_canvas_handle_t;
 
+// Image being streamed to flash
+typedef struct pin_canvas_image_writer* pin_canvas_image_writer_t;
+
 // Render callback function
 typedef esp_err_t (*pin_canvas_render_callback_t)(const uint8_t* buffer, size_t size);
 
@@ -236,16 +259,59 @@ esp_err_t pin_canvas_update_element(pin_canvas_handle_t handle, const char* canv
 esp_err_t pin_canvas_remove_element(pin_canvas_handle_t handle, const char* canvas_id, const char* element_id);
 
 /**
- * @brief Store image data for canvas elements
+ * @brief Start storing an image that arrives in pieces
+ * 
+ * Data is written to a temporary file as it comes in, hashed and checked
+ * for its format on the way; an image with the same ID stays readable
+ * until pin_canvas_image_commit() replaces it.
  * 
  * @param handle Canvas manager handle
  * @param image_id Unique image identifier
- * @param data Image data buffer
- * @param size Image data size
- * @param format Image format
- * @return ESP_OK on success
+ * @param size Total image size in bytes
+ * @param writer Output writer
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the image does not fit in free flash,
+ *         ESP_ERR_INVALID_STATE if image storage is not mounted
+ */
+esp_err_t pin_canvas_image_begin(pin_canvas_handle_t handle, const char* image_id, size_t size,
+                                 pin_canvas_image_writer_t* writer);
+
+/**
+ * @brief Append the next piece of image data
+ * 
+ * @param writer Image writer
+ * @param data Image data
+ * @param len Length of data
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE past the size given to begin
  */
-esp_err_t pin_canvas_store_image(pin_canvas_handle_t handle, const char* image_id, const uint8_t* data, size_t size, pin_canvas_image_format_t format);
+esp_err_t pin_canvas_image_write(pin_canvas_image_writer_t writer, const uint8_t* data, size_t len);
+
+/**
+ * @brief Finish the image and make it visible under its ID
+ * 
+ * The writer is released whatever the result.
+ * 
+ * @param writer Image writer
+ * @param info Output details of the stored image (optional)
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if fewer bytes than announced were written
+ */
+esp_err_t pin_canvas_image_commit(pin_canvas_image_writer_t writer, pin_canvas_image_info_t* info);
+
+/**
+ * @brief Drop a partly written image and release the writer
+ * 
+ * @param writer Image writer
+ */
+void pin_canvas_image_abort(pin_canvas_image_writer_t writer);
+
+/**
+ * @brief Get details of a stored image without reading its data
+ * 
+ * @param handle Canvas manager handle
+ * @param image_id Image identifier
+ * @param info Output details
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if there is no such image
+ */
+esp_err_t pin_canvas_get_image_info(pin_canvas_handle_t handle, const char* image_id, pin_canvas_image_info_t* info);
 
 /**
  * @brief Delete stored image
@@ -286,6 +352,25 @@ esp_err_t pin_canvas_display(pin_canvas_handle_t handle, const char* canvas_id);
  */
 esp_err_t pin_canvas_list(pin_canvas_handle_t handle, char canvas_ids[][32], size_t max_count, size_t* count);
 
+/**
+ * @brief List canvas summaries from the metadata index
+ * 
+ * No canvas is loaded; the index is kept in RAM and persisted whenever a
+ * canvas is created, updated or deleted. Entries keep creation order, so
+ * offset-based pages stay stable while canvases are edited.
+ * 
+ * @param handle Canvas manager handle
+ * @param modified_since Only canvases modified at or after this time (0 for all)
+ * @param offset Number of matching entries to skip
+ * @param metas Output array
+ * @param max_count Size of metas
+ * @param count Number of entries written to metas
+ * @param total Number of matching entries in all (optional)
+ * @return ESP_OK on success
+ */
+esp_err_t pin_canvas_list_meta(pin_canvas_handle_t handle, uint32_t modified_since, size_t offset,
+                               pin_canvas_meta_t* metas, size_t max_count, size_t* count, size_t* total);
+
 /**
  * @brief Export canvas as JSON
  * 
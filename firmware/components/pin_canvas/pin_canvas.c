@@ -3,11 +3,15 @@
  * @brief Pin Canvas API Implementation
  */
 
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
@@ -15,25 +19,76 @@
 #include "esp_err.h"
 #include "nvs_flash.h"
 #include "nvs.h"
+#include "esp_spiffs.h"
+#include "mbedtls/sha256.h"
 #include "cJSON.h"
 #include "pin_canvas.h"
 
 static const char* TAG = "PIN_CANVAS";
 
 #define NVS_CANVAS_NAMESPACE "pin_canvas"
-#define NVS_IMAGE_NAMESPACE "pin_images"
+#define NVS_INDEX_NAMESPACE "pin_canvas_idx"
+#define NVS_INDEX_KEY "index"
+#define CANVAS_INDEX_VERSION 1
+
+// Metadata index, persisted as one blob holding the header and the used entries
+typedef struct {
+    uint16_t version;
+    uint16_t count;
+    pin_canvas_meta_t entries[PIN_CANVAS_INDEX_MAX];
+} canvas_index_t;
+
+#define CANVAS_INDEX_SIZE(count) (offsetof(canvas_index_t, entries) + (count) * sizeof(pin_canvas_meta_t))
+
+#define CANVAS_IMAGE_PARTITION "spiffs"
+#define NVS_LEGACY_IMAGE_NAMESPACE "pin_images"  // Where images lived before SPIFFS
+#define CANVAS_IMAGE_DIR "i"            // Committed images
+#define CANVAS_IMAGE_TEMP_DIR "t"       // Uploads in progress
+#define CANVAS_IMAGE_MAGIC 0x474D4950   // "PIMG"
+#define CANVAS_IMAGE_VERSION 1
+
+// Image files: the header is rewritten with the final details on commit
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t format;
+    uint32_t size;
+    uint32_t stored_time;
+    uint8_t sha256[32];
+} canvas_image_header_t;
+
+struct pin_canvas_image_writer {
+    pin_canvas_handle_t handle;
+    int fd;
+    char image_id[32];
+    size_t expected;
+    size_t written;
+    uint8_t head[8];            // First bytes, enough to tell the format
+    mbedtls_sha256_context sha;
+};
 
 // Internal canvas manager structure
 struct pin_canvas_manager {
     fpc_a005_handle_t display_handle;
     SemaphoreHandle_t mutex;
     nvs_handle_t canvas_nvs_handle;
-    nvs_handle_t image_nvs_handle;
+    nvs_handle_t index_nvs_handle;
+    canvas_index_t* index;
     uint8_t* render_buffer;
+    bool images_mounted;
     bool initialized;
 };
 
 // Static functions
+static esp_err_t canvas_index_load(pin_canvas_handle_t handle);
+static esp_err_t canvas_index_rebuild(pin_canvas_handle_t handle);
+static esp_err_t canvas_index_save(pin_canvas_handle_t handle);
+static int canvas_index_find(pin_canvas_handle_t handle, const char* canvas_id);
+static bool canvas_index_has_room(pin_canvas_handle_t handle, const char* canvas_id);
+static esp_err_t canvas_index_put(pin_canvas_handle_t handle, const pin_canvas_t* canvas);
+static esp_err_t canvas_index_remove(pin_canvas_handle_t handle, const char* canvas_id);
+static bool image_storage_mount(void);
+static void image_legacy_erase(void);
 static esp_err_t canvas_to_json(const pin_canvas_t* canvas, cJSON** json);
 static esp_err_t json_to_canvas(const cJSON* json, pin_canvas_t* canvas);
 static esp_err_t render_text_element(uint8_t* buffer, const pin_canvas_element_t* element);
@@ -82,9 +137,17 @@ esp_err_t pin_canvas_init(fpc_a005_handle_t display_handle, pin_canvas_handle_t*
         return ret;
     }
 
-    ret = nvs_open(NVS_IMAGE_NAMESPACE, NVS_READWRITE, &manager->image_nvs_handle);
+    manager->index = calloc(1, sizeof(canvas_index_t));
+    ret = manager->index ? nvs_open(NVS_INDEX_NAMESPACE, NVS_READWRITE, &manager->index_nvs_handle) : ESP_ERR_NO_MEM;
+    if (ret == ESP_OK) {
+        ret = canvas_index_load(manager);
+        if (ret != ESP_OK) {
+            nvs_close(manager->index_nvs_handle);
+        }
+    }
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open image NVS: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "Failed to load canvas index: %s", esp_err_to_name(ret));
+        free(manager->index);
         nvs_close(manager->canvas_nvs_handle);
         vSemaphoreDelete(manager->mutex);
         free(manager->render_buffer);
@@ -92,6 +155,10 @@ esp_err_t pin_canvas_init(fpc_a005_handle_t display_handle, pin_canvas_handle_t*
         return ret;
     }
 
+    // Canvases still work without image storage
+    image_legacy_erase();
+    manager->images_mounted = image_storage_mount();
+
     manager->display_handle = display_handle;
     manager->initialized = true;
     *handle = manager;
@@ -106,8 +173,9 @@ esp_err_t pin_canvas_deinit(pin_canvas_handle_t handle) {
     }
 
     nvs_close(handle->canvas_nvs_handle);
-    nvs_close(handle->image_nvs_handle);
+    nvs_close(handle->index_nvs_handle);
     vSemaphoreDelete(handle->mutex);
+    free(handle->index);
     free(handle->render_buffer);
     free(handle);
 
@@ -126,6 +194,12 @@ esp_err_t pin_canvas_create(pin_canvas_handle_t handle, const char* canvas_id, c
 
     xSemaphoreTake(handle->mutex, portMAX_DELAY);
 
+    if (!canvas_index_has_room(handle, canvas_id)) {
+        xSemaphoreGive(handle->mutex);
+        ESP_LOGE(TAG, "Canvas index is full (%d canvases)", PIN_CANVAS_INDEX_MAX);
+        return ESP_ERR_NO_MEM;
+    }
+
     pin_canvas_t canvas = {0};
     strncpy(canvas.id, canvas_id, sizeof(canvas.id) - 1);
     strncpy(canvas.name, name, sizeof(canvas.name) - 1);
@@ -138,6 +212,9 @@ esp_err_t pin_canvas_create(pin_canvas_handle_t handle, const char* canvas_id, c
     if (ret == ESP_OK) {
         ret = nvs_commit(handle->canvas_nvs_handle);
     }
+    if (ret == ESP_OK) {
+        ret = canvas_index_put(handle, &canvas);
+    }
 
     xSemaphoreGive(handle->mutex);
 
@@ -161,6 +238,9 @@ esp_err_t pin_canvas_delete(pin_canvas_handle_t handle, const char* canvas_id) {
     if (ret == ESP_OK) {
         ret = nvs_commit(handle->canvas_nvs_handle);
     }
+    if (ret == ESP_OK) {
+        ret = canvas_index_remove(handle, canvas_id);
+    }
 
     xSemaphoreGive(handle->mutex);
 
@@ -199,6 +279,12 @@ esp_err_t pin_canvas_update(pin_canvas_handle_t handle, const pin_canvas_t* canv
 
     xSemaphoreTake(handle->mutex, portMAX_DELAY);
 
+    if (!canvas_index_has_room(handle, canvas->id)) {
+        xSemaphoreGive(handle->mutex);
+        ESP_LOGE(TAG, "Canvas index is full (%d canvases)", PIN_CANVAS_INDEX_MAX);
+        return ESP_ERR_NO_MEM;
+    }
+
     pin_canvas_t updated_canvas = *canvas;
     updated_canvas.modified_time = (uint32_t)time(NULL);
 
@@ -206,6 +292,9 @@ esp_err_t pin_canvas_update(pin_canvas_handle_t handle, const pin_canvas_t* canv
     if (ret == ESP_OK) {
         ret = nvs_commit(handle->canvas_nvs_handle);
     }
+    if (ret == ESP_OK) {
+        ret = canvas_index_put(handle, &updated_canvas);
+    }
 
     xSemaphoreGive(handle->mutex);
 
@@ -309,70 +398,290 @@ esp_err_t pin_canvas_remove_element(pin_canvas_handle_t handle, const char* canv
     return pin_canvas_update(handle, &canvas);
 }
 
-esp_err_t pin_canvas_store_image(pin_canvas_handle_t handle, const char* image_id, const uint8_t* data, size_t size, pin_canvas_image_format_t format) {
-    if (!handle || !handle->initialized || !image_id || !data || size == 0 || size > PIN_CANVAS_MAX_IMAGE_SIZE) {
-        return ESP_ERR_INVALID_ARG;
+static bool image_storage_mount(void) {
+    esp_vfs_spiffs_conf_t conf = {
+        .base_path = PIN_CANVAS_SPIFFS_BASE_PATH,
+        .partition_label = CANVAS_IMAGE_PARTITION,
+        .max_files = 4,
+        .format_if_mount_failed = true,
+    };
+    esp_err_t ret = esp_vfs_spiffs_register(&conf);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "Failed to mount image storage: %s", esp_err_to_name(ret));
+        return false;
+    }
+
+    // Uploads cut short by a reset leave their temporary file behind
+    DIR* dir = opendir(PIN_CANVAS_SPIFFS_BASE_PATH);
+    if (dir) {
+        char path[64];
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (strncmp(entry->d_name, CANVAS_IMAGE_TEMP_DIR "/", 2) == 0) {
+                snprintf(path, sizeof(path), "%s/%s", PIN_CANVAS_SPIFFS_BASE_PATH, entry->d_name);
+                unlink(path);
+            }
+        }
+        closedir(dir);
     }
 
-    xSemaphoreTake(handle->mutex, portMAX_DELAY);
-
-    // Store image metadata and data
-    struct {
-        pin_canvas_image_format_t format;
-        size_t size;
-        uint32_t stored_time;
-    } image_meta = {
-        .format = format,
-        .size = size,
-        .stored_time = (uint32_t)time(NULL)
-    };
+    size_t total = 0, used = 0;
+    if (esp_spiffs_info(CANVAS_IMAGE_PARTITION, &total, &used) == ESP_OK) {
+        ESP_LOGI(TAG, "Image storage mounted, %zu of %zu bytes used", used, total);
+    }
+    return true;
+}
 
-    char meta_key[64];
-    snprintf(meta_key, sizeof(meta_key), "%s_meta", image_id);
+// Images stored in NVS by older firmware are no longer read; free their space
+// once. Checking for entries first keeps later boots from writing to NVS.
+static void image_legacy_erase(void) {
+    nvs_iterator_t iter = NULL;
+    if (nvs_entry_find(NVS_DEFAULT_PART_NAME, NVS_LEGACY_IMAGE_NAMESPACE, NVS_TYPE_ANY, &iter) != ESP_OK) {
+        return;
+    }
+    nvs_release_iterator(iter);
 
-    esp_err_t ret = nvs_set_blob(handle->image_nvs_handle, meta_key, &image_meta, sizeof(image_meta));
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(NVS_LEGACY_IMAGE_NAMESPACE, NVS_READWRITE, &nvs);
     if (ret == ESP_OK) {
-        ret = nvs_set_blob(handle->image_nvs_handle, image_id, data, size);
+        ret = nvs_erase_all(nvs);
+        if (ret == ESP_OK) {
+            ret = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
     }
     if (ret == ESP_OK) {
-        ret = nvs_commit(handle->image_nvs_handle);
+        ESP_LOGI(TAG, "Erased images left in NVS by older firmware");
+    } else {
+        ESP_LOGW(TAG, "Failed to erase old NVS images: %s", esp_err_to_name(ret));
+    }
+}
+
+static bool image_path(char* path, size_t size, const char* dir, const char* image_id) {
+    // SPIFFS names count from the partition root and include the terminator
+    if (strlen(image_id) + strlen(dir) + 3 > CONFIG_SPIFFS_OBJ_NAME_LEN || strchr(image_id, '/')) {
+        return false;
     }
+    snprintf(path, size, "%s/%s/%s", PIN_CANVAS_SPIFFS_BASE_PATH, dir, image_id);
+    return true;
+}
 
-    xSemaphoreGive(handle->mutex);
+static pin_canvas_image_format_t image_detect_format(const uint8_t* head, size_t len) {
+    static const uint8_t png_signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    if (len >= sizeof(png_signature) && memcmp(head, png_signature, sizeof(png_signature)) == 0) {
+        return PIN_CANVAS_IMAGE_PNG;
+    }
+    if (len >= 2 && head[0] == 0xFF && head[1] == 0xD8) {
+        return PIN_CANVAS_IMAGE_JPG;
+    }
+    return PIN_CANVAS_IMAGE_BMP;
+}
+
+static esp_err_t write_all(int fd, const void* data, size_t len) {
+    const uint8_t* p = data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n <= 0) {
+            return ESP_FAIL;
+        }
+        p += n;
+        len -= n;
+    }
+    return ESP_OK;
+}
+
+static void image_writer_free(pin_canvas_image_writer_t writer, bool remove_temp) {
+    if (writer->fd >= 0) {
+        close(writer->fd);
+    }
+    if (remove_temp) {
+        char path[64];
+        image_path(path, sizeof(path), CANVAS_IMAGE_TEMP_DIR, writer->image_id);
+        unlink(path);
+    }
+    mbedtls_sha256_free(&writer->sha);
+    free(writer);
+}
+
+esp_err_t pin_canvas_image_begin(pin_canvas_handle_t handle, const char* image_id, size_t size,
+                                 pin_canvas_image_writer_t* writer) {
+    char path[64];
+    if (!handle || !handle->initialized || !image_id || !writer || size == 0 || size > UINT32_MAX ||
+        strlen(image_id) >= sizeof((*writer)->image_id) ||
+        !image_path(path, sizeof(path), CANVAS_IMAGE_TEMP_DIR, image_id)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!handle->images_mounted) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    size_t total = 0, used = 0;
+    esp_err_t ret = esp_spiffs_info(CANVAS_IMAGE_PARTITION, &total, &used);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (sizeof(canvas_image_header_t) + size > total - used) {
+        ESP_LOGW(TAG, "Image %s (%zu bytes) does not fit, %zu bytes free", image_id, size, total - used);
+        return ESP_ERR_NO_MEM;
+    }
+
+    pin_canvas_image_writer_t w = calloc(1, sizeof(struct pin_canvas_image_writer));
+    if (!w) {
+        return ESP_ERR_NO_MEM;
+    }
+    w->handle = handle;
+    w->expected = size;
+    strncpy(w->image_id, image_id, sizeof(w->image_id) - 1);
+    mbedtls_sha256_init(&w->sha);
+    mbedtls_sha256_starts(&w->sha, 0);
+
+    // Reserve the header; the real one is only known at commit
+    canvas_image_header_t header = { 0 };
+    w->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (w->fd < 0 || write_all(w->fd, &header, sizeof(header)) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create %s", path);
+        image_writer_free(w, true);
+        return ESP_FAIL;
+    }
+
+    *writer = w;
+    return ESP_OK;
+}
+
+esp_err_t pin_canvas_image_write(pin_canvas_image_writer_t writer, const uint8_t* data, size_t len) {
+    if (!writer || (!data && len > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len > writer->expected - writer->written) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    if (writer->written < sizeof(writer->head)) {
+        size_t n = sizeof(writer->head) - writer->written;
+        memcpy(writer->head + writer->written, data, n < len ? n : len);
+    }
+    mbedtls_sha256_update(&writer->sha, data, len);
+    if (write_all(writer->fd, data, len) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write image %s", writer->image_id);
+        return ESP_FAIL;
+    }
+    writer->written += len;
+    return ESP_OK;
+}
+
+esp_err_t pin_canvas_image_commit(pin_canvas_image_writer_t writer, pin_canvas_image_info_t* info) {
+    if (!writer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (writer->written != writer->expected) {
+        ESP_LOGE(TAG, "Image %s is %zu of %zu bytes", writer->image_id, writer->written, writer->expected);
+        image_writer_free(writer, true);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    canvas_image_header_t header = {
+        .magic = CANVAS_IMAGE_MAGIC,
+        .version = CANVAS_IMAGE_VERSION,
+        .format = image_detect_format(writer->head, writer->written),
+        .size = (uint32_t)writer->written,
+        .stored_time = (uint32_t)time(NULL),
+    };
+    mbedtls_sha256_finish(&writer->sha, header.sha256);
+
+    esp_err_t ret = ESP_OK;
+    if (lseek(writer->fd, 0, SEEK_SET) != 0 || write_all(writer->fd, &header, sizeof(header)) != ESP_OK) {
+        ret = ESP_FAIL;
+    }
+    if (close(writer->fd) != 0) {
+        ret = ESP_FAIL;
+    }
+    writer->fd = -1;
+
+    // Readers see either the old image or the complete new one
+    char temp_path[64], path[64];
+    image_path(temp_path, sizeof(temp_path), CANVAS_IMAGE_TEMP_DIR, writer->image_id);
+    image_path(path, sizeof(path), CANVAS_IMAGE_DIR, writer->image_id);
+    if (ret == ESP_OK) {
+        xSemaphoreTake(writer->handle->mutex, portMAX_DELAY);
+        unlink(path);
+        if (rename(temp_path, path) != 0) {
+            ret = ESP_FAIL;
+        }
+        xSemaphoreGive(writer->handle->mutex);
+    }
 
     if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "Stored image %s (%zu bytes)", image_id, size);
+        ESP_LOGI(TAG, "Stored image %s (%zu bytes)", writer->image_id, writer->written);
+        if (info) {
+            info->format = (pin_canvas_image_format_t)header.format;
+            info->size = header.size;
+            info->stored_time = header.stored_time;
+            memcpy(info->sha256, header.sha256, sizeof(info->sha256));
+        }
     } else {
-        ESP_LOGE(TAG, "Failed to store image %s: %s", image_id, esp_err_to_name(ret));
+        ESP_LOGE(TAG, "Failed to store image %s", writer->image_id);
     }
 
+    image_writer_free(writer, ret != ESP_OK);
     return ret;
 }
 
-esp_err_t pin_canvas_delete_image(pin_canvas_handle_t handle, const char* image_id) {
-    if (!handle || !handle->initialized || !image_id) {
+void pin_canvas_image_abort(pin_canvas_image_writer_t writer) {
+    if (writer) {
+        image_writer_free(writer, true);
+    }
+}
+
+esp_err_t pin_canvas_get_image_info(pin_canvas_handle_t handle, const char* image_id, pin_canvas_image_info_t* info) {
+    char path[64];
+    if (!handle || !handle->initialized || !image_id || !info ||
+        !image_path(path, sizeof(path), CANVAS_IMAGE_DIR, image_id)) {
         return ESP_ERR_INVALID_ARG;
     }
+    if (!handle->images_mounted) {
+        return ESP_ERR_NOT_FOUND;
+    }
 
+    canvas_image_header_t header;
     xSemaphoreTake(handle->mutex, portMAX_DELAY);
+    int fd = open(path, O_RDONLY);
+    ssize_t n = fd >= 0 ? read(fd, &header, sizeof(header)) : -1;
+    if (fd >= 0) {
+        close(fd);
+    }
+    xSemaphoreGive(handle->mutex);
 
-    char meta_key[64];
-    snprintf(meta_key, sizeof(meta_key), "%s_meta", image_id);
+    if (fd < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (n != sizeof(header) || header.magic != CANVAS_IMAGE_MAGIC || header.version != CANVAS_IMAGE_VERSION) {
+        ESP_LOGW(TAG, "Image %s has no valid header", image_id);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    info->format = (pin_canvas_image_format_t)header.format;
+    info->size = header.size;
+    info->stored_time = header.stored_time;
+    memcpy(info->sha256, header.sha256, sizeof(info->sha256));
+    return ESP_OK;
+}
 
-    esp_err_t ret = nvs_erase_key(handle->image_nvs_handle, meta_key);
-    if (ret == ESP_OK || ret == ESP_ERR_NVS_NOT_FOUND) {
-        ret = nvs_erase_key(handle->image_nvs_handle, image_id);
+esp_err_t pin_canvas_delete_image(pin_canvas_handle_t handle, const char* image_id) {
+    char path[64];
+    if (!handle || !handle->initialized || !image_id ||
+        !image_path(path, sizeof(path), CANVAS_IMAGE_DIR, image_id)) {
+        return ESP_ERR_INVALID_ARG;
     }
-    if (ret == ESP_OK) {
-        ret = nvs_commit(handle->image_nvs_handle);
+    if (!handle->images_mounted) {
+        return ESP_ERR_NOT_FOUND;
     }
 
+    xSemaphoreTake(handle->mutex, portMAX_DELAY);
+    esp_err_t ret = unlink(path) == 0 ? ESP_OK : ESP_ERR_NOT_FOUND;
     xSemaphoreGive(handle->mutex);
 
     if (ret == ESP_OK) {
         ESP_LOGI(TAG, "Deleted image: %s", image_id);
-    } else if (ret != ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGE(TAG, "Failed to delete image %s: %s", image_id, esp_err_to_name(ret));
     }
 
     return ret;
@@ -471,21 +780,10 @@ esp_err_t pin_canvas_list(pin_canvas_handle_t handle, char canvas_ids[][32], siz
     *count = 0;
     xSemaphoreTake(handle->mutex, portMAX_DELAY);
 
-    nvs_iterator_t iter = NULL;
-    esp_err_t err = nvs_entry_find(NVS_DEFAULT_PART_NAME, NVS_CANVAS_NAMESPACE, NVS_TYPE_BLOB, &iter);
-    while (err == ESP_OK && iter != NULL && *count < max_count) {
-        nvs_entry_info_t info;
-        nvs_entry_info(iter, &info);
-        
-        strncpy(canvas_ids[*count], info.key, 31);
+    for (uint16_t i = 0; i < handle->index->count && *count < max_count; i++) {
+        strncpy(canvas_ids[*count], handle->index->entries[i].id, 31);
         canvas_ids[*count][31] = '\0';
         (*count)++;
-        
-        err = nvs_entry_next(&iter);
-    }
-    
-    if (iter != NULL) {
-        nvs_release_iterator(iter);
     }
 
     xSemaphoreGive(handle->mutex);
@@ -494,6 +792,35 @@ esp_err_t pin_canvas_list(pin_canvas_handle_t handle, char canvas_ids[][32], siz
     return ESP_OK;
 }
 
+esp_err_t pin_canvas_list_meta(pin_canvas_handle_t handle, uint32_t modified_since, size_t offset,
+                               pin_canvas_meta_t* metas, size_t max_count, size_t* count, size_t* total) {
+    if (!handle || !handle->initialized || (!metas && max_count > 0) || !count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t matched = 0;
+    *count = 0;
+    xSemaphoreTake(handle->mutex, portMAX_DELAY);
+
+    for (uint16_t i = 0; i < handle->index->count; i++) {
+        const pin_canvas_meta_t* meta = &handle->index->entries[i];
+        if (meta->modified_time < modified_since) {
+            continue;
+        }
+        if (matched >= offset && *count < max_count) {
+            metas[(*count)++] = *meta;
+        }
+        matched++;
+    }
+
+    xSemaphoreGive(handle->mutex);
+
+    if (total) {
+        *total = matched;
+    }
+    return ESP_OK;
+}
+
 esp_err_t pin_canvas_export_json(pin_canvas_handle_t handle, const char* canvas_id, char** json_str) {
     if (!handle || !handle->initialized || !canvas_id || !json_str) {
         return ESP_ERR_INVALID_ARG;
@@ -551,6 +878,139 @@ esp_err_t pin_canvas_import_json(pin_canvas_handle_t handle, const char* json_st
 }
 
 // Static helper functions implementation
+static int canvas_index_find(pin_canvas_handle_t handle, const char* canvas_id) {
+    for (int i = 0; i < handle->index->count; i++) {
+        if (strcmp(handle->index->entries[i].id, canvas_id) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool canvas_index_has_room(pin_canvas_handle_t handle, const char* canvas_id) {
+    return handle->index->count < PIN_CANVAS_INDEX_MAX || canvas_index_find(handle, canvas_id) >= 0;
+}
+
+static void canvas_index_fill(pin_canvas_meta_t* meta, const char* canvas_id, const pin_canvas_t* canvas) {
+    memset(meta, 0, sizeof(pin_canvas_meta_t));
+    strncpy(meta->id, canvas_id, sizeof(meta->id) - 1);
+    strncpy(meta->name, canvas->name, sizeof(meta->name) - 1);
+    meta->created_time = canvas->created_time;
+    meta->modified_time = canvas->modified_time;
+    meta->element_count = canvas->element_count;
+}
+
+static esp_err_t canvas_index_save(pin_canvas_handle_t handle) {
+    esp_err_t ret = nvs_set_blob(handle->index_nvs_handle, NVS_INDEX_KEY, handle->index,
+                                 CANVAS_INDEX_SIZE(handle->index->count));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle->index_nvs_handle);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save canvas index: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+// Called with the mutex held, after the canvas itself was written
+static esp_err_t canvas_index_put(pin_canvas_handle_t handle, const pin_canvas_t* canvas) {
+    int i = canvas_index_find(handle, canvas->id);
+    if (i < 0) {
+        if (handle->index->count >= PIN_CANVAS_INDEX_MAX) {
+            return ESP_ERR_NO_MEM;
+        }
+        i = handle->index->count++;
+    }
+    canvas_index_fill(&handle->index->entries[i], canvas->id, canvas);
+    return canvas_index_save(handle);
+}
+
+static esp_err_t canvas_index_remove(pin_canvas_handle_t handle, const char* canvas_id) {
+    int i = canvas_index_find(handle, canvas_id);
+    if (i < 0) {
+        return ESP_OK;
+    }
+    handle->index->count--;
+    memmove(&handle->index->entries[i], &handle->index->entries[i + 1],
+            (handle->index->count - i) * sizeof(pin_canvas_meta_t));
+    return canvas_index_save(handle);
+}
+
+// True if the index lists exactly the canvases in NVS; reads keys only, no blobs
+static bool canvas_index_matches_store(pin_canvas_handle_t handle) {
+    uint16_t stored = 0;
+    bool matches = true;
+
+    nvs_iterator_t iter = NULL;
+    esp_err_t err = nvs_entry_find(NVS_DEFAULT_PART_NAME, NVS_CANVAS_NAMESPACE, NVS_TYPE_BLOB, &iter);
+    while (err == ESP_OK && iter != NULL && matches) {
+        nvs_entry_info_t info;
+        nvs_entry_info(iter, &info);
+        matches = canvas_index_find(handle, info.key) >= 0;
+        stored++;
+        err = nvs_entry_next(&iter);
+    }
+    if (iter != NULL) {
+        nvs_release_iterator(iter);
+    }
+
+    return matches && stored == handle->index->count;
+}
+
+static esp_err_t canvas_index_load(pin_canvas_handle_t handle) {
+    canvas_index_t* index = handle->index;
+    size_t size = sizeof(canvas_index_t);
+    esp_err_t ret = nvs_get_blob(handle->index_nvs_handle, NVS_INDEX_KEY, index, &size);
+
+    // A reset between writing a canvas and its index entry leaves them apart
+    if (ret == ESP_OK && size >= CANVAS_INDEX_SIZE(0) && index->version == CANVAS_INDEX_VERSION &&
+        index->count <= PIN_CANVAS_INDEX_MAX && size == CANVAS_INDEX_SIZE(index->count) &&
+        canvas_index_matches_store(handle)) {
+        ESP_LOGI(TAG, "Canvas index loaded: %u canvases", index->count);
+        return ESP_OK;
+    }
+
+    return canvas_index_rebuild(handle);
+}
+
+// One full read per canvas, only when the index is missing or out of step
+static esp_err_t canvas_index_rebuild(pin_canvas_handle_t handle) {
+    pin_canvas_t* canvas = malloc(sizeof(pin_canvas_t));
+    if (!canvas) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    canvas_index_t* index = handle->index;
+    index->version = CANVAS_INDEX_VERSION;
+    index->count = 0;
+
+    nvs_iterator_t iter = NULL;
+    esp_err_t err = nvs_entry_find(NVS_DEFAULT_PART_NAME, NVS_CANVAS_NAMESPACE, NVS_TYPE_BLOB, &iter);
+    while (err == ESP_OK && iter != NULL) {
+        nvs_entry_info_t info;
+        nvs_entry_info(iter, &info);
+
+        size_t size = sizeof(pin_canvas_t);
+        if (index->count >= PIN_CANVAS_INDEX_MAX) {
+            ESP_LOGW(TAG, "Canvas index full, %s not indexed", info.key);
+        } else if (nvs_get_blob(handle->canvas_nvs_handle, info.key, canvas, &size) == ESP_OK) {
+            canvas_index_fill(&index->entries[index->count++], info.key, canvas);
+        }
+        err = nvs_entry_next(&iter);
+    }
+    if (iter != NULL) {
+        nvs_release_iterator(iter);
+    }
+    free(canvas);
+
+    ESP_LOGI(TAG, "Canvas index rebuilt: %u canvases", index->count);
+
+    // The index in RAM is complete either way; an unsaved one is rebuilt
+    // again next boot, and the next canvas write retries the save
+    canvas_index_save(handle);
+    return ESP_OK;
+}
+
 static esp_err_t canvas_to_json(const pin_canvas_t* canvas, cJSON** json) {
     *json = cJSON_CreateObject();
     if (!*json) return ESP_ERR_NO_MEM;
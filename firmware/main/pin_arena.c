@@ -0,0 +1,216 @@
+/**
+ * @file pin_arena.c
+ * @brief Pin Plugin Memory Arena Implementation
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "pin_config.h"
+#include "pin_arena.h"
+
+static const char* TAG = "PIN_ARENA";
+
+#define PIN_ARENA_ALIGN 8
+#define PIN_ARENA_MIN_CLASS_SHIFT 4     // Smallest class is 16 bytes
+#define PIN_ARENA_BLOCK_MAGIC 0xA5
+
+#define ALIGN_UP(x) (((x) + PIN_ARENA_ALIGN - 1) & ~(uint32_t)(PIN_ARENA_ALIGN - 1))
+
+// Header in front of every persistent block, keeps the payload 8-byte aligned
+typedef struct {
+    uint8_t size_class;
+    uint8_t magic;
+    uint16_t reserved;
+    uint32_t reserved2;
+} pin_arena_block_t;
+
+typedef struct {
+    uint32_t offset;
+    uint32_t size;
+} pin_arena_region_t;
+
+// Shared pool; regions are kept sorted by offset so first fit is a single pass
+static struct {
+    uint8_t memory[CONFIG_PIN_PLUGIN_HEAP_SIZE] __attribute__((aligned(PIN_ARENA_ALIGN)));
+    pin_arena_region_t regions[PIN_ARENA_MAX_REGIONS];
+    uint8_t region_count;
+    portMUX_TYPE lock;
+} g_pool = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static inline uint32_t class_payload_size(uint8_t size_class) {
+    return 1u << (size_class + PIN_ARENA_MIN_CLASS_SHIFT);
+}
+
+static inline int size_to_class(size_t size) {
+    for (uint8_t c = 0; c < PIN_ARENA_NUM_CLASSES; c++) {
+        if (size <= class_payload_size(c)) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+esp_err_t pin_arena_create(pin_arena_t* arena, size_t size) {
+    if (!arena || size == 0 || size > CONFIG_PIN_PLUGIN_HEAP_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t need = ALIGN_UP((uint32_t)size);
+    esp_err_t ret = ESP_ERR_NO_MEM;
+
+    portENTER_CRITICAL(&g_pool.lock);
+    if (g_pool.region_count < PIN_ARENA_MAX_REGIONS) {
+        // First gap large enough, scanning regions in address order
+        uint32_t gap_start = 0;
+        uint8_t slot = 0;
+        for (; slot <= g_pool.region_count; slot++) {
+            uint32_t gap_end = slot < g_pool.region_count ?
+                               g_pool.regions[slot].offset : CONFIG_PIN_PLUGIN_HEAP_SIZE;
+            if (gap_end - gap_start >= need) {
+                break;
+            }
+            if (slot < g_pool.region_count) {
+                gap_start = g_pool.regions[slot].offset + g_pool.regions[slot].size;
+            }
+        }
+
+        if (slot <= g_pool.region_count) {
+            memmove(&g_pool.regions[slot + 1], &g_pool.regions[slot],
+                    (g_pool.region_count - slot) * sizeof(pin_arena_region_t));
+            g_pool.regions[slot].offset = gap_start;
+            g_pool.regions[slot].size = need;
+            g_pool.region_count++;
+
+            memset(arena, 0, sizeof(*arena));
+            arena->base = &g_pool.memory[gap_start];
+            arena->size = need;
+            arena->scratch_bottom = need;
+            ret = ESP_OK;
+        }
+    }
+    portEXIT_CRITICAL(&g_pool.lock);
+
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "No room for a %u byte arena (%u bytes free)",
+                 (unsigned)need, (unsigned)pin_arena_pool_free());
+    }
+    return ret;
+}
+
+void pin_arena_destroy(pin_arena_t* arena) {
+    if (!arena || !arena->base) {
+        return;
+    }
+
+    uint32_t offset = (uint32_t)(arena->base - g_pool.memory);
+
+    portENTER_CRITICAL(&g_pool.lock);
+    for (uint8_t i = 0; i < g_pool.region_count; i++) {
+        if (g_pool.regions[i].offset == offset) {
+            memmove(&g_pool.regions[i], &g_pool.regions[i + 1],
+                    (g_pool.region_count - i - 1) * sizeof(pin_arena_region_t));
+            g_pool.region_count--;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&g_pool.lock);
+
+    memset(arena, 0, sizeof(*arena));
+}
+
+void* pin_arena_alloc(pin_arena_t* arena, size_t size) {
+    if (!arena || !arena->base || size == 0) {
+        return NULL;
+    }
+
+    int size_class = size_to_class(size);
+    if (size_class < 0) {
+        ESP_LOGW(TAG, "Persistent allocation of %u bytes exceeds %d", (unsigned)size, PIN_ARENA_MAX_ALLOC);
+        return NULL;
+    }
+
+    uint32_t block_size = sizeof(pin_arena_block_t) + class_payload_size(size_class);
+    pin_arena_block_t* block;
+
+    if (arena->free_lists[size_class]) {
+        // Reuse a freed block of the same class
+        void* payload = arena->free_lists[size_class];
+        arena->free_lists[size_class] = *(void**)payload;
+        block = (pin_arena_block_t*)payload - 1;
+    } else {
+        if (arena->persistent_top + block_size > arena->scratch_bottom) {
+            return NULL;
+        }
+        block = (pin_arena_block_t*)(arena->base + arena->persistent_top);
+        block->size_class = (uint8_t)size_class;
+        arena->persistent_top += block_size;
+    }
+
+    block->magic = PIN_ARENA_BLOCK_MAGIC;
+    arena->persistent_used += block_size;
+    return block + 1;
+}
+
+void pin_arena_free(pin_arena_t* arena, void* ptr) {
+    if (!arena || !ptr) {
+        return;
+    }
+
+    pin_arena_block_t* block = (pin_arena_block_t*)ptr - 1;
+    if ((uint8_t*)block < arena->base ||
+        (uint8_t*)ptr >= arena->base + arena->persistent_top ||
+        block->magic != PIN_ARENA_BLOCK_MAGIC ||
+        block->size_class >= PIN_ARENA_NUM_CLASSES) {
+        ESP_LOGE(TAG, "Invalid or double free of %p", ptr);
+        return;
+    }
+
+    block->magic = 0;
+    arena->persistent_used -= sizeof(pin_arena_block_t) + class_payload_size(block->size_class);
+
+    // Payload doubles as the free list link
+    *(void**)ptr = arena->free_lists[block->size_class];
+    arena->free_lists[block->size_class] = ptr;
+}
+
+void* pin_arena_scratch_alloc(pin_arena_t* arena, size_t size) {
+    if (!arena || !arena->base || size == 0 || size > arena->size) {
+        return NULL;
+    }
+
+    uint32_t need = ALIGN_UP((uint32_t)size);
+    if (arena->scratch_bottom < arena->persistent_top + need) {
+        return NULL;
+    }
+
+    arena->scratch_bottom -= need;
+    return arena->base + arena->scratch_bottom;
+}
+
+void pin_arena_scratch_reset(pin_arena_t* arena) {
+    if (arena) {
+        arena->scratch_bottom = arena->size;
+    }
+}
+
+uint32_t pin_arena_used(const pin_arena_t* arena) {
+    if (!arena) {
+        return 0;
+    }
+    return arena->persistent_used + (arena->size - arena->scratch_bottom);
+}
+
+uint32_t pin_arena_pool_free(void) {
+    uint32_t used = 0;
+
+    portENTER_CRITICAL(&g_pool.lock);
+    for (uint8_t i = 0; i < g_pool.region_count; i++) {
+        used += g_pool.regions[i].size;
+    }
+    portEXIT_CRITICAL(&g_pool.lock);
+
+    return CONFIG_PIN_PLUGIN_HEAP_SIZE - used;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file pin_arena.h
+ * @brief Pin Plugin Memory Arena
+ *
+ * Each enabled plugin owns one arena carved from a fixed pool of
+ * CONFIG_PIN_PLUGIN_HEAP_SIZE bytes. Persistent objects come from
+ * power-of-two size classes growing up from the bottom of the arena;
+ * per-update scratch is bump-allocated down from the top and released
+ * in one step. Plugins never touch the system heap, so long-running
+ * plugins cannot fragment it.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIN_ARENA_MAX_REGIONS 8         // Arenas alive at once (one per enabled plugin)
+#define PIN_ARENA_NUM_CLASSES 8         // 16 .. 2048 byte persistent blocks
+#define PIN_ARENA_MAX_ALLOC 2048        // Largest persistent allocation
+
+typedef struct {
+    uint8_t* base;
+    uint32_t size;
+    uint32_t persistent_top;            // Next fresh persistent block
+    uint32_t scratch_bottom;            // Scratch grows down from size
+    uint32_t persistent_used;           // Live persistent blocks, headers included
+    void* free_lists[PIN_ARENA_NUM_CLASSES];
+} pin_arena_t;
+
+/**
+ * @brief Carve an arena out of the shared pool
+ * @param arena Arena to initialize
+ * @param size Arena size in bytes (rounded up to 8)
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the pool has no room
+ */
+esp_err_t pin_arena_create(pin_arena_t* arena, size_t size);
+
+/**
+ * @brief Return an arena to the pool, dropping everything allocated in it
+ * @param arena Arena to release
+ */
+void pin_arena_destroy(pin_arena_t* arena);
+
+/**
+ * @brief Allocate a persistent block
+ * @param arena Arena
+ * @param size Requested size (at most PIN_ARENA_MAX_ALLOC)
+ * @return Pointer, or NULL if the arena is full
+ */
+void* pin_arena_alloc(pin_arena_t* arena, size_t size);
+
+/**
+ * @brief Free a persistent block
+ * @param arena Arena the block came from
+ * @param ptr Block (NULL is ignored)
+ */
+void pin_arena_free(pin_arena_t* arena, void* ptr);
+
+/**
+ * @brief Allocate scratch memory, valid until the next pin_arena_scratch_reset()
+ * @param arena Arena
+ * @param size Requested size
+ * @return Pointer, or NULL if the arena is full
+ */
+void* pin_arena_scratch_alloc(pin_arena_t* arena, size_t size);
+
+/**
+ * @brief Release all scratch allocations at once
+ * @param arena Arena
+ */
+void pin_arena_scratch_reset(pin_arena_t* arena);
+
+/**
+ * @brief Bytes currently in use (persistent blocks plus scratch)
+ * @param arena Arena
+ * @return Bytes in use
+ */
+uint32_t pin_arena_used(const pin_arena_t* arena);
+
+/**
+ * @brief Bytes of the shared pool not assigned to any arena
+ * @return Free pool bytes
+ */
+uint32_t pin_arena_pool_free(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -3,13 +3,29 @@
  * @brief Simple clock plugin for Pin device
  */
 
+#include <stdio.h>
 #include <time.h>
 #include <sys/time.h>
 #include "pin_plugin.h"
+#include "pin_time.h"
 #include "esp_log.h"
 
 static const char* TAG = "CLOCK_PLUGIN";
 
+#define CLOCK_TOLERANCE_MS 2000  // Minute change may be shown a little late to share a wakeup
+
+// Format the current time, or a placeholder until SNTP has set the clock
+static void clock_format(time_t now, char* buf, size_t size) {
+    struct tm timeinfo;
+    
+    if (!pin_time_is_synced()) {
+        snprintf(buf, size, "--:--");
+        return;
+    }
+    localtime_r(&now, &timeinfo);
+    strftime(buf, size, "%H:%M", &timeinfo);
+}
+
 // Plugin initialization
 static esp_err_t clock_init(pin_plugin_context_t* ctx) {
     ESP_LOGI(TAG, "Clock plugin initialized");
@@ -25,21 +41,24 @@ static esp_err_t clock_start(pin_plugin_context_t* ctx) {
     return ESP_OK;
 }
 
-// Plugin update - called periodically 
+// Plugin update - called once per minute, on the minute
 static esp_err_t clock_update(pin_plugin_context_t* ctx) {
     time_t now;
-    struct tm timeinfo;
     char strftime_buf[64];
     
     time(&now);
-    localtime_r(&now, &timeinfo);
-    strftime(strftime_buf, sizeof(strftime_buf), "%H:%M:%S", &timeinfo);
+    clock_format(now, strftime_buf, sizeof(strftime_buf));
     
     // Update display content through context API if available
     if (ctx && ctx->api.display_update_content) {
         ctx->api.display_update_content(strftime_buf);
     }
     
+    // Nothing changes until the next minute boundary
+    if (ctx && ctx->api.schedule_update_at) {
+        ctx->api.schedule_update_at(now - (now % 60) + 60, CLOCK_TOLERANCE_MS);
+    }
+    
     return ESP_OK;
 }
 
@@ -50,18 +69,17 @@ static esp_err_t clock_render(pin_plugin_context_t* ctx, pin_widget_region_t* re
     }
     
     time_t now;
-    struct tm timeinfo;
     char strftime_buf[64];
     
     time(&now);
-    localtime_r(&now, &timeinfo);
-    strftime(strftime_buf, sizeof(strftime_buf), "%H:%M", &timeinfo);
+    clock_format(now, strftime_buf, sizeof(strftime_buf));
     
-    // Update region content
-    if (region->content) {
-        free(region->content);
+    // Update region content (owned by the plugin's arena)
+    pin_plugin_free(ctx, region->content);
+    region->content = pin_plugin_strdup(ctx, strftime_buf);
+    if (!region->content) {
+        return ESP_ERR_NO_MEM;
     }
-    region->content = strdup(strftime_buf);
     region->dirty = true;
     
     return ESP_OK;
@@ -85,7 +103,7 @@ pin_plugin_t clock_plugin = {
     },
     .config = {
         .memory_limit = 4096,
-        .update_interval = 30,  // Update every 30 seconds
+        .update_interval = 60,  // Fallback, updates are scheduled on the minute
         .api_rate_limit = 10,
         .auto_start = true,
         .persistent = true
@@ -10,11 +10,11 @@
 #include "fpc_a005.h"
 #include "esp_log.h"
 #include "esp_timer.h"
-#include "esp_sleep.h"
 #include "esp_adc/adc_oneshot.h"
 #include "esp_adc/adc_cali.h"
 #include "esp_adc/adc_cali_scheme.h"
 #include "driver/gpio.h"
+#include "pin_power.h"
 
 static const char* TAG = "PIN_DISPLAY";
 
@@ -26,6 +26,8 @@ static adc_oneshot_unit_handle_t adc1_handle;
 static adc_cali_handle_t adc1_cali_handle;
 static pin_display_config_t g_display_config;
 static SemaphoreHandle_t g_display_mutex = NULL;
+static uint32_t g_display_generation = 0;
+static portMUX_TYPE g_generation_lock = portMUX_INITIALIZER_UNLOCKED;
 
 // Display refresh statistics
 static struct {
@@ -59,6 +61,15 @@ static pin_font_t fonts[] = {
     [PIN_FONT_XLARGE] = {16, 32, font_8x16_data},
 };
 
+// Full clock only for the transfer itself, the CPU can sleep while the panel is BUSY
+static void pin_display_bus_hook(bool active, void* arg) {
+    if (active) {
+        pin_power_acquire(PIN_POWER_CLIENT_SPI);
+    } else {
+        pin_power_release(PIN_POWER_CLIENT_SPI);
+    }
+}
+
 esp_err_t pin_display_init(void) {
     ESP_LOGI(TAG, "Initializing Pin display system");
     
@@ -90,6 +101,7 @@ esp_err_t pin_display_init(void) {
         .rst_io = 5,   // RST GPIO
         .busy_io = 6,  // BUSY GPIO
         .spi_clock_speed_hz = 4 * 1000 * 1000, // 4 MHz
+        .bus_hook = pin_display_bus_hook,
     };
     
     // Initialize SPI bus
@@ -174,9 +186,23 @@ esp_err_t pin_display_clear(pin_color_t color) {
     esp_err_t ret = fpc_a005_clear(g_display_handle, (fpc_a005_color_t)color);
     
     xSemaphoreGive(g_display_mutex);
+    pin_display_invalidate();
     return ret;
 }
 
+void pin_display_invalidate(void) {
+    portENTER_CRITICAL(&g_generation_lock);
+    g_display_generation++;
+    portEXIT_CRITICAL(&g_generation_lock);
+}
+
+uint32_t pin_display_get_generation(void) {
+    portENTER_CRITICAL(&g_generation_lock);
+    uint32_t generation = g_display_generation;
+    portEXIT_CRITICAL(&g_generation_lock);
+    return generation;
+}
+
 esp_err_t pin_display_set_pixel(uint16_t x, uint16_t y, pin_color_t color) {
     if (!g_display_handle) {
         return ESP_ERR_INVALID_STATE;
@@ -382,6 +408,21 @@ esp_err_t pin_display_draw_qr_code(uint16_t x, uint16_t y, const char* text, uin
     return ESP_OK;
 }
 
+esp_err_t pin_display_hash_region(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint32_t* hash) {
+    if (!g_display_handle) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (xSemaphoreTake(g_display_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    
+    esp_err_t ret = fpc_a005_hash_region(g_display_handle, x, y, w, h, hash);
+    
+    xSemaphoreGive(g_display_mutex);
+    return ret;
+}
+
 esp_err_t pin_display_refresh(pin_refresh_mode_t mode) {
     if (!g_display_handle) {
         return ESP_ERR_INVALID_STATE;
@@ -399,6 +440,11 @@ esp_err_t pin_display_refresh(pin_refresh_mode_t mode) {
     
     xSemaphoreGive(g_display_mutex);
     
+    // After a failed refresh nobody knows what the panel shows
+    if (ret != ESP_OK || mode == PIN_REFRESH_FULL) {
+        pin_display_invalidate();
+    }
+    
     if (ret == ESP_OK) {
         uint32_t refresh_time = (esp_timer_get_time() / 1000) - start_time;
         
@@ -478,33 +524,6 @@ uint8_t pin_battery_get_percentage(float voltage) {
     return (uint8_t)((voltage - 3.0f) / 1.2f * 100.0f);
 }
 
-bool pin_should_enter_sleep(void) {
-    // Simple sleep logic - sleep if no activity for configured time
-    uint32_t current_time = esp_timer_get_time() / 1000000; // Convert to seconds
-    uint32_t last_activity = g_refresh_stats.last_refresh_time / 1000; // Convert to seconds
-    
-    if (g_display_config.power_save_enabled && 
-        (current_time - last_activity) > g_display_config.sleep_after_inactive) {
-        return true;
-    }
-    
-    return false;
-}
-
-void pin_enter_deep_sleep(void) {
-    ESP_LOGI(TAG, "Entering deep sleep mode");
-    
-    // Put display to sleep first
-    pin_display_sleep();
-    
-    // Configure wake up sources
-    esp_sleep_enable_timer_wakeup(10 * 60 * 1000000ULL); // Wake up after 10 minutes
-    esp_sleep_enable_gpio_wakeup(); // Enable GPIO wake up source
-    
-    // Enter deep sleep
-    esp_deep_sleep_start();
-}
-
 fpc_a005_handle_t pin_display_get_handle(void) {
     return g_display_handle;
 }
\ No newline at end of file
@@ -163,6 +163,32 @@ esp_err_t pin_display_draw_loading_animation(uint16_t x, uint16_t y, uint8_t siz
  */
 esp_err_t pin_display_draw_qr_code(uint16_t x, uint16_t y, const char* text, uint8_t size);
 
+/**
+ * @brief Hash the pixels of a region as currently drawn (not yet refreshed)
+ * @param x X coordinate
+ * @param y Y coordinate
+ * @param w Width
+ * @param h Height
+ * @param hash Output hash
+ * @return ESP_OK on success
+ */
+esp_err_t pin_display_hash_region(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint32_t* hash);
+
+/**
+ * @brief Note that the panel no longer shows what its users last drew
+ *
+ * Called by everything that overwrites the whole panel or leaves it in an
+ * unknown state; anyone skipping redraws of unchanged content compares
+ * pin_display_get_generation() with the value at their last draw.
+ */
+void pin_display_invalidate(void);
+
+/**
+ * @brief Get the panel generation, bumped by pin_display_invalidate()
+ * @return Current generation
+ */
+uint32_t pin_display_get_generation(void);
+
 /**
  * @brief Refresh the display
  * @param mode Refresh mode
@@ -195,17 +221,6 @@ float pin_battery_get_voltage(void);
  */
 uint8_t pin_battery_get_percentage(float voltage);
 
-/**
- * @brief Check if system should enter sleep
- * @return true if should sleep
- */
-bool pin_should_enter_sleep(void);
-
-/**
- * @brief Enter deep sleep mode
- */
-void pin_enter_deep_sleep(void);
-
 /**
  * @brief Get display handle
  * @return Display handle
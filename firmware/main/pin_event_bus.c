@@ -0,0 +1,296 @@
+/**
+ * @file pin_event_bus.c
+ * @brief Pin Plugin Event Bus Implementation
+ */
+
+#include <string.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "pin_event_bus.h"
+
+static const char* TAG = "PIN_EVENT";
+
+#define PIN_EVENT_BUS_QUEUE_MASK (PIN_EVENT_BUS_QUEUE_LEN - 1)
+
+_Static_assert((PIN_EVENT_BUS_QUEUE_LEN & PIN_EVENT_BUS_QUEUE_MASK) == 0,
+               "PIN_EVENT_BUS_QUEUE_LEN must be a power of two");
+
+typedef struct {
+    uint8_t topic;
+    char data[PIN_EVENT_BUS_PAYLOAD_MAX_LEN];
+} pin_event_t;
+
+// Ring slot; the sequence number tells producers and the consumer whose turn it is
+typedef struct {
+    _Atomic uint32_t sequence;
+    pin_event_t event;
+} pin_event_slot_t;
+
+typedef struct {
+    uint8_t topic;
+    uint8_t owner;
+    void (*callback)(const char* data);
+} pin_event_subscriber_t;
+
+// Topics and subscribers are append-only: writers hold the mutex and
+// publish the new count last, readers scan up to the count without locking
+static struct {
+    pin_event_slot_t ring[PIN_EVENT_BUS_QUEUE_LEN];
+    _Atomic uint32_t enqueue_pos;
+    _Atomic uint32_t dequeue_pos;
+
+    char topics[PIN_EVENT_BUS_MAX_TOPICS][PIN_EVENT_BUS_TOPIC_MAX_LEN];
+    _Atomic uint8_t topic_count;
+
+    pin_event_subscriber_t subscribers[PIN_EVENT_BUS_MAX_SUBSCRIBERS];
+    _Atomic uint8_t subscriber_count;
+
+    _Atomic uint32_t published;
+    _Atomic uint32_t delivered;
+    _Atomic uint32_t dropped;
+
+    SemaphoreHandle_t mutex;
+    pin_event_bus_deliver_t deliver;
+    void (*wake)(void);
+} g_event_bus = {0};
+
+static bool topic_lookup(const char* name, uint8_t* topic_id) {
+    uint8_t count = atomic_load_explicit(&g_event_bus.topic_count, memory_order_acquire);
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (strncmp(g_event_bus.topics[i], name, PIN_EVENT_BUS_TOPIC_MAX_LEN) == 0) {
+            *topic_id = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool ring_push(uint8_t topic, const char* data) {
+    uint32_t pos = atomic_load_explicit(&g_event_bus.enqueue_pos, memory_order_relaxed);
+    pin_event_slot_t* slot;
+
+    while (1) {
+        slot = &g_event_bus.ring[pos & PIN_EVENT_BUS_QUEUE_MASK];
+        uint32_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+
+        if (diff == 0) {
+            // Slot is free for this position, try to claim it
+            if (atomic_compare_exchange_weak_explicit(&g_event_bus.enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Consumer has not released this slot yet: ring is full
+            return false;
+        } else {
+            pos = atomic_load_explicit(&g_event_bus.enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    slot->event.topic = topic;
+    if (data) {
+        strncpy(slot->event.data, data, sizeof(slot->event.data) - 1);
+        slot->event.data[sizeof(slot->event.data) - 1] = '\0';
+    } else {
+        slot->event.data[0] = '\0';
+    }
+
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+    return true;
+}
+
+static bool ring_pop(pin_event_t* event) {
+    uint32_t pos = atomic_load_explicit(&g_event_bus.dequeue_pos, memory_order_relaxed);
+    pin_event_slot_t* slot;
+
+    while (1) {
+        slot = &g_event_bus.ring[pos & PIN_EVENT_BUS_QUEUE_MASK];
+        uint32_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        int32_t diff = (int32_t)(seq - (pos + 1));
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&g_event_bus.dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Nothing published at this position yet
+            return false;
+        } else {
+            pos = atomic_load_explicit(&g_event_bus.dequeue_pos, memory_order_relaxed);
+        }
+    }
+
+    *event = slot->event;
+
+    // Hand the slot back to producers one lap ahead
+    atomic_store_explicit(&slot->sequence, pos + PIN_EVENT_BUS_QUEUE_LEN, memory_order_release);
+    return true;
+}
+
+esp_err_t pin_event_bus_init(pin_event_bus_deliver_t deliver, void (*wake)(void)) {
+    if (!deliver) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (g_event_bus.mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    g_event_bus.mutex = xSemaphoreCreateMutex();
+    if (!g_event_bus.mutex) {
+        ESP_LOGE(TAG, "Failed to create event bus mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (uint32_t i = 0; i < PIN_EVENT_BUS_QUEUE_LEN; i++) {
+        atomic_init(&g_event_bus.ring[i].sequence, i);
+    }
+    atomic_init(&g_event_bus.enqueue_pos, 0);
+    atomic_init(&g_event_bus.dequeue_pos, 0);
+    atomic_init(&g_event_bus.topic_count, 0);
+    atomic_init(&g_event_bus.subscriber_count, 0);
+
+    g_event_bus.deliver = deliver;
+    g_event_bus.wake = wake;
+
+    ESP_LOGI(TAG, "Event bus initialized");
+    return ESP_OK;
+}
+
+esp_err_t pin_event_bus_intern(const char* name, uint8_t* topic_id) {
+    if (!name || !topic_id || name[0] == '\0' ||
+        strlen(name) >= PIN_EVENT_BUS_TOPIC_MAX_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!g_event_bus.mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (topic_lookup(name, topic_id)) {
+        return ESP_OK;
+    }
+
+    xSemaphoreTake(g_event_bus.mutex, portMAX_DELAY);
+
+    // Another task may have added it while we waited
+    esp_err_t ret = ESP_OK;
+    if (!topic_lookup(name, topic_id)) {
+        uint8_t count = atomic_load_explicit(&g_event_bus.topic_count, memory_order_relaxed);
+        if (count >= PIN_EVENT_BUS_MAX_TOPICS) {
+            ESP_LOGW(TAG, "Topic table full, cannot add '%s'", name);
+            ret = ESP_ERR_NO_MEM;
+        } else {
+            strcpy(g_event_bus.topics[count], name);
+            atomic_store_explicit(&g_event_bus.topic_count, count + 1, memory_order_release);
+            *topic_id = count;
+            ESP_LOGD(TAG, "Topic '%s' -> %d", name, count);
+        }
+    }
+
+    xSemaphoreGive(g_event_bus.mutex);
+    return ret;
+}
+
+esp_err_t pin_event_bus_subscribe(const char* name, uint8_t owner, void (*callback)(const char* data)) {
+    if (!callback) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t topic;
+    esp_err_t ret = pin_event_bus_intern(name, &topic);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    xSemaphoreTake(g_event_bus.mutex, portMAX_DELAY);
+
+    uint8_t count = atomic_load_explicit(&g_event_bus.subscriber_count, memory_order_relaxed);
+    for (uint8_t i = 0; i < count; i++) {
+        pin_event_subscriber_t* sub = &g_event_bus.subscribers[i];
+        if (sub->topic == topic && sub->owner == owner && sub->callback == callback) {
+            xSemaphoreGive(g_event_bus.mutex);
+            return ESP_OK;
+        }
+    }
+
+    if (count >= PIN_EVENT_BUS_MAX_SUBSCRIBERS) {
+        xSemaphoreGive(g_event_bus.mutex);
+        ESP_LOGW(TAG, "Subscriber table full, cannot subscribe to '%s'", name);
+        return ESP_ERR_NO_MEM;
+    }
+
+    g_event_bus.subscribers[count].topic = topic;
+    g_event_bus.subscribers[count].owner = owner;
+    g_event_bus.subscribers[count].callback = callback;
+    atomic_store_explicit(&g_event_bus.subscriber_count, count + 1, memory_order_release);
+
+    xSemaphoreGive(g_event_bus.mutex);
+    return ESP_OK;
+}
+
+esp_err_t pin_event_bus_publish(const char* name, const char* data) {
+    if (!name) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!g_event_bus.mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Topics are interned on subscribe, so an unknown topic has no listeners
+    uint8_t topic;
+    if (!topic_lookup(name, &topic)) {
+        return ESP_OK;
+    }
+
+    if (!ring_push(topic, data)) {
+        atomic_fetch_add_explicit(&g_event_bus.dropped, 1, memory_order_relaxed);
+        ESP_LOGD(TAG, "Event queue full, dropped '%s'", name);
+        return ESP_ERR_NO_MEM;
+    }
+
+    atomic_fetch_add_explicit(&g_event_bus.published, 1, memory_order_relaxed);
+
+    if (g_event_bus.wake) {
+        g_event_bus.wake();
+    }
+
+    return ESP_OK;
+}
+
+void pin_event_bus_dispatch(void) {
+    pin_event_t event;
+
+    if (!g_event_bus.deliver) {
+        return;
+    }
+
+    while (ring_pop(&event)) {
+        uint8_t count = atomic_load_explicit(&g_event_bus.subscriber_count, memory_order_acquire);
+        for (uint8_t i = 0; i < count; i++) {
+            const pin_event_subscriber_t* sub = &g_event_bus.subscribers[i];
+            if (sub->topic == event.topic) {
+                g_event_bus.deliver(sub->owner, sub->callback, event.data);
+                atomic_fetch_add_explicit(&g_event_bus.delivered, 1, memory_order_relaxed);
+            }
+        }
+    }
+}
+
+esp_err_t pin_event_bus_get_stats(pin_event_bus_stats_t* stats) {
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    stats->published = atomic_load_explicit(&g_event_bus.published, memory_order_relaxed);
+    stats->delivered = atomic_load_explicit(&g_event_bus.delivered, memory_order_relaxed);
+    stats->dropped = atomic_load_explicit(&g_event_bus.dropped, memory_order_relaxed);
+    return ESP_OK;
+}
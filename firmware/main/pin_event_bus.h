@@ -0,0 +1,95 @@
+/**
+ * @file pin_event_bus.h
+ * @brief Pin Plugin Event Bus
+ *
+ * Publishers copy fixed-size events into a lock-free ring buffer; the
+ * plugin executor drains the ring and fans each event out to the
+ * subscribers of its topic. Topic names are interned to small integer ids.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIN_EVENT_BUS_MAX_TOPICS 16
+#define PIN_EVENT_BUS_TOPIC_MAX_LEN 24
+#define PIN_EVENT_BUS_MAX_SUBSCRIBERS 16
+#define PIN_EVENT_BUS_PAYLOAD_MAX_LEN 96
+#define PIN_EVENT_BUS_QUEUE_LEN 16          // Must be a power of two
+
+/**
+ * @brief Delivers one event to a subscriber
+ * @param owner Owner id given to pin_event_bus_subscribe()
+ * @param callback Subscriber callback
+ * @param data NUL-terminated event payload
+ */
+typedef void (*pin_event_bus_deliver_t)(uint8_t owner, void (*callback)(const char* data), const char* data);
+
+/**
+ * @brief Event bus statistics
+ */
+typedef struct {
+    uint32_t published;
+    uint32_t delivered;
+    uint32_t dropped;       // Ring was full
+} pin_event_bus_stats_t;
+
+/**
+ * @brief Initialize the event bus
+ * @param deliver Called on the draining task for every (event, subscriber) pair
+ * @param wake Called after an event is queued so the draining task runs soon
+ * @return ESP_OK on success
+ */
+esp_err_t pin_event_bus_init(pin_event_bus_deliver_t deliver, void (*wake)(void));
+
+/**
+ * @brief Look up a topic id, adding the topic if it is new
+ * @param name Topic name
+ * @param topic_id Output topic id
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the topic table is full
+ */
+esp_err_t pin_event_bus_intern(const char* name, uint8_t* topic_id);
+
+/**
+ * @brief Subscribe to a topic (subscribing twice is a no-op)
+ * @param name Topic name
+ * @param owner Owner id passed back to the deliver hook
+ * @param callback Subscriber callback
+ * @return ESP_OK on success
+ */
+esp_err_t pin_event_bus_subscribe(const char* name, uint8_t owner, void (*callback)(const char* data));
+
+/**
+ * @brief Publish an event without allocating or blocking
+ *
+ * Safe to call from any task, including esp_timer callbacks. Payloads
+ * longer than PIN_EVENT_BUS_PAYLOAD_MAX_LEN - 1 are truncated.
+ *
+ * @param name Topic name
+ * @param data Payload string (may be NULL)
+ * @return ESP_OK on success (also when nobody subscribes),
+ *         ESP_ERR_NO_MEM if the ring is full
+ */
+esp_err_t pin_event_bus_publish(const char* name, const char* data);
+
+/**
+ * @brief Deliver all queued events; runs on the plugin executor
+ */
+void pin_event_bus_dispatch(void);
+
+/**
+ * @brief Get event bus statistics
+ * @param stats Output statistics
+ * @return ESP_OK on success
+ */
+esp_err_t pin_event_bus_get_stats(pin_event_bus_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
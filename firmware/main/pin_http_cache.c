@@ -0,0 +1,410 @@
+/**
+ * @file pin_http_cache.c
+ * @brief Pin Plugin HTTP Response Cache Implementation
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include "pin_http_cache.h"
+
+static const char* TAG = "PIN_HTTP_CACHE";
+
+#define PIN_HTTP_CACHE_NVS_NAMESPACE "http_cache"
+
+// Entry header; also the first bytes of the NVS blob, followed by the body
+typedef struct {
+    uint32_t url_hash;
+    uint32_t stored_at;         // time() when stored or last revalidated
+    uint32_t max_age;           // Seconds the entry stays fresh
+    uint16_t body_len;
+    uint16_t reserved;
+    char etag[PIN_HTTP_CACHE_ETAG_MAX_LEN];
+    char last_modified[PIN_HTTP_CACHE_DATE_MAX_LEN];
+} pin_http_cache_meta_t;
+
+typedef struct {
+    pin_http_cache_meta_t meta;
+    char* body;                 // NULL when the entry is unused
+    uint32_t last_used;
+} pin_http_cache_entry_t;
+
+static struct {
+    pin_http_cache_entry_t entries[PIN_HTTP_CACHE_RAM_ENTRIES];
+    uint32_t tick;
+    SemaphoreHandle_t mutex;
+} g_http_cache = {0};
+
+// FNV-1a; entries are keyed by the hash of the full URL
+static uint32_t url_hash(const char* url) {
+    uint32_t hash = 2166136261u;
+    while (*url) {
+        hash ^= (uint8_t)*url++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void slot_key(uint32_t hash, char* key, size_t key_len) {
+    snprintf(key, key_len, "slot%u", (unsigned)(hash % PIN_HTTP_CACHE_FLASH_SLOTS));
+}
+
+static bool entry_is_fresh(const pin_http_cache_meta_t* meta) {
+    uint32_t now = (uint32_t)time(NULL);
+    // A clock that moved backwards (e.g. not yet synced) makes everything stale
+    return now >= meta->stored_at && now - meta->stored_at < meta->max_age;
+}
+
+static void entry_clear(pin_http_cache_entry_t* entry) {
+    free(entry->body);
+    memset(entry, 0, sizeof(*entry));
+}
+
+
+static pin_http_cache_entry_t* lru_victim(void) {
+    pin_http_cache_entry_t* victim = &g_http_cache.entries[0];
+    for (int i = 0; i < PIN_HTTP_CACHE_RAM_ENTRIES; i++) {
+        pin_http_cache_entry_t* entry = &g_http_cache.entries[i];
+        if (!entry->body) {
+            return entry;
+        }
+        if (entry->last_used < victim->last_used) {
+            victim = entry;
+        }
+    }
+    return victim;
+}
+
+static bool flash_load(uint32_t hash, pin_http_cache_entry_t* entry) {
+    nvs_handle_t handle;
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    size_t size = 0;
+
+    if (nvs_open(PIN_HTTP_CACHE_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return false;
+    }
+
+    slot_key(hash, key, sizeof(key));
+    if (nvs_get_blob(handle, key, NULL, &size) != ESP_OK ||
+        size < sizeof(pin_http_cache_meta_t) ||
+        size > sizeof(pin_http_cache_meta_t) + PIN_HTTP_CACHE_MAX_BODY) {
+        nvs_close(handle);
+        return false;
+    }
+
+    // Read the whole blob into one buffer, then slide the body down over the header
+    char* buffer = malloc(size + 1);
+    if (!buffer) {
+        nvs_close(handle);
+        return false;
+    }
+
+    esp_err_t err = nvs_get_blob(handle, key, buffer, &size);
+    nvs_close(handle);
+
+    pin_http_cache_meta_t meta;
+    memcpy(&meta, buffer, sizeof(meta));
+    if (err != ESP_OK || meta.url_hash != hash ||
+        size != sizeof(meta) + meta.body_len) {
+        free(buffer);
+        return false;
+    }
+
+    memmove(buffer, buffer + sizeof(meta), meta.body_len);
+    buffer[meta.body_len] = '\0';
+
+    entry_clear(entry);
+    entry->meta = meta;
+    entry->body = buffer;
+    return true;
+}
+
+static void flash_store(const pin_http_cache_entry_t* entry) {
+    nvs_handle_t handle;
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    size_t size = sizeof(entry->meta) + entry->meta.body_len;
+
+    char* blob = malloc(size);
+    if (!blob) {
+        return;
+    }
+    memcpy(blob, &entry->meta, sizeof(entry->meta));
+    memcpy(blob + sizeof(entry->meta), entry->body, entry->meta.body_len);
+
+    if (nvs_open(PIN_HTTP_CACHE_NVS_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK) {
+        slot_key(entry->meta.url_hash, key, sizeof(key));
+        if (nvs_set_blob(handle, key, blob, size) == ESP_OK) {
+            nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+
+    free(blob);
+}
+
+// Slots are shared by URLs with the same hash modulo, so only erase our own copy
+static void flash_erase(uint32_t hash) {
+    nvs_handle_t handle;
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    pin_http_cache_entry_t stored = {0};
+
+    if (!flash_load(hash, &stored)) {
+        return;
+    }
+    entry_clear(&stored);
+
+    if (nvs_open(PIN_HTTP_CACHE_NVS_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK) {
+        slot_key(hash, key, sizeof(key));
+        if (nvs_erase_key(handle, key) == ESP_OK) {
+            nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+}
+
+// Caller holds the mutex. Falls back to the flash slot on a RAM miss
+static pin_http_cache_entry_t* entry_find(uint32_t hash) {
+    for (int i = 0; i < PIN_HTTP_CACHE_RAM_ENTRIES; i++) {
+        pin_http_cache_entry_t* entry = &g_http_cache.entries[i];
+        if (entry->body && entry->meta.url_hash == hash) {
+            entry->last_used = ++g_http_cache.tick;
+            return entry;
+        }
+    }
+
+    pin_http_cache_entry_t* victim = lru_victim();
+    pin_http_cache_entry_t loaded = {0};
+    if (!flash_load(hash, &loaded)) {
+        return NULL;
+    }
+
+    entry_clear(victim);
+    *victim = loaded;
+    victim->last_used = ++g_http_cache.tick;
+    return victim;
+}
+
+static uint32_t effective_max_age(const pin_http_cache_headers_t* headers, uint32_t default_ttl) {
+    return headers->max_age >= 0 ? (uint32_t)headers->max_age : default_ttl;
+}
+
+esp_err_t pin_http_cache_init(void) {
+    if (g_http_cache.mutex) {
+        return ESP_OK;
+    }
+
+    g_http_cache.mutex = xSemaphoreCreateMutex();
+    if (!g_http_cache.mutex) {
+        ESP_LOGE(TAG, "Failed to create cache mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+void pin_http_cache_headers_reset(pin_http_cache_headers_t* headers) {
+    memset(headers, 0, sizeof(*headers));
+    headers->max_age = -1;
+}
+
+static void parse_cache_control(const char* value, pin_http_cache_headers_t* headers) {
+    while (*value) {
+        value += strspn(value, " ,");
+        size_t len = strcspn(value, ",");
+
+        if (strncasecmp(value, "max-age=", 8) == 0) {
+            headers->max_age = atoi(value + 8);
+        } else if (strncasecmp(value, "no-store", 8) == 0) {
+            headers->no_store = true;
+        } else if (strncasecmp(value, "no-cache", 8) == 0) {
+            // Cacheable, but must be revalidated before every use
+            headers->max_age = 0;
+        }
+
+        value += len;
+    }
+}
+
+esp_err_t pin_http_cache_event_handler(esp_http_client_event_t* evt) {
+    pin_http_cache_headers_t* headers = (pin_http_cache_headers_t*)evt->user_data;
+    if (evt->event_id != HTTP_EVENT_ON_HEADER || !headers) {
+        return ESP_OK;
+    }
+
+    if (strcasecmp(evt->header_key, "ETag") == 0) {
+        strncpy(headers->etag, evt->header_value, sizeof(headers->etag) - 1);
+    } else if (strcasecmp(evt->header_key, "Last-Modified") == 0) {
+        strncpy(headers->last_modified, evt->header_value, sizeof(headers->last_modified) - 1);
+    } else if (strcasecmp(evt->header_key, "Cache-Control") == 0) {
+        parse_cache_control(evt->header_value, headers);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t pin_http_cache_get_fresh(const char* url, pin_http_cache_sink_t sink, void* arg) {
+    if (!url || !sink || !g_http_cache.mutex) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+
+    xSemaphoreTake(g_http_cache.mutex, portMAX_DELAY);
+    pin_http_cache_entry_t* entry = entry_find(url_hash(url));
+    if (entry && entry_is_fresh(&entry->meta)) {
+        ret = sink(entry->body, entry->meta.body_len, arg);
+    }
+    xSemaphoreGive(g_http_cache.mutex);
+
+    if (ret == ESP_OK) {
+        ESP_LOGD(TAG, "Fresh hit for %s", url);
+    }
+    return ret;
+}
+
+bool pin_http_cache_get_validators(const char* url, pin_http_cache_headers_t* validators) {
+    if (!url || !validators || !g_http_cache.mutex) {
+        return false;
+    }
+
+    pin_http_cache_headers_reset(validators);
+
+    xSemaphoreTake(g_http_cache.mutex, portMAX_DELAY);
+    pin_http_cache_entry_t* entry = entry_find(url_hash(url));
+    if (entry) {
+        strcpy(validators->etag, entry->meta.etag);
+        strcpy(validators->last_modified, entry->meta.last_modified);
+    }
+    xSemaphoreGive(g_http_cache.mutex);
+
+    return validators->etag[0] != '\0' || validators->last_modified[0] != '\0';
+}
+
+esp_err_t pin_http_cache_revalidated(const char* url, const pin_http_cache_headers_t* headers,
+                                     uint32_t default_ttl, pin_http_cache_sink_t sink, void* arg) {
+    if (!url || !headers || !sink || !g_http_cache.mutex) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+
+    xSemaphoreTake(g_http_cache.mutex, portMAX_DELAY);
+    pin_http_cache_entry_t* entry = entry_find(url_hash(url));
+    if (entry) {
+        // Renewal is RAM-only: after a reboot the flash copy is simply revalidated again
+        entry->meta.stored_at = (uint32_t)time(NULL);
+        entry->meta.max_age = effective_max_age(headers, default_ttl);
+        if (headers->etag[0]) {
+            strcpy(entry->meta.etag, headers->etag);
+        }
+        ret = sink(entry->body, entry->meta.body_len, arg);
+    }
+    xSemaphoreGive(g_http_cache.mutex);
+
+    return ret;
+}
+
+void pin_http_cache_body_append(pin_http_cache_body_t* body, const char* data, size_t len) {
+    if (!body->overflow && body->len + len <= PIN_HTTP_CACHE_MAX_BODY) {
+        if (!body->data) {
+            body->data = malloc(PIN_HTTP_CACHE_MAX_BODY);
+        }
+        if (body->data) {
+            memcpy(body->data + body->len, data, len);
+        } else {
+            body->overflow = true;
+        }
+    } else if (!body->overflow) {
+        // Too large to cache; keep counting but stop holding memory
+        body->overflow = true;
+        free(body->data);
+        body->data = NULL;
+    }
+    body->len += len;
+}
+
+void pin_http_cache_body_free(pin_http_cache_body_t* body) {
+    free(body->data);
+    memset(body, 0, sizeof(*body));
+}
+
+void pin_http_cache_store(const char* url, const pin_http_cache_headers_t* headers,
+                          uint32_t default_ttl, const char* body, size_t len) {
+    if (!url || !headers || !g_http_cache.mutex) {
+        return;
+    }
+
+    uint32_t hash = url_hash(url);
+    uint32_t max_age = effective_max_age(headers, default_ttl);
+    bool has_validator = headers->etag[0] != '\0' || headers->last_modified[0] != '\0';
+    bool cacheable = body && !headers->no_store && len <= PIN_HTTP_CACHE_MAX_BODY &&
+                     (max_age > 0 || has_validator);
+    bool persist = has_validator || max_age >= PIN_HTTP_CACHE_PERSIST_MIN_AGE;
+
+    xSemaphoreTake(g_http_cache.mutex, portMAX_DELAY);
+
+    pin_http_cache_entry_t* entry = NULL;
+    for (int i = 0; i < PIN_HTTP_CACHE_RAM_ENTRIES; i++) {
+        if (g_http_cache.entries[i].body && g_http_cache.entries[i].meta.url_hash == hash) {
+            entry = &g_http_cache.entries[i];
+            break;
+        }
+    }
+
+    // The flash copy may be there without a RAM entry, e.g. after a reboot
+    if (!cacheable) {
+        if (entry) {
+            entry_clear(entry);
+        }
+        flash_erase(hash);
+        xSemaphoreGive(g_http_cache.mutex);
+        return;
+    }
+
+    // Only touch flash when the body or its validators actually changed
+    bool changed = !entry || entry->meta.body_len != len ||
+                   memcmp(entry->body, body, len) != 0 ||
+                   strcmp(entry->meta.etag, headers->etag) != 0 ||
+                   strcmp(entry->meta.last_modified, headers->last_modified) != 0;
+
+    if (!entry || entry->meta.body_len != len) {
+        char* copy = malloc(len + 1);
+        if (!copy) {
+            xSemaphoreGive(g_http_cache.mutex);
+            return;
+        }
+        if (!entry) {
+            entry = lru_victim();
+        }
+        entry_clear(entry);
+        entry->body = copy;
+    }
+
+    memcpy(entry->body, body, len);
+    entry->body[len] = '\0';
+    entry->meta.url_hash = hash;
+    entry->meta.stored_at = (uint32_t)time(NULL);
+    entry->meta.max_age = max_age;
+    entry->meta.body_len = (uint16_t)len;
+    strcpy(entry->meta.etag, headers->etag);
+    strcpy(entry->meta.last_modified, headers->last_modified);
+    entry->last_used = ++g_http_cache.tick;
+
+    // A body that is not persisted must not leave an older copy behind, or
+    // the old copy would be revalidated and served again after a reboot
+    if (changed) {
+        if (persist) {
+            flash_store(entry);
+        } else {
+            flash_erase(hash);
+        }
+    }
+
+    xSemaphoreGive(g_http_cache.mutex);
+}
@@ -0,0 +1,139 @@
+/**
+ * @file pin_http_cache.h
+ * @brief Pin Plugin HTTP Response Cache
+ *
+ * Caches GET responses by URL in a few RAM entries backed by a small,
+ * direct-mapped set of NVS slots. Only bodies that stay fresh for at least
+ * PIN_HTTP_CACHE_PERSIST_MIN_AGE or carry a validator are written to flash,
+ * so they survive deep sleep without a rewrite for every short-lived body.
+ * Fresh entries are served without any network traffic; stale entries
+ * with an ETag or Last-Modified validator are revalidated with a
+ * conditional request, and a 304 reuses the cached body.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_client.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIN_HTTP_CACHE_RAM_ENTRIES 4
+#define PIN_HTTP_CACHE_FLASH_SLOTS 8
+#define PIN_HTTP_CACHE_MAX_BODY 2048            // Larger responses are not cached
+#define PIN_HTTP_CACHE_ETAG_MAX_LEN 64
+#define PIN_HTTP_CACHE_DATE_MAX_LEN 32
+#define PIN_HTTP_CACHE_PERSIST_MIN_AGE 3600     // Seconds; shorter-lived bodies without validators stay in RAM
+
+/**
+ * @brief Receives a cached body; called with the cache locked, so keep it short
+ * @param data Body bytes
+ * @param len Number of bytes
+ * @param arg Caller argument
+ * @return ESP_OK to continue
+ */
+typedef esp_err_t (*pin_http_cache_sink_t)(const char* data, size_t len, void* arg);
+
+/**
+ * @brief Copy of a response body collected while it streams past
+ */
+typedef struct {
+    char* data;
+    size_t len;                                 // Keeps counting after overflow
+    bool overflow;                              // Body exceeded PIN_HTTP_CACHE_MAX_BODY
+} pin_http_cache_body_t;
+
+/**
+ * @brief Caching headers of one response
+ */
+typedef struct {
+    char etag[PIN_HTTP_CACHE_ETAG_MAX_LEN];
+    char last_modified[PIN_HTTP_CACHE_DATE_MAX_LEN];
+    int32_t max_age;                            // Seconds, -1 if not given
+    bool no_store;
+} pin_http_cache_headers_t;
+
+/**
+ * @brief Initialize the cache
+ * @return ESP_OK on success
+ */
+esp_err_t pin_http_cache_init(void);
+
+/**
+ * @brief Reset a header record before a request
+ * @param headers Record to reset
+ */
+void pin_http_cache_headers_reset(pin_http_cache_headers_t* headers);
+
+/**
+ * @brief esp_http_client event handler that records caching headers
+ *
+ * Fills the pin_http_cache_headers_t set as the client's user data;
+ * does nothing while the user data is NULL.
+ */
+esp_err_t pin_http_cache_event_handler(esp_http_client_event_t* evt);
+
+/**
+ * @brief Deliver a cached body if it is still fresh
+ * @param url Request URL
+ * @param sink Receives the body in one call
+ * @param arg Passed to sink
+ * @return ESP_OK if a fresh entry was delivered, ESP_ERR_NOT_FOUND on a miss,
+ *         or the error returned by sink
+ */
+esp_err_t pin_http_cache_get_fresh(const char* url, pin_http_cache_sink_t sink, void* arg);
+
+/**
+ * @brief Get the validators of a cached entry for a conditional request
+ * @param url Request URL
+ * @param validators Output; etag/last_modified are empty when unknown
+ * @return true if an entry with at least one validator exists
+ */
+bool pin_http_cache_get_validators(const char* url, pin_http_cache_headers_t* validators);
+
+/**
+ * @brief Handle a 304: renew the entry and deliver its body
+ * @param url Request URL
+ * @param headers Headers of the 304 response
+ * @param default_ttl Freshness in seconds when the response has no max-age
+ * @param sink Receives the body in one call
+ * @param arg Passed to sink
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the entry has gone,
+ *         or the error returned by sink
+ */
+esp_err_t pin_http_cache_revalidated(const char* url, const pin_http_cache_headers_t* headers,
+                                     uint32_t default_ttl, pin_http_cache_sink_t sink, void* arg);
+
+/**
+ * @brief Append a chunk to a body copy; stops copying past PIN_HTTP_CACHE_MAX_BODY
+ * @param body Body copy (zero-initialized before the first chunk)
+ * @param data Chunk
+ * @param len Chunk length
+ */
+void pin_http_cache_body_append(pin_http_cache_body_t* body, const char* data, size_t len);
+
+/**
+ * @brief Release a body copy
+ * @param body Body copy
+ */
+void pin_http_cache_body_free(pin_http_cache_body_t* body);
+
+/**
+ * @brief Store a complete 200 response
+ * @param url Request URL
+ * @param headers Headers of the response
+ * @param default_ttl Freshness in seconds when the response has no max-age
+ * @param body Response body; NULL (or a body that is too large) drops any cached entry
+ * @param len Body length
+ */
+void pin_http_cache_store(const char* url, const pin_http_cache_headers_t* headers,
+                          uint32_t default_ttl, const char* body, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
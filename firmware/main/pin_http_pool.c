@@ -0,0 +1,281 @@
+/**
+ * @file pin_http_pool.c
+ * @brief Pin Plugin HTTP Client Pool Implementation
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_crt_bundle.h"
+#include "pin_http_pool.h"
+
+static const char* TAG = "PIN_HTTP_POOL";
+
+typedef struct {
+    char key[PIN_HTTP_POOL_KEY_MAX_LEN];    // Empty when the slot is unused
+    esp_http_client_handle_t client;
+    bool in_use;
+    bool connected;                         // Socket left open by the last request
+    int64_t last_used_us;
+} pin_http_slot_t;
+
+static struct {
+    pin_http_slot_t slots[PIN_HTTP_POOL_SIZE];
+    SemaphoreHandle_t mutex;
+    esp_timer_handle_t idle_timer;
+    http_event_handle_cb event_handler;
+} g_http_pool = {0};
+
+// Reduce a URL to "scheme://host[:port]"; connections are only shared within a key
+static bool url_to_key(const char* url, char* key, size_t key_len) {
+    const char* host = strstr(url, "://");
+    if (!host || (strncmp(url, "http://", 7) != 0 && strncmp(url, "https://", 8) != 0)) {
+        return false;
+    }
+    host += 3;
+
+    size_t len = (size_t)(host - url) + strcspn(host, "/?#");
+    if (len == (size_t)(host - url) || len >= key_len) {
+        return false;
+    }
+
+    memcpy(key, url, len);
+    key[len] = '\0';
+    return true;
+}
+
+static void arm_idle_timer(void) {
+    if (!esp_timer_is_active(g_http_pool.idle_timer)) {
+        esp_timer_start_once(g_http_pool.idle_timer, PIN_HTTP_POOL_IDLE_TIMEOUT_MS * 1000ULL);
+    }
+}
+
+// Drop idle sockets; the client handle (and its TLS session ticket) stays for the next request
+static void close_idle(bool all) {
+    esp_http_client_handle_t to_close[PIN_HTTP_POOL_SIZE];
+    int count = 0;
+    bool remaining = false;
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(g_http_pool.mutex, portMAX_DELAY);
+    for (int i = 0; i < PIN_HTTP_POOL_SIZE; i++) {
+        pin_http_slot_t* slot = &g_http_pool.slots[i];
+        if (slot->in_use || !slot->connected) {
+            continue;
+        }
+        if (all || now - slot->last_used_us >= PIN_HTTP_POOL_IDLE_TIMEOUT_MS * 1000LL) {
+            slot->connected = false;
+            // Mark busy while closing outside the lock so nobody borrows it meanwhile
+            slot->in_use = true;
+            to_close[count++] = slot->client;
+        } else {
+            remaining = true;
+        }
+    }
+    xSemaphoreGive(g_http_pool.mutex);
+
+    for (int i = 0; i < count; i++) {
+        esp_http_client_close(to_close[i]);
+    }
+
+    if (count > 0) {
+        xSemaphoreTake(g_http_pool.mutex, portMAX_DELAY);
+        for (int i = 0; i < PIN_HTTP_POOL_SIZE; i++) {
+            for (int j = 0; j < count; j++) {
+                if (g_http_pool.slots[i].client == to_close[j]) {
+                    g_http_pool.slots[i].in_use = false;
+                }
+            }
+        }
+        xSemaphoreGive(g_http_pool.mutex);
+        ESP_LOGD(TAG, "Closed %d idle connection(s)", count);
+    }
+
+    if (remaining) {
+        arm_idle_timer();
+    }
+}
+
+static void idle_timer_callback(void* arg) {
+    close_idle(false);
+}
+
+esp_err_t pin_http_pool_init(http_event_handle_cb event_handler) {
+    if (g_http_pool.mutex) {
+        return ESP_OK;
+    }
+
+    g_http_pool.event_handler = event_handler;
+
+    g_http_pool.mutex = xSemaphoreCreateMutex();
+    if (!g_http_pool.mutex) {
+        ESP_LOGE(TAG, "Failed to create pool mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_timer_create_args_t timer_args = {
+        .callback = idle_timer_callback,
+        .name = "http_idle",
+    };
+    esp_err_t ret = esp_timer_create(&timer_args, &g_http_pool.idle_timer);
+    if (ret != ESP_OK) {
+        vSemaphoreDelete(g_http_pool.mutex);
+        g_http_pool.mutex = NULL;
+        return ret;
+    }
+
+    return ESP_OK;
+}
+
+esp_http_client_handle_t pin_http_pool_acquire(const char* url, int timeout_ms, bool* reused) {
+    char key[PIN_HTTP_POOL_KEY_MAX_LEN];
+
+    if (reused) {
+        *reused = false;
+    }
+
+    if (!url || !g_http_pool.mutex || !url_to_key(url, key, sizeof(key))) {
+        return NULL;
+    }
+
+    pin_http_slot_t* slot = NULL;
+    esp_http_client_handle_t evicted = NULL;
+
+    xSemaphoreTake(g_http_pool.mutex, portMAX_DELAY);
+
+    // Prefer an idle client for the same server, then an empty slot,
+    // then the least recently used idle client
+    pin_http_slot_t* empty = NULL;
+    pin_http_slot_t* oldest = NULL;
+    for (int i = 0; i < PIN_HTTP_POOL_SIZE; i++) {
+        pin_http_slot_t* s = &g_http_pool.slots[i];
+        if (s->in_use) {
+            continue;
+        }
+        if (s->client && strcmp(s->key, key) == 0) {
+            slot = s;
+            break;
+        }
+        if (!s->client) {
+            if (!empty) {
+                empty = s;
+            }
+        } else if (!oldest || s->last_used_us < oldest->last_used_us) {
+            oldest = s;
+        }
+    }
+
+    if (!slot) {
+        slot = empty ? empty : oldest;
+        if (slot && slot->client) {
+            evicted = slot->client;
+            slot->client = NULL;
+            slot->connected = false;
+        }
+        if (slot) {
+            strcpy(slot->key, key);
+        }
+    }
+
+    if (slot) {
+        slot->in_use = true;
+    }
+
+    xSemaphoreGive(g_http_pool.mutex);
+
+    if (!slot) {
+        ESP_LOGW(TAG, "All %d connections busy", PIN_HTTP_POOL_SIZE);
+        return NULL;
+    }
+
+    if (evicted) {
+        esp_http_client_cleanup(evicted);
+    }
+
+    if (slot->client) {
+        // Same server: switching URL keeps the connection
+        if (esp_http_client_set_url(slot->client, url) != ESP_OK) {
+            pin_http_pool_release(slot->client, false);
+            return NULL;
+        }
+        esp_http_client_set_timeout_ms(slot->client, timeout_ms);
+        esp_http_client_set_user_data(slot->client, NULL);
+        if (reused) {
+            *reused = slot->connected;
+        }
+        return slot->client;
+    }
+
+    // HTTP/1.1 connections persist by default; TCP keep-alive probes are left
+    // off so an idle pooled socket does not keep waking the radio
+    esp_http_client_config_t config = {
+        .url = url,
+        .timeout_ms = timeout_ms,
+        .event_handler = g_http_pool.event_handler,
+        .crt_bundle_attach = esp_crt_bundle_attach,
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+        .save_client_session = true,
+#endif
+    };
+
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+
+    xSemaphoreTake(g_http_pool.mutex, portMAX_DELAY);
+    slot->client = client;
+    slot->connected = false;
+    if (!client) {
+        slot->key[0] = '\0';
+        slot->in_use = false;
+    }
+    xSemaphoreGive(g_http_pool.mutex);
+
+    if (!client) {
+        ESP_LOGE(TAG, "Failed to create client for %s", key);
+    }
+    return client;
+}
+
+void pin_http_pool_release(esp_http_client_handle_t client, bool keep_alive) {
+    if (!client || !g_http_pool.mutex) {
+        return;
+    }
+
+    if (!keep_alive) {
+        // Half-read response or broken socket: start clean next time
+        esp_http_client_close(client);
+    }
+
+    bool found = false;
+
+    xSemaphoreTake(g_http_pool.mutex, portMAX_DELAY);
+    for (int i = 0; i < PIN_HTTP_POOL_SIZE; i++) {
+        pin_http_slot_t* slot = &g_http_pool.slots[i];
+        if (slot->client == client) {
+            slot->in_use = false;
+            slot->connected = keep_alive;
+            slot->last_used_us = esp_timer_get_time();
+            found = true;
+            break;
+        }
+    }
+    xSemaphoreGive(g_http_pool.mutex);
+
+    if (!found) {
+        esp_http_client_cleanup(client);
+        return;
+    }
+
+    if (keep_alive) {
+        arm_idle_timer();
+    }
+}
+
+void pin_http_pool_close_all(void) {
+    if (!g_http_pool.mutex) {
+        return;
+    }
+    esp_timer_stop(g_http_pool.idle_timer);
+    close_idle(true);
+}
@@ -0,0 +1,63 @@
+/**
+ * @file pin_http_pool.h
+ * @brief Pin Plugin HTTP Client Pool
+ *
+ * Keeps a few esp_http_client handles open between plugin requests, keyed
+ * by scheme, host and port. Requests to the same server reuse the open
+ * keep-alive connection, and HTTPS clients keep their TLS session ticket
+ * so a reconnect resumes instead of doing a full handshake. Connections
+ * idle for PIN_HTTP_POOL_IDLE_TIMEOUT_MS are closed.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_http_client.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIN_HTTP_POOL_SIZE 3                    // Connections kept open at once
+#define PIN_HTTP_POOL_KEY_MAX_LEN 80            // "https://" + host + ":port"
+#define PIN_HTTP_POOL_IDLE_TIMEOUT_MS 30000     // Close connections unused this long
+
+/**
+ * @brief Initialize the client pool
+ * @param event_handler Event handler installed on every pooled client (may be NULL);
+ *                      it sees whatever user data the borrower sets
+ * @return ESP_OK on success
+ */
+esp_err_t pin_http_pool_init(http_event_handle_cb event_handler);
+
+/**
+ * @brief Borrow a client for a URL
+ *
+ * Returns an idle client already connected to the same server when there
+ * is one; otherwise opens a new one, evicting the least recently used
+ * idle client if the pool is full.
+ *
+ * @param url Request URL (http:// or https://)
+ * @param timeout_ms Network timeout for this request
+ * @param reused Set to true if the client already had a connection (may be NULL)
+ * @return Client handle, or NULL if the URL is invalid or every slot is busy
+ */
+esp_http_client_handle_t pin_http_pool_acquire(const char* url, int timeout_ms, bool* reused);
+
+/**
+ * @brief Return a borrowed client
+ * @param client Client from pin_http_pool_acquire()
+ * @param keep_alive True if the response was read completely and the
+ *                   connection can carry another request
+ */
+void pin_http_pool_release(esp_http_client_handle_t client, bool keep_alive);
+
+/**
+ * @brief Close every idle connection, e.g. before sleeping or when WiFi drops
+ */
+void pin_http_pool_close_all(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,176 @@
+/**
+ * @file pin_init.c
+ * @brief Pin Subsystem Initialization Graph Implementation
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "pin_init.h"
+
+static const char* TAG = "PIN_INIT";
+
+static struct {
+    const pin_init_stage_t* stages;
+    pin_init_record_t records[PIN_INIT_MAX_STAGES];
+    uint8_t count;
+    EventGroupHandle_t group;
+    EventGroupHandle_t done;    // Bit i: stage i finished, whatever the outcome
+    TaskHandle_t runner;        // Task in pin_init_run(), notified when a stage starts or ends
+    portMUX_TYPE lock;
+} g_init = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static void pin_init_finish(uint8_t index, pin_init_state_t state, esp_err_t result) {
+    portENTER_CRITICAL(&g_init.lock);
+    g_init.records[index].state = state;
+    g_init.records[index].result = result;
+    g_init.records[index].end_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&g_init.lock);
+
+    if (state == PIN_INIT_DONE && g_init.stages[index].ready_bits && g_init.group) {
+        xEventGroupSetBits(g_init.group, g_init.stages[index].ready_bits);
+    }
+    xEventGroupSetBits(g_init.done, PIN_INIT_DEP(index));
+    xTaskNotifyGive(g_init.runner);
+}
+
+static void pin_init_stage_task(void* pvParameters) {
+    uint8_t index = (uint8_t)(uintptr_t)pvParameters;
+    const pin_init_stage_t* stage = &g_init.stages[index];
+
+    uint32_t wait_for = stage->depends_on | stage->runs_after;
+    if (wait_for) {
+        xEventGroupWaitBits(g_init.done, wait_for, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+
+    // Only run once everything it builds on actually came up
+    bool deps_ok = true;
+    for (uint8_t i = 0; i < index; i++) {
+        if ((stage->depends_on & PIN_INIT_DEP(i)) && g_init.records[i].state != PIN_INIT_DONE) {
+            deps_ok = false;
+            break;
+        }
+    }
+
+    if (!deps_ok) {
+        ESP_LOGW(TAG, "Skipping '%s', a dependency failed", stage->name);
+        pin_init_finish(index, PIN_INIT_SKIPPED, ESP_ERR_INVALID_STATE);
+    } else {
+        portENTER_CRITICAL(&g_init.lock);
+        g_init.records[index].state = PIN_INIT_RUNNING;
+        g_init.records[index].start_us = esp_timer_get_time();
+        portEXIT_CRITICAL(&g_init.lock);
+        xTaskNotifyGive(g_init.runner);
+
+        esp_err_t ret = stage->fn();
+        pin_init_finish(index, ret == ESP_OK ? PIN_INIT_DONE : PIN_INIT_FAILED, ret);
+
+        ESP_LOGI(TAG, "'%s' %s in %lld ms", stage->name, ret == ESP_OK ? "done" : "failed",
+                 (long long)((g_init.records[index].end_us - g_init.records[index].start_us) / 1000));
+    }
+
+    vTaskDelete(NULL);
+}
+
+esp_err_t pin_init_run(const pin_init_stage_t* stages, uint8_t count, EventGroupHandle_t group,
+                       pin_init_progress_t progress) {
+    if (!stages || count == 0 || count > PIN_INIT_MAX_STAGES || g_init.stages) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Dependencies on later stages could form a cycle, so the table must be in order
+    for (uint8_t i = 0; i < count; i++) {
+        if (!stages[i].fn || ((stages[i].depends_on | stages[i].runs_after) & ~(PIN_INIT_DEP(i) - 1))) {
+            ESP_LOGE(TAG, "Stage %u has no function or depends on a later stage", (unsigned)i);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    g_init.done = xEventGroupCreate();
+    if (!g_init.done) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(g_init.records, 0, sizeof(g_init.records));
+    for (uint8_t i = 0; i < count; i++) {
+        g_init.records[i].name = stages[i].name;
+        g_init.records[i].state = PIN_INIT_PENDING;
+    }
+    g_init.group = group;
+    g_init.runner = xTaskGetCurrentTaskHandle();
+    g_init.count = count;
+    g_init.stages = stages;
+
+    for (uint8_t i = 0; i < count; i++) {
+        uint32_t stack_size = stages[i].stack_size > 0 ? stages[i].stack_size : PIN_INIT_DEFAULT_STACK_SIZE;
+        if (xTaskCreate(pin_init_stage_task, stages[i].name, stack_size, (void*)(uintptr_t)i,
+                        PIN_INIT_TASK_PRIORITY, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "No task for stage '%s'", stages[i].name);
+            pin_init_finish(i, PIN_INIT_FAILED, ESP_ERR_NO_MEM);
+        }
+    }
+
+    // Progress is reported from here only, so the callback never races itself
+    uint32_t all = (uint32_t)((1ull << count) - 1);
+    while ((xEventGroupGetBits(g_init.done) & all) != all) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (progress) {
+            progress();
+        }
+    }
+
+    esp_err_t result = ESP_OK;
+    int64_t boot_end_us = 0;
+    int64_t serial_us = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (result == ESP_OK && g_init.records[i].state != PIN_INIT_DONE) {
+            result = g_init.records[i].result;
+        }
+        if (g_init.records[i].start_us > 0) {
+            serial_us += g_init.records[i].end_us - g_init.records[i].start_us;
+        }
+        if (g_init.records[i].end_us > boot_end_us) {
+            boot_end_us = g_init.records[i].end_us;
+        }
+    }
+    ESP_LOGI(TAG, "Boot stages finished at %lld ms (%lld ms if run one after another)",
+             (long long)(boot_end_us / 1000), (long long)(serial_us / 1000));
+
+    return result;
+}
+
+pin_init_state_t pin_init_get_state(uint8_t index) {
+    if (index >= g_init.count) {
+        return PIN_INIT_PENDING;
+    }
+    return g_init.records[index].state;
+}
+
+esp_err_t pin_init_get_timeline(pin_init_record_t* records, uint8_t max, uint8_t* count) {
+    if (!records || !count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&g_init.lock);
+    uint8_t n = g_init.count < max ? g_init.count : max;
+    memcpy(records, g_init.records, n * sizeof(pin_init_record_t));
+    portEXIT_CRITICAL(&g_init.lock);
+
+    *count = n;
+    return ESP_OK;
+}
+
+const char* pin_init_state_name(pin_init_state_t state) {
+    switch (state) {
+        case PIN_INIT_PENDING: return "pending";
+        case PIN_INIT_RUNNING: return "running";
+        case PIN_INIT_DONE: return "done";
+        case PIN_INIT_FAILED: return "failed";
+        case PIN_INIT_SKIPPED: return "skipped";
+        default: return "unknown";
+    }
+}
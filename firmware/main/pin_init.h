@@ -0,0 +1,95 @@
+/**
+ * @file pin_init.h
+ * @brief Pin Subsystem Initialization Graph
+ *
+ * Boot stages declare which earlier stages they depend on. Each stage runs
+ * on its own short-lived task as soon as its dependencies have succeeded,
+ * so independent stages overlap instead of adding up. Start and end times
+ * of every stage are kept as the boot timeline.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIN_INIT_MAX_STAGES 12
+#define PIN_INIT_DEFAULT_STACK_SIZE 4096
+#define PIN_INIT_TASK_PRIORITY 5
+
+// Dependency on the stage at index i of the table passed to pin_init_run()
+#define PIN_INIT_DEP(i) (1u << (i))
+
+typedef esp_err_t (*pin_init_fn_t)(void);
+typedef void (*pin_init_progress_t)(void);
+
+typedef struct {
+    const char* name;
+    pin_init_fn_t fn;
+    uint32_t depends_on;        // PIN_INIT_DEP() of earlier stages that must succeed first
+    uint32_t runs_after;        // PIN_INIT_DEP() of earlier stages that only have to finish
+    EventBits_t ready_bits;     // Set in the event group when fn succeeds
+    uint32_t stack_size;        // 0 = PIN_INIT_DEFAULT_STACK_SIZE
+} pin_init_stage_t;
+
+typedef enum {
+    PIN_INIT_PENDING,
+    PIN_INIT_RUNNING,
+    PIN_INIT_DONE,
+    PIN_INIT_FAILED,
+    PIN_INIT_SKIPPED            // A dependency failed
+} pin_init_state_t;
+
+// One stage in the boot timeline
+typedef struct {
+    const char* name;
+    pin_init_state_t state;
+    esp_err_t result;
+    int64_t start_us;           // esp_timer clock, 0 if the stage never ran
+    int64_t end_us;
+} pin_init_record_t;
+
+/**
+ * @brief Run a table of stages and wait until every stage has finished
+ * @param stages Stages; dependencies may only point at earlier entries
+ * @param count Number of stages (at most PIN_INIT_MAX_STAGES)
+ * @param group Event group that receives each stage's ready_bits
+ * @param progress Called on the calling task after stages start or finish;
+ *                 several changes may be reported by one call (may be NULL)
+ * @return ESP_OK if every stage succeeded, otherwise the first failure
+ */
+esp_err_t pin_init_run(const pin_init_stage_t* stages, uint8_t count, EventGroupHandle_t group,
+                       pin_init_progress_t progress);
+
+/**
+ * @brief Get the state of one stage after pin_init_run()
+ * @param index Stage index
+ * @return Stage state, PIN_INIT_PENDING for an unknown index
+ */
+pin_init_state_t pin_init_get_state(uint8_t index);
+
+/**
+ * @brief Copy the boot timeline
+ * @param records Output records, in table order
+ * @param max Capacity of records
+ * @param count Number of records written
+ * @return ESP_OK on success
+ */
+esp_err_t pin_init_get_timeline(pin_init_record_t* records, uint8_t max, uint8_t* count);
+
+/**
+ * @brief Get a printable name for a stage state
+ * @param state Stage state
+ * @return Static string
+ */
+const char* pin_init_state_name(pin_init_state_t state);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,243 @@
+/**
+ * @file pin_jobs.c
+ * @brief Pin Background Jobs Implementation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "pin_jobs.h"
+#include "pin_event_bus.h"
+
+static const char* TAG = "PIN_JOBS";
+
+typedef struct {
+    uint32_t id;                // 0 = slot never used
+    char name[PIN_JOBS_NAME_MAX_LEN];
+    pin_job_fn_t fn;
+    uint8_t arg[PIN_JOBS_ARG_MAX_LEN];
+    size_t arg_size;
+    pin_job_state_t state;
+    esp_err_t result;
+    int64_t submitted_us;
+    int64_t started_us;
+    int64_t finished_us;
+} pin_job_t;
+
+static struct {
+    pin_job_t jobs[PIN_JOBS_MAX];
+    uint32_t next_id;
+    QueueHandle_t queue;        // Slot indexes in submission order
+    TaskHandle_t task;
+    portMUX_TYPE lock;
+} g_jobs = {
+    .next_id = 1,
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static bool pin_jobs_finished(const pin_job_t* job) {
+    return job->state == PIN_JOB_STATE_DONE || job->state == PIN_JOB_STATE_FAILED;
+}
+
+// An unused slot, else the one of the oldest finished job; lock held
+static pin_job_t* pin_jobs_free_slot(void) {
+    pin_job_t* oldest = NULL;
+    for (int i = 0; i < PIN_JOBS_MAX; i++) {
+        pin_job_t* job = &g_jobs.jobs[i];
+        if (job->id == 0) {
+            return job;
+        }
+        if (pin_jobs_finished(job) && (!oldest || job->id < oldest->id)) {
+            oldest = job;
+        }
+    }
+    return oldest;
+}
+
+// Lock held
+static void pin_jobs_fill_info(const pin_job_t* job, int64_t now_us, pin_job_info_t* info) {
+    int64_t started_us = job->state == PIN_JOB_STATE_QUEUED ? now_us : job->started_us;
+    int64_t finished_us = pin_jobs_finished(job) ? job->finished_us : now_us;
+
+    memset(info, 0, sizeof(pin_job_info_t));
+    info->id = job->id;
+    memcpy(info->name, job->name, sizeof(info->name));
+    info->state = job->state;
+    info->result = job->result;
+    info->queued_ms = (uint32_t)((started_us - job->submitted_us) / 1000);
+    info->run_ms = job->state == PIN_JOB_STATE_QUEUED ? 0 : (uint32_t)((finished_us - job->started_us) / 1000);
+    info->age_ms = (uint32_t)((now_us - job->submitted_us) / 1000);
+}
+
+static void pin_jobs_task(void* pvParameters) {
+    uint8_t slot;
+    while (true) {
+        if (xQueueReceive(g_jobs.queue, &slot, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        // A slot is not reused before its job has finished, so it is ours until then
+        pin_job_t* job = &g_jobs.jobs[slot];
+        portENTER_CRITICAL(&g_jobs.lock);
+        job->state = PIN_JOB_STATE_RUNNING;
+        job->started_us = esp_timer_get_time();
+        portEXIT_CRITICAL(&g_jobs.lock);
+
+        esp_err_t result = job->fn(job->arg_size > 0 ? job->arg : NULL);
+
+        // Once finished the slot may be reused, so report from a copy
+        pin_job_info_t info;
+        portENTER_CRITICAL(&g_jobs.lock);
+        job->result = result;
+        job->finished_us = esp_timer_get_time();
+        job->state = result == ESP_OK ? PIN_JOB_STATE_DONE : PIN_JOB_STATE_FAILED;
+        pin_jobs_fill_info(job, job->finished_us, &info);
+        portEXIT_CRITICAL(&g_jobs.lock);
+
+        if (result == ESP_OK) {
+            ESP_LOGI(TAG, "Job %lu (%s) done in %lu ms", (unsigned long)info.id, info.name,
+                     (unsigned long)info.run_ms);
+        } else {
+            ESP_LOGW(TAG, "Job %lu (%s) failed after %lu ms: %s", (unsigned long)info.id, info.name,
+                     (unsigned long)info.run_ms, esp_err_to_name(result));
+        }
+
+        char event[PIN_EVENT_BUS_PAYLOAD_MAX_LEN];
+        snprintf(event, sizeof(event), "{\"id\":%lu,\"name\":\"%s\",\"state\":\"%s\"}",
+                 (unsigned long)info.id, info.name, pin_jobs_state_name(info.state));
+        pin_event_bus_publish(PIN_JOBS_EVENT_TOPIC, event);
+    }
+}
+
+esp_err_t pin_jobs_init(void) {
+    if (g_jobs.task) {
+        return ESP_OK;
+    }
+
+    g_jobs.queue = xQueueCreate(PIN_JOBS_MAX, sizeof(uint8_t));
+    if (!g_jobs.queue) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(pin_jobs_task, "pin_jobs", PIN_JOBS_STACK_SIZE, NULL,
+                    PIN_JOBS_TASK_PRIORITY, &g_jobs.task) != pdPASS) {
+        vQueueDelete(g_jobs.queue);
+        g_jobs.queue = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Job worker started");
+    return ESP_OK;
+}
+
+esp_err_t pin_jobs_submit(const char* name, pin_job_fn_t fn, const void* arg, size_t arg_size, uint32_t* id) {
+    if (!name || !fn || !id || arg_size > PIN_JOBS_ARG_MAX_LEN || (!arg && arg_size > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!g_jobs.task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    portENTER_CRITICAL(&g_jobs.lock);
+
+    // Asking again before the worker got to it changes nothing
+    for (int i = 0; i < PIN_JOBS_MAX; i++) {
+        const pin_job_t* job = &g_jobs.jobs[i];
+        if (job->id != 0 && job->state == PIN_JOB_STATE_QUEUED && job->fn == fn &&
+            job->arg_size == arg_size && (arg_size == 0 || memcmp(job->arg, arg, arg_size) == 0) &&
+            strncmp(job->name, name, PIN_JOBS_NAME_MAX_LEN - 1) == 0) {
+            *id = job->id;
+            portEXIT_CRITICAL(&g_jobs.lock);
+            return ESP_OK;
+        }
+    }
+
+    pin_job_t* job = pin_jobs_free_slot();
+    if (!job) {
+        portEXIT_CRITICAL(&g_jobs.lock);
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(job, 0, sizeof(pin_job_t));
+    job->id = g_jobs.next_id++;
+    strncpy(job->name, name, sizeof(job->name) - 1);
+    job->fn = fn;
+    if (arg_size > 0) {
+        memcpy(job->arg, arg, arg_size);
+    }
+    job->arg_size = arg_size;
+    job->state = PIN_JOB_STATE_QUEUED;
+    job->submitted_us = esp_timer_get_time();
+    *id = job->id;
+    uint8_t slot = (uint8_t)(job - g_jobs.jobs);
+
+    portEXIT_CRITICAL(&g_jobs.lock);
+
+    // The queue holds every slot, so this cannot fail
+    xQueueSend(g_jobs.queue, &slot, 0);
+    ESP_LOGD(TAG, "Queued job %lu (%s)", (unsigned long)*id, name);
+    return ESP_OK;
+}
+
+esp_err_t pin_jobs_get(uint32_t id, pin_job_info_t* info) {
+    if (!info) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    portENTER_CRITICAL(&g_jobs.lock);
+    for (int i = 0; i < PIN_JOBS_MAX; i++) {
+        if (id != 0 && g_jobs.jobs[i].id == id) {
+            pin_jobs_fill_info(&g_jobs.jobs[i], now_us, info);
+            ret = ESP_OK;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&g_jobs.lock);
+    return ret;
+}
+
+esp_err_t pin_jobs_list(pin_job_info_t* infos, size_t max_count, size_t* count) {
+    if (!infos || !count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    size_t n = 0;
+    portENTER_CRITICAL(&g_jobs.lock);
+    for (int i = 0; i < PIN_JOBS_MAX && n < max_count; i++) {
+        if (g_jobs.jobs[i].id != 0) {
+            pin_jobs_fill_info(&g_jobs.jobs[i], now_us, &infos[n++]);
+        }
+    }
+    portEXIT_CRITICAL(&g_jobs.lock);
+
+    // Slots are reused out of order; sort by id (insertion sort, at most PIN_JOBS_MAX)
+    for (size_t i = 1; i < n; i++) {
+        pin_job_info_t info = infos[i];
+        size_t j = i;
+        while (j > 0 && infos[j - 1].id > info.id) {
+            infos[j] = infos[j - 1];
+            j--;
+        }
+        infos[j] = info;
+    }
+
+    *count = n;
+    return ESP_OK;
+}
+
+const char* pin_jobs_state_name(pin_job_state_t state) {
+    switch (state) {
+        case PIN_JOB_STATE_QUEUED: return "queued";
+        case PIN_JOB_STATE_RUNNING: return "running";
+        case PIN_JOB_STATE_DONE: return "done";
+        case PIN_JOB_STATE_FAILED: return "failed";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,100 @@
+/**
+ * @file pin_jobs.h
+ * @brief Pin Background Jobs
+ *
+ * Operations that take seconds (a full e-paper refresh, the OTA check)
+ * are handed to a single worker task instead of running in the web
+ * server task, which would otherwise stop answering until they finish.
+ * A submitted job gets an id whose state can be polled; finished jobs
+ * are kept until their slot is needed again. Jobs run one at a time in
+ * submission order, and a job submitted while an identical one is still
+ * queued is merged into it. Every finished job is also published on the
+ * event bus under PIN_JOBS_EVENT_TOPIC.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIN_JOBS_MAX 8                      // Queued, running and remembered jobs
+#define PIN_JOBS_NAME_MAX_LEN 16
+#define PIN_JOBS_ARG_MAX_LEN 32             // Arguments are copied into the job
+#define PIN_JOBS_STACK_SIZE 8192            // The OTA check runs TLS
+#define PIN_JOBS_TASK_PRIORITY 4
+#define PIN_JOBS_EVENT_TOPIC "job.done"     // Payload: {"id":1,"name":"refresh","state":"done"}
+
+typedef enum {
+    PIN_JOB_STATE_QUEUED = 0,
+    PIN_JOB_STATE_RUNNING,
+    PIN_JOB_STATE_DONE,
+    PIN_JOB_STATE_FAILED
+} pin_job_state_t;
+
+/**
+ * @brief Job function, runs on the worker task
+ * @param arg The job's copy of the argument given to pin_jobs_submit()
+ * @return ESP_OK if the job succeeded
+ */
+typedef esp_err_t (*pin_job_fn_t)(void* arg);
+
+typedef struct {
+    uint32_t id;
+    char name[PIN_JOBS_NAME_MAX_LEN];
+    pin_job_state_t state;
+    esp_err_t result;               // Valid once done or failed
+    uint32_t queued_ms;             // Waiting for the worker
+    uint32_t run_ms;                // Running, so far or in total
+    uint32_t age_ms;                // Since submission
+} pin_job_info_t;
+
+/**
+ * @brief Start the job worker
+ * @return ESP_OK on success
+ */
+esp_err_t pin_jobs_init(void);
+
+/**
+ * @brief Queue a job
+ * @param name Job name, reported with its state
+ * @param fn Job function
+ * @param arg Argument, copied into the job (may be NULL)
+ * @param arg_size Size of arg, at most PIN_JOBS_ARG_MAX_LEN
+ * @param id Output job id
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if every slot holds a queued
+ *         or running job, ESP_ERR_INVALID_STATE before pin_jobs_init()
+ */
+esp_err_t pin_jobs_submit(const char* name, pin_job_fn_t fn, const void* arg, size_t arg_size, uint32_t* id);
+
+/**
+ * @brief Get the state of a job
+ * @param id Job id
+ * @param info Output job state
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the job is unknown or forgotten
+ */
+esp_err_t pin_jobs_get(uint32_t id, pin_job_info_t* info);
+
+/**
+ * @brief List the jobs still known, oldest first
+ * @param infos Output array
+ * @param max_count Size of infos
+ * @param count Output number of jobs written
+ * @return ESP_OK on success
+ */
+esp_err_t pin_jobs_list(pin_job_info_t* infos, size_t max_count, size_t* count);
+
+/**
+ * @brief Name of a job state as used in the API
+ * @param state Job state
+ * @return State name
+ */
+const char* pin_jobs_state_name(pin_job_state_t state);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,403 @@
+/**
+ * @file pin_json_stream.c
+ * @brief Pin Streaming JSON Path Extractor Implementation
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include "pin_json_stream.h"
+
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME 16777619u
+
+enum {
+    ST_VALUE,           // Expecting a value
+    ST_ARRAY_FIRST,     // After '[': a value or ']'
+    ST_KEY_OR_END,      // After '{': a key or '}'
+    ST_KEY_NEXT,        // After ',' in an object: a key
+    ST_KEY,             // Inside a key
+    ST_COLON,
+    ST_STRING,          // Inside a string value
+    ST_PRIMITIVE,       // Inside a number or literal
+    ST_AFTER_VALUE,     // Expecting ',' or a closing bracket
+    ST_SKIP,            // Inside a subtree no path reaches
+    ST_DONE,
+    ST_ERROR
+};
+
+static inline uint32_t fnv_step(uint32_t hash, char c) {
+    return (hash ^ (uint8_t)c) * FNV_PRIME;
+}
+
+esp_err_t pin_json_path_compile(const char* spec, pin_json_path_t* path) {
+    if (!spec || !path) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(path, 0, sizeof(*path));
+    const char* p = spec;
+
+    while (*p) {
+        if (path->depth >= PIN_JSON_STREAM_MAX_DEPTH) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        pin_json_segment_t* seg = &path->segments[path->depth];
+
+        if (*p == '[') {
+            char* end;
+            unsigned long index = strtoul(p + 1, &end, 10);
+            if (end == p + 1 || *end != ']') {
+                return ESP_ERR_INVALID_ARG;
+            }
+            seg->key = (uint32_t)index;
+            seg->is_index = true;
+            p = end + 1;
+        } else {
+            if (path->depth > 0) {
+                if (*p != '.') {
+                    return ESP_ERR_INVALID_ARG;
+                }
+                p++;
+            }
+            uint32_t hash = FNV_OFFSET;
+            const char* start = p;
+            while (*p && *p != '.' && *p != '[') {
+                hash = fnv_step(hash, *p++);
+            }
+            if (p == start) {
+                return ESP_ERR_INVALID_ARG;
+            }
+            seg->key = hash;
+            seg->is_index = false;
+        }
+        path->depth++;
+    }
+
+    return path->depth > 0 ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+void pin_json_stream_init(pin_json_stream_t* stream, const pin_json_path_t* paths, uint8_t path_count,
+                          pin_json_value_cb_t on_value, void* user_data) {
+    memset(stream, 0, sizeof(*stream));
+    stream->paths = paths;
+    stream->path_count = path_count > PIN_JSON_STREAM_MAX_PATHS ? PIN_JSON_STREAM_MAX_PATHS : path_count;
+    stream->on_value = on_value;
+    stream->user_data = user_data;
+    stream->state = ST_VALUE;
+}
+
+// Paths that can still match a value starting at the current position
+static uint32_t value_start_mask(const pin_json_stream_t* s) {
+    if (s->depth == 0) {
+        return s->path_count == 32 ? UINT32_MAX : (1u << s->path_count) - 1;
+    }
+
+    const pin_json_frame_t* frame = &s->frames[s->depth - 1];
+    uint32_t mask = 0;
+    for (uint8_t i = 0; i < s->path_count; i++) {
+        if (!(frame->mask & (1u << i))) {
+            continue;
+        }
+        const pin_json_path_t* path = &s->paths[i];
+        if (s->depth <= path->depth) {
+            const pin_json_segment_t* seg = &path->segments[s->depth - 1];
+            if (seg->is_index == frame->is_array && seg->key == frame->key) {
+                mask |= 1u << i;
+            }
+        }
+    }
+    return mask;
+}
+
+// Narrow a mask to paths exactly depth segments long (equal) or longer
+static uint32_t mask_by_depth(const pin_json_stream_t* s, uint32_t mask, bool equal) {
+    uint32_t result = 0;
+    for (uint8_t i = 0; i < s->path_count; i++) {
+        if ((mask & (1u << i)) &&
+            (equal ? s->paths[i].depth == s->depth : s->paths[i].depth > s->depth)) {
+            result |= 1u << i;
+        }
+    }
+    return result;
+}
+
+static void emit_value(pin_json_stream_t* s, pin_json_type_t type) {
+    s->value[s->value_len] = '\0';
+    for (uint8_t i = 0; i < s->path_count; i++) {
+        if (s->value_mask & (1u << i)) {
+            s->on_value(i, type, s->value, s->user_data);
+        }
+    }
+}
+
+static void append_value(pin_json_stream_t* s, char c) {
+    if (s->value_mask && s->value_len < PIN_JSON_STREAM_VALUE_MAX_LEN - 1) {
+        s->value[s->value_len++] = c;
+    }
+}
+
+static void append_codepoint(pin_json_stream_t* s, uint16_t cp) {
+    if (cp < 0x80) {
+        append_value(s, (char)cp);
+    } else if (cp < 0x800) {
+        append_value(s, (char)(0xC0 | (cp >> 6)));
+        append_value(s, (char)(0x80 | (cp & 0x3F)));
+    } else {
+        append_value(s, (char)(0xE0 | (cp >> 12)));
+        append_value(s, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        append_value(s, (char)(0x80 | (cp & 0x3F)));
+    }
+}
+
+static void close_container(pin_json_stream_t* s) {
+    s->depth--;
+    s->state = s->depth == 0 ? ST_DONE : ST_AFTER_VALUE;
+}
+
+static void begin_value(pin_json_stream_t* s, char c) {
+    uint32_t mask = value_start_mask(s);
+
+    if (c == '{' || c == '[') {
+        uint32_t child_mask = mask_by_depth(s, mask, false);
+        if ((s->depth > 0 && child_mask == 0) || s->depth >= PIN_JSON_STREAM_MAX_DEPTH) {
+            s->skip_depth = 1;
+            s->skip_in_string = false;
+            s->escape = false;
+            s->state = ST_SKIP;
+            return;
+        }
+        pin_json_frame_t* frame = &s->frames[s->depth++];
+        frame->mask = child_mask;
+        frame->key = 0;
+        frame->is_array = c == '[';
+        s->state = frame->is_array ? ST_ARRAY_FIRST : ST_KEY_OR_END;
+        return;
+    }
+
+    s->value_mask = s->depth > 0 ? mask_by_depth(s, mask, true) : 0;
+    s->value_len = 0;
+
+    if (c == '"') {
+        s->escape = false;
+        s->unicode_digits = 0;
+        s->state = ST_STRING;
+    } else if (c == '-' || isdigit((unsigned char)c) || c == 't' || c == 'f' || c == 'n') {
+        append_value(s, c);
+        s->state = ST_PRIMITIVE;
+    } else {
+        s->state = ST_ERROR;
+    }
+}
+
+// Handles one character of a string; returns true when the closing quote is reached
+static bool string_char(pin_json_stream_t* s, char c, bool is_key) {
+    if (s->unicode_digits > 0) {
+        int digit = isdigit((unsigned char)c) ? c - '0' :
+                    (c >= 'a' && c <= 'f') ? c - 'a' + 10 :
+                    (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+        if (digit < 0) {
+            s->state = ST_ERROR;
+            return false;
+        }
+        s->unicode = (uint16_t)((s->unicode << 4) | digit);
+        if (--s->unicode_digits == 0) {
+            if (is_key) {
+                s->key_hash = fnv_step(s->key_hash, (char)s->unicode);
+            } else {
+                // Surrogate halves are not paired up; they become '?'
+                append_codepoint(s, (s->unicode >= 0xD800 && s->unicode <= 0xDFFF) ? '?' : s->unicode);
+            }
+        }
+        return false;
+    }
+
+    if (s->escape) {
+        s->escape = false;
+        char decoded;
+        switch (c) {
+            case 'b': decoded = '\b'; break;
+            case 'f': decoded = '\f'; break;
+            case 'n': decoded = '\n'; break;
+            case 'r': decoded = '\r'; break;
+            case 't': decoded = '\t'; break;
+            case 'u':
+                s->unicode = 0;
+                s->unicode_digits = 4;
+                return false;
+            default: decoded = c; break;
+        }
+        if (is_key) {
+            s->key_hash = fnv_step(s->key_hash, decoded);
+        } else {
+            append_value(s, decoded);
+        }
+        return false;
+    }
+
+    if (c == '\\') {
+        s->escape = true;
+        return false;
+    }
+    if (c == '"') {
+        return true;
+    }
+
+    if (is_key) {
+        s->key_hash = fnv_step(s->key_hash, c);
+    } else {
+        append_value(s, c);
+    }
+    return false;
+}
+
+static void skip_char(pin_json_stream_t* s, char c) {
+    if (s->skip_in_string) {
+        if (s->escape) {
+            s->escape = false;
+        } else if (c == '\\') {
+            s->escape = true;
+        } else if (c == '"') {
+            s->skip_in_string = false;
+        }
+        return;
+    }
+
+    if (c == '"') {
+        s->skip_in_string = true;
+    } else if (c == '{' || c == '[') {
+        s->skip_depth++;
+    } else if (c == '}' || c == ']') {
+        if (--s->skip_depth == 0) {
+            s->state = ST_AFTER_VALUE;
+        }
+    }
+}
+
+static void step(pin_json_stream_t* s, char c) {
+    bool space = c == ' ' || c == '\t' || c == '\n' || c == '\r';
+
+    switch (s->state) {
+        case ST_SKIP:
+            skip_char(s, c);
+            return;
+
+        case ST_STRING:
+            if (string_char(s, c, false)) {
+                if (s->value_mask) {
+                    emit_value(s, PIN_JSON_STRING);
+                }
+                s->state = s->depth == 0 ? ST_DONE : ST_AFTER_VALUE;
+            }
+            return;
+
+        case ST_KEY:
+            if (string_char(s, c, true)) {
+                s->frames[s->depth - 1].key = s->key_hash;
+                s->state = ST_COLON;
+            }
+            return;
+
+        case ST_PRIMITIVE:
+            if (isalnum((unsigned char)c) || c == '.' || c == '+' || c == '-') {
+                append_value(s, c);
+                return;
+            }
+            if (s->value_mask) {
+                emit_value(s, PIN_JSON_PRIMITIVE);
+            }
+            s->state = s->depth == 0 ? ST_DONE : ST_AFTER_VALUE;
+            // The delimiter belongs to the enclosing container
+            step(s, c);
+            return;
+
+        default:
+            break;
+    }
+
+    if (space) {
+        return;
+    }
+
+    switch (s->state) {
+        case ST_ARRAY_FIRST:
+            if (c == ']') {
+                close_container(s);
+                return;
+            }
+            begin_value(s, c);
+            return;
+
+        case ST_VALUE:
+            begin_value(s, c);
+            return;
+
+        case ST_KEY_OR_END:
+            if (c == '}') {
+                close_container(s);
+                return;
+            }
+            // fall through
+        case ST_KEY_NEXT:
+            if (c == '"') {
+                s->key_hash = FNV_OFFSET;
+                s->escape = false;
+                s->unicode_digits = 0;
+                s->state = ST_KEY;
+            } else {
+                s->state = ST_ERROR;
+            }
+            return;
+
+        case ST_COLON:
+            s->state = c == ':' ? ST_VALUE : ST_ERROR;
+            return;
+
+        case ST_AFTER_VALUE: {
+            pin_json_frame_t* frame = &s->frames[s->depth - 1];
+            if (c == ',') {
+                if (frame->is_array) {
+                    frame->key++;
+                    s->state = ST_VALUE;
+                } else {
+                    s->state = ST_KEY_NEXT;
+                }
+            } else if (c == (frame->is_array ? ']' : '}')) {
+                close_container(s);
+            } else {
+                s->state = ST_ERROR;
+            }
+            return;
+        }
+
+        default:
+            // Anything after the document, or after an error
+            s->state = ST_ERROR;
+            return;
+    }
+}
+
+esp_err_t pin_json_stream_feed(pin_json_stream_t* stream, const char* data, size_t len) {
+    if (!stream || (!data && len > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (size_t i = 0; i < len && stream->state != ST_ERROR; i++) {
+        step(stream, data[i]);
+    }
+
+    return stream->state == ST_ERROR ? ESP_ERR_INVALID_RESPONSE : ESP_OK;
+}
+
+esp_err_t pin_json_stream_finish(pin_json_stream_t* stream) {
+    if (!stream) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // A top-level number has no delimiter to end it
+    if (stream->state == ST_PRIMITIVE && stream->depth == 0) {
+        stream->state = ST_DONE;
+    }
+
+    return stream->state == ST_DONE ? ESP_OK : ESP_ERR_INVALID_RESPONSE;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file pin_json_stream.h
+ * @brief Pin Streaming JSON Path Extractor
+ *
+ * A push parser in the spirit of jsmn that never allocates: the document
+ * is fed in arbitrary chunks and the scalar values at a set of compiled
+ * paths (e.g. "main.temp", "weather[0].icon") are reported as they
+ * complete. Subtrees no path can reach are skipped with a depth counter,
+ * so memory use is fixed however large or deep the document is.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIN_JSON_STREAM_MAX_DEPTH 6         // Segments per path, and tracked nesting
+#define PIN_JSON_STREAM_MAX_PATHS 32        // Paths per parser (one mask bit each)
+#define PIN_JSON_STREAM_VALUE_MAX_LEN 128   // Longer values are truncated
+
+typedef enum {
+    PIN_JSON_STRING,        // Unescaped string contents
+    PIN_JSON_PRIMITIVE      // Number, true, false or null as written
+} pin_json_type_t;
+
+typedef struct {
+    uint32_t key;           // Key hash, or the array index
+    bool is_index;
+} pin_json_segment_t;
+
+typedef struct {
+    pin_json_segment_t segments[PIN_JSON_STREAM_MAX_DEPTH];
+    uint8_t depth;
+} pin_json_path_t;
+
+/**
+ * @brief Called for every scalar found at a compiled path
+ * @param path_index Index of the path in the array given to pin_json_stream_init()
+ * @param type Value type
+ * @param value NUL-terminated value text
+ * @param user_data User data given to pin_json_stream_init()
+ */
+typedef void (*pin_json_value_cb_t)(uint8_t path_index, pin_json_type_t type,
+                                    const char* value, void* user_data);
+
+typedef struct {
+    uint32_t mask;          // Paths still matching at this level
+    uint32_t key;           // Current member key hash, or element index
+    bool is_array;
+} pin_json_frame_t;
+
+/**
+ * @brief Parser state; lives on the caller's stack or in static storage
+ */
+typedef struct {
+    const pin_json_path_t* paths;
+    uint8_t path_count;
+    pin_json_value_cb_t on_value;
+    void* user_data;
+
+    pin_json_frame_t frames[PIN_JSON_STREAM_MAX_DEPTH];
+    uint8_t depth;
+    uint8_t state;
+    uint16_t skip_depth;        // Nesting inside a skipped subtree
+    uint32_t value_mask;        // Paths the current scalar completes
+    uint32_t key_hash;
+    bool escape;
+    bool skip_in_string;
+    uint8_t unicode_digits;
+    uint16_t unicode;
+    char value[PIN_JSON_STREAM_VALUE_MAX_LEN];
+    uint8_t value_len;
+} pin_json_stream_t;
+
+/**
+ * @brief Compile a dotted path such as "weather[0].icon"
+ * @param spec Path text
+ * @param path Output compiled path
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the path is malformed or too deep
+ */
+esp_err_t pin_json_path_compile(const char* spec, pin_json_path_t* path);
+
+/**
+ * @brief Start parsing a new document
+ * @param stream Parser state
+ * @param paths Compiled paths (must outlive the parse)
+ * @param path_count Number of paths (at most PIN_JSON_STREAM_MAX_PATHS)
+ * @param on_value Value callback
+ * @param user_data Passed to on_value
+ */
+void pin_json_stream_init(pin_json_stream_t* stream, const pin_json_path_t* paths, uint8_t path_count,
+                          pin_json_value_cb_t on_value, void* user_data);
+
+/**
+ * @brief Feed the next chunk of the document
+ * @param stream Parser state
+ * @param data Chunk
+ * @param len Chunk length
+ * @return ESP_OK, or ESP_ERR_INVALID_RESPONSE on malformed JSON
+ */
+esp_err_t pin_json_stream_feed(pin_json_stream_t* stream, const char* data, size_t len);
+
+/**
+ * @brief Check that a complete document was parsed
+ * @param stream Parser state
+ * @return ESP_OK if the top-level value is closed, ESP_ERR_INVALID_RESPONSE otherwise
+ */
+esp_err_t pin_json_stream_finish(pin_json_stream_t* stream);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,208 @@
+/**
+ * @file pin_json_writer.c
+ * @brief Pin Streaming JSON Writer Implementation
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "pin_json_writer.h"
+
+static void writer_flush(pin_json_writer_t* w) {
+    if (w->len == 0 || w->err != ESP_OK) {
+        return;
+    }
+    w->err = w->flush(w->buf, w->len, w->ctx);
+    w->len = 0;
+}
+
+static void writer_put(pin_json_writer_t* w, const char* data, size_t len) {
+    while (len > 0 && w->err == ESP_OK) {
+        size_t n = sizeof(w->buf) - w->len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(w->buf + w->len, data, n);
+        w->len += n;
+        w->total += n;
+        data += n;
+        len -= n;
+        if (w->len == sizeof(w->buf)) {
+            writer_flush(w);
+        }
+    }
+}
+
+static inline void writer_putc(pin_json_writer_t* w, char c) {
+    writer_put(w, &c, 1);
+}
+
+static void writer_indent(pin_json_writer_t* w, uint8_t depth) {
+    writer_putc(w, '\n');
+    for (uint8_t i = 0; i < depth; i++) {
+        writer_putc(w, '\t');
+    }
+}
+
+static void writer_put_string(pin_json_writer_t* w, const char* s) {
+    writer_putc(w, '"');
+    const char* run = s;
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        // Copy the plain run in one go, then the escape
+        writer_put(w, run, s - run);
+        run = s + 1;
+        char esc[7];
+        switch (c) {
+            case '"':  writer_put(w, "\\\"", 2); break;
+            case '\\': writer_put(w, "\\\\", 2); break;
+            case '\b': writer_put(w, "\\b", 2); break;
+            case '\f': writer_put(w, "\\f", 2); break;
+            case '\n': writer_put(w, "\\n", 2); break;
+            case '\r': writer_put(w, "\\r", 2); break;
+            case '\t': writer_put(w, "\\t", 2); break;
+            default:
+                snprintf(esc, sizeof(esc), "\\u%04x", c);
+                writer_put(w, esc, 6);
+                break;
+        }
+    }
+    writer_put(w, run, s - run);
+    writer_putc(w, '"');
+}
+
+// Separator, indentation and key in front of every value
+static void writer_member(pin_json_writer_t* w, const char* key) {
+    if (w->err != ESP_OK || w->depth == 0) {
+        return;
+    }
+
+    uint32_t bit = 1u << (w->depth - 1);
+    if (w->has_members & bit) {
+        writer_putc(w, ',');
+    }
+    w->has_members |= bit;
+    if (w->pretty) {
+        writer_indent(w, w->depth);
+    }
+    if (key) {
+        writer_put_string(w, key);
+        writer_putc(w, ':');
+        if (w->pretty) {
+            writer_putc(w, '\t');
+        }
+    }
+}
+
+static void writer_open(pin_json_writer_t* w, const char* key, char bracket) {
+    writer_member(w, key);
+    if (w->depth >= PIN_JSON_WRITER_MAX_DEPTH) {
+        if (w->err == ESP_OK) {
+            w->err = ESP_ERR_INVALID_STATE;
+        }
+        return;
+    }
+    writer_putc(w, bracket);
+    w->depth++;
+    w->has_members &= ~(1u << (w->depth - 1));
+}
+
+static void writer_close(pin_json_writer_t* w, char bracket) {
+    if (w->depth == 0) {
+        if (w->err == ESP_OK) {
+            w->err = ESP_ERR_INVALID_STATE;
+        }
+        return;
+    }
+
+    uint32_t bit = 1u << (w->depth - 1);
+    w->depth--;
+    if (w->pretty && (w->has_members & bit)) {
+        writer_indent(w, w->depth);
+    }
+    writer_putc(w, bracket);
+}
+
+void pin_json_writer_init(pin_json_writer_t* writer, pin_json_writer_flush_t flush, void* ctx, bool pretty) {
+    memset(writer, 0, offsetof(pin_json_writer_t, buf));
+    writer->flush = flush;
+    writer->ctx = ctx;
+    writer->pretty = pretty;
+    writer->err = flush ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+void pin_json_writer_object_begin(pin_json_writer_t* writer, const char* key) {
+    writer_open(writer, key, '{');
+}
+
+void pin_json_writer_object_end(pin_json_writer_t* writer) {
+    writer_close(writer, '}');
+}
+
+void pin_json_writer_array_begin(pin_json_writer_t* writer, const char* key) {
+    writer_open(writer, key, '[');
+}
+
+void pin_json_writer_array_end(pin_json_writer_t* writer) {
+    writer_close(writer, ']');
+}
+
+void pin_json_writer_string(pin_json_writer_t* writer, const char* key, const char* value) {
+    writer_member(writer, key);
+    if (value) {
+        writer_put_string(writer, value);
+    } else {
+        writer_put(writer, "null", 4);
+    }
+}
+
+void pin_json_writer_int(pin_json_writer_t* writer, const char* key, int64_t value) {
+    char num[24];
+    int len = snprintf(num, sizeof(num), "%" PRId64, value);
+    writer_member(writer, key);
+    writer_put(writer, num, len);
+}
+
+void pin_json_writer_number(pin_json_writer_t* writer, const char* key, double value) {
+    if (isnan(value) || isinf(value)) {
+        pin_json_writer_null(writer, key);
+        return;
+    }
+
+    // Same approach as cJSON: 15 digits unless that does not read back exactly
+    char num[32];
+    int len = snprintf(num, sizeof(num), "%1.15g", value);
+    if (strtod(num, NULL) != value) {
+        len = snprintf(num, sizeof(num), "%1.17g", value);
+    }
+    writer_member(writer, key);
+    writer_put(writer, num, len);
+}
+
+void pin_json_writer_bool(pin_json_writer_t* writer, const char* key, bool value) {
+    writer_member(writer, key);
+    if (value) {
+        writer_put(writer, "true", 4);
+    } else {
+        writer_put(writer, "false", 5);
+    }
+}
+
+void pin_json_writer_null(pin_json_writer_t* writer, const char* key) {
+    writer_member(writer, key);
+    writer_put(writer, "null", 4);
+}
+
+esp_err_t pin_json_writer_finish(pin_json_writer_t* writer) {
+    if (writer->err == ESP_OK && writer->depth != 0) {
+        writer->err = ESP_ERR_INVALID_STATE;
+    }
+    writer_flush(writer);
+    return writer->err;
+}
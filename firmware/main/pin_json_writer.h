@@ -0,0 +1,137 @@
+/**
+ * @file pin_json_writer.h
+ * @brief Pin Streaming JSON Writer
+ *
+ * The output side of pin_json_stream: values are serialized straight into
+ * a small scratch buffer inside the writer, which is handed to a flush
+ * callback (e.g. httpd_resp_send_chunk) whenever it fills. No document
+ * tree or output string is ever built, so a response of any length costs
+ * sizeof(pin_json_writer_t) of stack and no heap.
+ *
+ * Errors are sticky: after the first failed flush or misuse every call is
+ * a no-op and pin_json_writer_finish() reports the error.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIN_JSON_WRITER_BUFFER_SIZE 256
+#define PIN_JSON_WRITER_MAX_DEPTH 16        // Nested objects and arrays
+
+/**
+ * @brief Receives serialized output
+ * @param data Output bytes
+ * @param len Number of bytes
+ * @param ctx Context given to pin_json_writer_init()
+ * @return ESP_OK to continue, anything else aborts the document
+ */
+typedef esp_err_t (*pin_json_writer_flush_t)(const char* data, size_t len, void* ctx);
+
+/**
+ * @brief Writer state; lives on the caller's stack
+ */
+typedef struct {
+    pin_json_writer_flush_t flush;
+    void* ctx;
+    bool pretty;                // Newlines and tab indentation like cJSON_Print
+    uint8_t depth;
+    uint32_t has_members;       // Bit per depth: the open container has a value
+    esp_err_t err;
+    size_t total;               // Bytes produced so far
+    size_t len;
+    char buf[PIN_JSON_WRITER_BUFFER_SIZE];
+} pin_json_writer_t;
+
+/**
+ * @brief Start a new document
+ * @param writer Writer state
+ * @param flush Output callback
+ * @param ctx Passed to flush
+ * @param pretty true for formatted output, false for compact
+ */
+void pin_json_writer_init(pin_json_writer_t* writer, pin_json_writer_flush_t flush, void* ctx, bool pretty);
+
+/**
+ * @brief Open an object
+ * @param writer Writer state
+ * @param key Member name inside an object, NULL inside an array or at the top level
+ */
+void pin_json_writer_object_begin(pin_json_writer_t* writer, const char* key);
+
+/**
+ * @brief Close the innermost object
+ * @param writer Writer state
+ */
+void pin_json_writer_object_end(pin_json_writer_t* writer);
+
+/**
+ * @brief Open an array
+ * @param writer Writer state
+ * @param key Member name inside an object, NULL inside an array or at the top level
+ */
+void pin_json_writer_array_begin(pin_json_writer_t* writer, const char* key);
+
+/**
+ * @brief Close the innermost array
+ * @param writer Writer state
+ */
+void pin_json_writer_array_end(pin_json_writer_t* writer);
+
+/**
+ * @brief Write a string value, escaped as needed
+ * @param writer Writer state
+ * @param key Member name, or NULL
+ * @param value String, NULL writes null
+ */
+void pin_json_writer_string(pin_json_writer_t* writer, const char* key, const char* value);
+
+/**
+ * @brief Write an integer value
+ * @param writer Writer state
+ * @param key Member name, or NULL
+ * @param value Value
+ */
+void pin_json_writer_int(pin_json_writer_t* writer, const char* key, int64_t value);
+
+/**
+ * @brief Write a number with the shortest text that reads back the same
+ * @param writer Writer state
+ * @param key Member name, or NULL
+ * @param value Value; NaN and infinities are written as null
+ */
+void pin_json_writer_number(pin_json_writer_t* writer, const char* key, double value);
+
+/**
+ * @brief Write a boolean value
+ * @param writer Writer state
+ * @param key Member name, or NULL
+ * @param value Value
+ */
+void pin_json_writer_bool(pin_json_writer_t* writer, const char* key, bool value);
+
+/**
+ * @brief Write null
+ * @param writer Writer state
+ * @param key Member name, or NULL
+ */
+void pin_json_writer_null(pin_json_writer_t* writer, const char* key);
+
+/**
+ * @brief Flush what is left of the document
+ * @param writer Writer state
+ * @return ESP_OK on success, the first flush error, or ESP_ERR_INVALID_STATE
+ *         if containers were left open or nested too deep
+ */
+esp_err_t pin_json_writer_finish(pin_json_writer_t* writer);
+
+#ifdef __cplusplus
+}
+#endif
@@ -15,12 +15,20 @@
 #include "esp_log.h"
 #include "esp_netif.h"
 #include "esp_sleep.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
 #include "driver/gpio.h"
 
 #include "pin_display.h"
 #include "pin_wifi.h"
 #include "pin_plugin.h"
+#include "pin_http_pool.h"
+#include "pin_sleep.h"
+#include "pin_init.h"
+#include "pin_power.h"
+#include "pin_netwin.h"
+#include "pin_time.h"
+#include "pin_jobs.h"
 #include "pin_ota.h"
 #include "pin_config.h"
 #include "pin_webserver.h"
@@ -40,6 +48,36 @@ static fpc_a005_handle_t g_display_handle = NULL;
 #define PIN_PLUGINS_READY_BIT   BIT3
 #define PIN_WEB_SERVER_READY_BIT BIT4
 
+// How this boot was started, decides how much of the UI and services come up
+typedef enum {
+    PIN_BOOT_COLD,      // Power on or reset: splash screens and every service
+    PIN_BOOT_BUTTON,    // GPIO wake: someone is looking, same as a cold boot
+    PIN_BOOT_TIMER,     // Planned wake: run the due plugins and sleep again
+} pin_boot_mode_t;
+
+// After a timer wake, start the webserver and OTA only if still awake after this long
+#define PIN_BOOT_SERVICES_DEFER_MS 30000
+
+// Supervisor events, delivered to the main task as notification bits
+#define PIN_SUPERVISOR_WIFI_UP      BIT0
+#define PIN_SUPERVISOR_WIFI_DOWN    BIT1
+#define PIN_SUPERVISOR_BATTERY_LOW  BIT2
+#define PIN_SUPERVISOR_BATTERY_OK   BIT3
+#define PIN_SUPERVISOR_CHECK_SLEEP  BIT4    // Sleep plan changed or the sleep timer fired
+
+#define PIN_BATTERY_SAMPLE_INTERVAL_MS (5 * 60 * 1000)
+#define PIN_BATTERY_LOW_V 3.2f
+#define PIN_BATTERY_RECOVER_V 3.3f          // Hysteresis, so readings near the threshold do not flap
+#define PIN_BATTERY_WARNING_HEIGHT 30       // Strip along the bottom of the panel
+
+static pin_boot_mode_t g_boot_mode = PIN_BOOT_COLD;
+static bool g_services_started = false;
+
+static TaskHandle_t g_supervisor_task = NULL;
+static esp_timer_handle_t g_sleep_timer = NULL;
+static esp_timer_handle_t g_battery_timer = NULL;
+static bool g_battery_low = false;
+
 /**
  * 系统初始化
  */
@@ -64,11 +102,9 @@ static esp_err_t pin_system_init(void) {
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
     
-    // 创建全局事件组
-    g_pin_event_group = xEventGroupCreate();
-    if (g_pin_event_group == NULL) {
-        ESP_LOGE(TAG, "Failed to create event group");
-        return ESP_FAIL;
+    // 电源管理: 动态调频与自动浅睡眠, 失败时以全速运行
+    if (pin_power_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Power management unavailable, running at full clock");
     }
     
     ESP_LOGI(TAG, "System initialization completed");
@@ -97,19 +133,6 @@ static void pin_show_startup_screen(void) {
     pin_display_refresh(PIN_REFRESH_FULL);
 }
 
-/**
- * 更新启动状态
- */
-static void pin_update_startup_status(const char* status) {
-    // 清除之前的状态文本
-    pin_display_draw_rect(120, 220, 360, 30, PIN_COLOR_WHITE, true);
-    
-    // 显示新状态
-    pin_display_draw_text(180, 220, status, PIN_FONT_MEDIUM, PIN_COLOR_BLUE);
-    
-    pin_display_refresh(PIN_REFRESH_PARTIAL);
-}
-
 /**
  * 显示系统就绪界面
  */
@@ -156,26 +179,19 @@ static void pin_show_ready_screen(void) {
  * 检查唤醒原因并处理
  */
 static void pin_handle_wakeup_reason(void) {
-    esp_sleep_source_t wakeup_reasons = esp_sleep_get_wakeup_causes();
-    esp_sleep_wakeup_cause_t wakeup_reason = ESP_SLEEP_WAKEUP_UNDEFINED;
+    // Restores the deadlines saved before deep sleep
+    pin_sleep_init();
     
-    // Convert new API result to old API format for compatibility
-    if (wakeup_reasons & ESP_SLEEP_WAKEUP_TIMER) {
-        wakeup_reason = ESP_SLEEP_WAKEUP_TIMER;
-    } else if (wakeup_reasons & ESP_SLEEP_WAKEUP_EXT0) {
-        wakeup_reason = ESP_SLEEP_WAKEUP_EXT0;
-    } else if (wakeup_reasons & ESP_SLEEP_WAKEUP_EXT1) {
-        wakeup_reason = ESP_SLEEP_WAKEUP_EXT1;
-    } else if (wakeup_reasons & ESP_SLEEP_WAKEUP_GPIO) {
-        wakeup_reason = ESP_SLEEP_WAKEUP_GPIO;
-    }
+    esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
     
     switch (wakeup_reason) {
         case ESP_SLEEP_WAKEUP_TIMER:
             ESP_LOGI(TAG, "Wakeup from timer");
+            g_boot_mode = PIN_BOOT_TIMER;
             break;
         case ESP_SLEEP_WAKEUP_GPIO:
             ESP_LOGI(TAG, "Wakeup from GPIO");
+            g_boot_mode = PIN_BOOT_BUTTON;
             break;
         case ESP_SLEEP_WAKEUP_UNDEFINED:
         default:
@@ -185,7 +201,400 @@ static void pin_handle_wakeup_reason(void) {
 }
 
 /**
- * 主任务
+ * 初始化OTA系统
+ */
+static void pin_start_ota(void) {
+    esp_err_t ret = pin_ota_init();
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "OTA system initialized");
+        // 启用自动更新检查 (每24小时检查一次)
+        pin_ota_set_auto_check_interval(24);
+    } else {
+        ESP_LOGE(TAG, "OTA system initialization failed: %s", esp_err_to_name(ret));
+    }
+}
+
+/**
+ * 启动Web服务器
+ */
+static esp_err_t pin_start_services(void) {
+    esp_err_t ret;
+    
+    g_services_started = true;
+    
+    // 后台任务队列，耗时的API操作(刷新、OTA检查)在这里执行
+    ret = pin_jobs_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Job worker start failed: %s", esp_err_to_name(ret));
+    }
+    
+    // 初始化Web服务器
+    ret = pin_webserver_init(g_canvas_handle);
+    if (ret == ESP_OK) {
+        ret = pin_webserver_start();
+        if (ret == ESP_OK) {
+            xEventGroupSetBits(g_pin_event_group, PIN_WEB_SERVER_READY_BIT);
+            ESP_LOGI(TAG, "Web server started");
+        } else {
+            ESP_LOGE(TAG, "Web server start failed: %s", esp_err_to_name(ret));
+        }
+    } else {
+        ESP_LOGE(TAG, "Web server initialization failed: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+/**
+ * 启动阶段 (run by pin_init once their dependencies are up)
+ */
+static esp_err_t pin_stage_display(void) {
+    esp_err_t ret = pin_display_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Display initialization failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGI(TAG, "Display system initialized");
+    
+    // Get display handle for canvas system
+    g_display_handle = pin_display_get_handle();
+    
+    // 显示启动界面
+    if (g_boot_mode != PIN_BOOT_TIMER) {
+        pin_show_startup_screen();
+    }
+    return ESP_OK;
+}
+
+static esp_err_t pin_stage_config(void) {
+    pin_config_init();
+    ESP_LOGI(TAG, "Configuration system initialized");
+    return ESP_OK;
+}
+
+static esp_err_t pin_stage_canvas(void) {
+    esp_err_t ret = pin_canvas_init(g_display_handle, &g_canvas_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Canvas initialization failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGI(TAG, "Canvas system initialized");
+    return ESP_OK;
+}
+
+static esp_err_t pin_stage_wifi(void) {
+    esp_err_t ret = pin_wifi_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "WiFi initialization failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGI(TAG, "WiFi system initialized");
+    
+    ret = pin_netwin_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Network windows initialization failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    // 补偿深度睡眠期间的时钟漂移，并安排下一次SNTP同步
+    ret = pin_time_init();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Time service initialization failed: %s", esp_err_to_name(ret));
+    }
+    
+    // A timer wake brings the radio up only when a plugin or job needs it
+    if (g_boot_mode == PIN_BOOT_TIMER) {
+        return ESP_OK;
+    }
+    
+    // 启动WiFi配置任务（它会处理连接或配网）
+    return pin_wifi_start_config_task();
+}
+
+static esp_err_t pin_stage_plugins(void) {
+    esp_err_t ret = pin_plugin_manager_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Plugin system initialization failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGI(TAG, "Plugin system initialized");
+    
+    // 注册内置插件
+    extern pin_plugin_t clock_plugin;
+    extern pin_plugin_t weather_plugin;
+    
+    pin_plugin_register(&clock_plugin);
+    pin_plugin_register(&weather_plugin);
+    
+    // 启用默认插件
+    pin_plugin_enable("clock", true);
+    pin_plugin_enable("weather", true);
+    return ESP_OK;
+}
+
+static esp_err_t pin_stage_services(void) {
+    // The OTA check is a network job, registering it keeps its period across wakes
+    pin_start_ota();
+    
+    // A timer wake only needs the plugins; the main loop starts these if it stays awake
+    if (g_boot_mode == PIN_BOOT_TIMER) {
+        ESP_LOGI(TAG, "Timer wake, webserver deferred");
+        return ESP_OK;
+    }
+    return pin_start_services();
+}
+
+// Boot stages; a stage starts as soon as the stages it depends on are done
+enum {
+    PIN_STAGE_SYSTEM,
+    PIN_STAGE_DISPLAY,
+    PIN_STAGE_CONFIG,
+    PIN_STAGE_CANVAS,
+    PIN_STAGE_WIFI,
+    PIN_STAGE_PLUGINS,
+    PIN_STAGE_SERVICES,
+    PIN_STAGE_COUNT
+};
+
+static const pin_init_stage_t g_boot_stages[PIN_STAGE_COUNT] = {
+    [PIN_STAGE_SYSTEM] = {
+        .name = "system",
+        .fn = pin_system_init,
+    },
+    [PIN_STAGE_DISPLAY] = {
+        .name = "display",
+        .fn = pin_stage_display,
+        .depends_on = PIN_INIT_DEP(PIN_STAGE_SYSTEM),
+        .ready_bits = PIN_DISPLAY_READY_BIT,
+    },
+    [PIN_STAGE_CONFIG] = {
+        .name = "config",
+        .fn = pin_stage_config,
+        .depends_on = PIN_INIT_DEP(PIN_STAGE_SYSTEM),
+    },
+    [PIN_STAGE_CANVAS] = {
+        .name = "canvas",
+        .fn = pin_stage_canvas,
+        .depends_on = PIN_INIT_DEP(PIN_STAGE_DISPLAY) | PIN_INIT_DEP(PIN_STAGE_CONFIG),
+        .ready_bits = PIN_CANVAS_READY_BIT,
+    },
+    [PIN_STAGE_WIFI] = {
+        .name = "wifi",
+        .fn = pin_stage_wifi,
+        .depends_on = PIN_INIT_DEP(PIN_STAGE_SYSTEM),
+    },
+    [PIN_STAGE_PLUGINS] = {
+        .name = "plugins",
+        .fn = pin_stage_plugins,
+        .depends_on = PIN_INIT_DEP(PIN_STAGE_DISPLAY) | PIN_INIT_DEP(PIN_STAGE_CONFIG) |
+                      PIN_INIT_DEP(PIN_STAGE_WIFI),
+        .ready_bits = PIN_PLUGINS_READY_BIT,
+        .stack_size = 8192,     // Plugin start() may already make a TLS request
+    },
+    [PIN_STAGE_SERVICES] = {
+        .name = "services",
+        .fn = pin_stage_services,
+        .depends_on = PIN_INIT_DEP(PIN_STAGE_WIFI),
+        .runs_after = PIN_INIT_DEP(PIN_STAGE_CANVAS),   // Serves the canvas if it came up
+        .stack_size = 6144,
+    },
+};
+
+// 启动界面上各阶段的状态文字 (the display is not up yet during the first two)
+static const char* const g_boot_stage_status[PIN_STAGE_COUNT] = {
+    [PIN_STAGE_CONFIG] = "Loading Configuration...",
+    [PIN_STAGE_CANVAS] = "Initializing Canvas...",
+    [PIN_STAGE_WIFI] = "Initializing WiFi...",
+    [PIN_STAGE_PLUGINS] = "Loading Plugins...",
+    [PIN_STAGE_SERVICES] = "Starting Web Server...",
+};
+
+/**
+ * 更新启动状态
+ *
+ * pin_init calls this on app_main's task only, so status lines never
+ * interleave and the stages never wait for a partial refresh.
+ */
+static void pin_update_startup_status(void) {
+    static const char* shown = NULL;
+    
+    // Nobody is watching a timer wake; every status line would cost a refresh
+    if (g_boot_mode == PIN_BOOT_TIMER || pin_init_get_state(PIN_STAGE_DISPLAY) != PIN_INIT_DONE) {
+        return;
+    }
+    
+    // 显示最后开始且仍在运行的阶段
+    const char* status = NULL;
+    for (int i = PIN_STAGE_COUNT - 1; i >= 0 && !status; i--) {
+        if (pin_init_get_state(i) == PIN_INIT_RUNNING) {
+            status = g_boot_stage_status[i];
+        }
+    }
+    if (!status || status == shown) {
+        return;
+    }
+    shown = status;
+    
+    // 清除之前的状态文本
+    pin_display_draw_rect(120, 220, 360, 30, PIN_COLOR_WHITE, true);
+    
+    // 显示新状态
+    pin_display_draw_text(180, 220, status, PIN_FONT_MEDIUM, PIN_COLOR_BLUE);
+    
+    pin_display_refresh(PIN_REFRESH_PARTIAL);
+}
+
+/**
+ * 显示或清除低电量警告
+ */
+static void pin_show_battery_warning(bool low) {
+    static bool shown = false;
+    
+    // Nobody is watching a timer wake; the next interactive boot samples the battery again
+    if (g_boot_mode == PIN_BOOT_TIMER || !(xEventGroupGetBits(g_pin_event_group) & PIN_DISPLAY_READY_BIT)) {
+        return;
+    }
+    if (!low && !shown) {
+        return;
+    }
+    
+    uint16_t y = FPC_A005_HEIGHT - PIN_BATTERY_WARNING_HEIGHT;
+    pin_display_draw_rect(0, y, FPC_A005_WIDTH, PIN_BATTERY_WARNING_HEIGHT, PIN_COLOR_WHITE, true);
+    
+    if (low) {
+        uint8_t battery_percentage = pin_battery_get_percentage(pin_battery_get_voltage());
+        char warning[48];
+        snprintf(warning, sizeof(warning), "Low Battery: %d%% - Please Charge", battery_percentage);
+        pin_display_draw_battery_icon(20, y + 9, battery_percentage, PIN_COLOR_RED);
+        pin_display_draw_text(60, y + 5, warning, PIN_FONT_MEDIUM, PIN_COLOR_RED);
+    }
+    shown = low;
+    
+    pin_display_refresh(PIN_REFRESH_PARTIAL);
+}
+
+/**
+ * 监控事件源
+ */
+static void pin_supervisor_notify(uint32_t events) {
+    if (g_supervisor_task) {
+        xTaskNotify(g_supervisor_task, events, eSetBits);
+    }
+}
+
+static void pin_supervisor_wifi_event(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        pin_supervisor_notify(PIN_SUPERVISOR_WIFI_DOWN);
+    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+        pin_supervisor_notify(PIN_SUPERVISOR_WIFI_UP);
+    }
+}
+
+static void pin_supervisor_battery_sample(void* arg) {
+    float voltage = pin_battery_get_voltage();
+    if (!g_battery_low && voltage < PIN_BATTERY_LOW_V) {
+        g_battery_low = true;
+        pin_power_set_battery_low(true);
+        pin_supervisor_notify(PIN_SUPERVISOR_BATTERY_LOW);
+    } else if (g_battery_low && voltage > PIN_BATTERY_RECOVER_V) {
+        g_battery_low = false;
+        pin_power_set_battery_low(false);
+        pin_supervisor_notify(PIN_SUPERVISOR_BATTERY_OK);
+    }
+}
+
+static void pin_supervisor_sleep_timer(void* arg) {
+    pin_supervisor_notify(PIN_SUPERVISOR_CHECK_SLEEP);
+}
+
+static void pin_supervisor_plan_changed(void) {
+    pin_supervisor_notify(PIN_SUPERVISOR_CHECK_SLEEP);
+}
+
+/**
+ * Sleep if the plan allows it, otherwise arm the sleep timer for the next
+ * moment that can change the answer. Plugin updates report their own plan
+ * changes, so only the interactive window and deferred services need the timer.
+ */
+static void pin_supervisor_check_sleep(void) {
+    int64_t recheck_us = INT64_MAX;
+    
+    // Still up well after a timer wake, so bring up what was deferred
+    if (!g_services_started) {
+        int64_t services_in_us = (int64_t)PIN_BOOT_SERVICES_DEFER_MS * 1000 - esp_timer_get_time();
+        if (!pin_config_get_sleep_enabled() || services_in_us <= 0) {
+            pin_start_services();
+        } else {
+            recheck_us = services_in_us;
+        }
+    }
+    
+    // 检查是否需要进入深度睡眠
+    if (pin_config_get_sleep_enabled()) {
+        // A network hold (e.g. an OTA download) keeps the device up; its release rechecks
+        if (pin_sleep_should_enter() && !pin_netwin_is_held()) {
+            ESP_LOGI(TAG, "Entering deep sleep mode");
+            pin_plugin_flush_config();
+            pin_sleep_enter();
+        }
+        
+        int64_t hold_us = pin_sleep_awake_hold_us();
+        if (hold_us > 0 && hold_us < recheck_us) {
+            recheck_us = hold_us;
+        }
+    }
+    
+    esp_timer_stop(g_sleep_timer);
+    if (recheck_us != INT64_MAX) {
+        esp_timer_start_once(g_sleep_timer, (uint64_t)recheck_us);
+    }
+}
+
+static esp_err_t pin_supervisor_start(void) {
+    g_supervisor_task = xTaskGetCurrentTaskHandle();
+    
+    esp_timer_create_args_t sleep_timer_args = {
+        .callback = pin_supervisor_sleep_timer,
+        .name = "sleep_check",
+    };
+    esp_err_t ret = esp_timer_create(&sleep_timer_args, &g_sleep_timer);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    esp_timer_create_args_t battery_timer_args = {
+        .callback = pin_supervisor_battery_sample,
+        .name = "battery",
+    };
+    ret = esp_timer_create(&battery_timer_args, &g_battery_timer);
+    if (ret == ESP_OK) {
+        ret = esp_timer_start_periodic(g_battery_timer, PIN_BATTERY_SAMPLE_INTERVAL_MS * 1000ULL);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Battery sampler unavailable: %s", esp_err_to_name(ret));
+    }
+    
+    ret = esp_event_handler_instance_register(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED,
+                                              pin_supervisor_wifi_event, NULL, NULL);
+    if (ret == ESP_OK) {
+        ret = esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
+                                                  pin_supervisor_wifi_event, NULL, NULL);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "WiFi events unavailable: %s", esp_err_to_name(ret));
+    }
+    
+    pin_sleep_set_plan_hook(pin_supervisor_plan_changed);
+    
+    // Pick up the state as it is now, later changes arrive as events
+    pin_supervisor_battery_sample(NULL);
+    if (pin_wifi_is_connected()) {
+        xEventGroupSetBits(g_pin_event_group, PIN_WIFI_CONNECTED_BIT);
+    }
+    return ESP_OK;
+}
+
+/**
+ * 主任务 (event-driven supervisor)
  */
 static void pin_main_task(void *pvParameters) {
     EventBits_t event_bits;
@@ -201,35 +610,47 @@ static void pin_main_task(void *pvParameters) {
     
     ESP_LOGI(TAG, "Subsystems initialization status: 0x%08x", (unsigned int)event_bits);
     
-    // 显示系统就绪界面
-    if (event_bits & PIN_DISPLAY_READY_BIT) {
+    // 显示系统就绪界面 (a planned wake keeps the widgets already on the panel)
+    if ((event_bits & PIN_DISPLAY_READY_BIT) && g_boot_mode != PIN_BOOT_TIMER) {
         pin_show_ready_screen();
         vTaskDelay(pdMS_TO_TICKS(3000));  // 显示3秒
     }
     
-    // 主循环
+    if (pin_supervisor_start() != ESP_OK) {
+        ESP_LOGE(TAG, "Supervisor timers unavailable, sleep is disabled");
+    }
+    uint32_t events = PIN_SUPERVISOR_CHECK_SLEEP;
+    
+    // 主循环: only runs when something happens
     while (1) {
-        // 检查系统状态
-        if (!pin_wifi_is_connected()) {
-            ESP_LOGW(TAG, "WiFi connection lost, checking configuration...");
+        if (events & PIN_SUPERVISOR_WIFI_DOWN) {
+            ESP_LOGW(TAG, "WiFi connection lost");
+            xEventGroupClearBits(g_pin_event_group, PIN_WIFI_CONNECTED_BIT);
+            // Pooled plugin connections are dead now; drop them instead of retrying on them
+            pin_http_pool_close_all();
             // WiFi断开处理将在wifi模块中自动进行
         }
+        if (events & PIN_SUPERVISOR_WIFI_UP) {
+            ESP_LOGI(TAG, "WiFi connected");
+            xEventGroupSetBits(g_pin_event_group, PIN_WIFI_CONNECTED_BIT);
+        }
         
-        // 检查电池电压
-        float voltage = pin_battery_get_voltage();
-        if (voltage < 3.2f) {  // 低电量警告
-            ESP_LOGW(TAG, "Low battery warning: %.2fV", voltage);
-            // TODO: 显示低电量警告
+        // 电池电压跨越阈值
+        if (events & PIN_SUPERVISOR_BATTERY_LOW) {
+            ESP_LOGW(TAG, "Low battery warning: below %.2fV", PIN_BATTERY_LOW_V);
+            pin_show_battery_warning(true);
+        }
+        if (events & PIN_SUPERVISOR_BATTERY_OK) {
+            ESP_LOGI(TAG, "Battery recovered above %.2fV", PIN_BATTERY_RECOVER_V);
+            pin_show_battery_warning(false);
         }
         
-        // 检查是否需要进入深度睡眠
-        if (pin_config_get_sleep_enabled() && pin_should_enter_sleep()) {
-            ESP_LOGI(TAG, "Entering deep sleep mode");
-            pin_enter_deep_sleep();
+        if (g_sleep_timer) {
+            pin_supervisor_check_sleep();
         }
         
-        // 主循环每10秒运行一次
-        vTaskDelay(pdMS_TO_TICKS(10000));
+        events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, portMAX_DELAY);
     }
 }
 
@@ -237,113 +658,28 @@ static void pin_main_task(void *pvParameters) {
  * 应用程序入口点
  */
 void app_main(void) {
-    esp_err_t ret;
-    
     // 处理唤醒原因
     pin_handle_wakeup_reason();
     
-    // 系统初始化
-    ret = pin_system_init();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "System initialization failed: %s", esp_err_to_name(ret));
+    // 创建全局事件组
+    g_pin_event_group = xEventGroupCreate();
+    if (g_pin_event_group == NULL) {
+        ESP_LOGE(TAG, "Failed to create event group");
         esp_restart();
         return;
     }
     
-    // 初始化显示系统
-    pin_update_startup_status("Initializing Display...");
-    ret = pin_display_init();
-    if (ret == ESP_OK) {
-        xEventGroupSetBits(g_pin_event_group, PIN_DISPLAY_READY_BIT);
-        ESP_LOGI(TAG, "Display system initialized");
-        
-        // Get display handle for canvas system
-        g_display_handle = pin_display_get_handle();
-        
-        // 显示启动界面
-        pin_show_startup_screen();
-    } else {
-        ESP_LOGE(TAG, "Display initialization failed: %s", esp_err_to_name(ret));
-    }
-    
-    // 初始化配置系统
-    pin_update_startup_status("Loading Configuration...");
-    pin_config_init();
-    ESP_LOGI(TAG, "Configuration system initialized");
-    
-    // 初始化Canvas系统
-    if (g_display_handle) {
-        pin_update_startup_status("Initializing Canvas...");
-        ret = pin_canvas_init(g_display_handle, &g_canvas_handle);
-        if (ret == ESP_OK) {
-            xEventGroupSetBits(g_pin_event_group, PIN_CANVAS_READY_BIT);
-            ESP_LOGI(TAG, "Canvas system initialized");
-        } else {
-            ESP_LOGE(TAG, "Canvas initialization failed: %s", esp_err_to_name(ret));
-        }
-    }
-    
-    // 初始化WiFi系统
-    pin_update_startup_status("Initializing WiFi...");
-    ret = pin_wifi_init();
-    if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "WiFi system initialized");
-        
-        // 启动WiFi配置任务（它会处理连接或配网）
-        pin_wifi_start_config_task();
-    } else {
-        ESP_LOGE(TAG, "WiFi initialization failed: %s", esp_err_to_name(ret));
-    }
-    
-    // 初始化插件系统
-    pin_update_startup_status("Loading Plugins...");
-    ret = pin_plugin_manager_init();
-    if (ret == ESP_OK) {
-        xEventGroupSetBits(g_pin_event_group, PIN_PLUGINS_READY_BIT);
-        ESP_LOGI(TAG, "Plugin system initialized");
-        
-        // 注册内置插件
-        extern pin_plugin_t clock_plugin;
-        extern pin_plugin_t weather_plugin;
-        
-        pin_plugin_register(&clock_plugin);
-        pin_plugin_register(&weather_plugin);
-        
-        // 启用默认插件
-        pin_plugin_enable("clock", true);
-        pin_plugin_enable("weather", true);
-    } else {
-        ESP_LOGE(TAG, "Plugin system initialization failed: %s", esp_err_to_name(ret));
-    }
-    
-    // 初始化OTA系统
-    pin_update_startup_status("Initializing OTA System...");
-    ret = pin_ota_init();
-    if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "OTA system initialized");
-        // 启用自动更新检查 (每24小时检查一次)
-        pin_ota_set_auto_check_interval(24);
-    } else {
-        ESP_LOGE(TAG, "OTA system initialization failed: %s", esp_err_to_name(ret));
-    }
-    
-    // 初始化Web服务器
-    pin_update_startup_status("Starting Web Server...");
-    ret = pin_webserver_init(g_canvas_handle);
-    if (ret == ESP_OK) {
-        ret = pin_webserver_start();
-        if (ret == ESP_OK) {
-            xEventGroupSetBits(g_pin_event_group, PIN_WEB_SERVER_READY_BIT);
-            ESP_LOGI(TAG, "Web server started");
-        } else {
-            ESP_LOGE(TAG, "Web server start failed: %s", esp_err_to_name(ret));
-        }
-    } else {
-        ESP_LOGE(TAG, "Web server initialization failed: %s", esp_err_to_name(ret));
+    // Independent stages (e.g. WiFi and the display) come up in parallel
+    esp_err_t ret = pin_init_run(g_boot_stages, PIN_STAGE_COUNT, g_pin_event_group,
+                                 pin_update_startup_status);
+    if (pin_init_get_state(PIN_STAGE_SYSTEM) != PIN_INIT_DONE) {
+        ESP_LOGE(TAG, "System initialization failed: %s", esp_err_to_name(ret));
+        esp_restart();
+        return;
     }
     
     // 创建主任务
     xTaskCreate(pin_main_task, "pin_main", 4096, NULL, 5, NULL);
     
     ESP_LOGI(TAG, "Pin Device initialization completed");
-}
\ No newline at end of file
+}
@@ -0,0 +1,427 @@
+/**
+ * @file pin_netwin.c
+ * @brief Pin Network Windows Implementation
+ */
+
+#include <string.h>
+#include <sys/time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "pin_config.h"
+#include "pin_netwin.h"
+#include "pin_retain.h"
+#include "pin_sleep.h"
+#include "pin_wifi.h"
+
+static const char* TAG = "PIN_NETWIN";
+
+#define PIN_NETWIN_BACKOFF_NAME "netwin.backoff"
+#define PIN_NETWIN_BACKOFF_VERSION 1
+
+typedef struct {
+    char name[PIN_NETWIN_NAME_MAX_LEN];
+    pin_netwin_job_t job;
+    void* arg;
+    int64_t deadline_us;        // esp_timer clock, 0 = not scheduled
+    uint32_t tolerance_ms;
+    bool running;
+} pin_netwin_job_entry_t;
+
+static struct {
+    SemaphoreHandle_t mutex;    // Radio transitions and the job table
+    pin_netwin_job_entry_t jobs[PIN_NETWIN_MAX_JOBS];
+    uint8_t job_count;
+    int64_t idle_since_us;      // When the last hold was released
+    int64_t retry_after_us;     // No window of our own before this after a failed connect
+    uint8_t failed_windows;     // In a row, kept over deep sleep; doubles the retry delay
+    TaskHandle_t window_task;
+    esp_timer_handle_t radio_timer;
+    esp_timer_handle_t job_timer;
+    pin_netwin_stats_t stats;
+} g_netwin = {0};
+
+static void pin_netwin_window_task(void* pvParameters);
+
+static pin_netwin_job_entry_t* pin_netwin_find(const char* name) {
+    for (uint8_t i = 0; i < g_netwin.job_count; i++) {
+        if (strncmp(g_netwin.jobs[i].name, name, PIN_NETWIN_NAME_MAX_LEN - 1) == 0) {
+            return &g_netwin.jobs[i];
+        }
+    }
+    return NULL;
+}
+
+static bool pin_netwin_job_due(const pin_netwin_job_entry_t* entry, int64_t now_us) {
+    return entry->deadline_us != 0 && !entry->running && entry->deadline_us <= now_us;
+}
+
+// Wake when the most urgent job cannot wait for someone else's window any longer; mutex held
+static void pin_netwin_arm_job_timer(void) {
+    int64_t next_us = INT64_MAX;
+    for (uint8_t i = 0; i < g_netwin.job_count; i++) {
+        const pin_netwin_job_entry_t* entry = &g_netwin.jobs[i];
+        if (entry->deadline_us == 0 || entry->running) {
+            continue;
+        }
+        int64_t latest_us = entry->deadline_us + (int64_t)entry->tolerance_ms * 1000;
+        if (latest_us < next_us) {
+            next_us = latest_us;
+        }
+    }
+
+    esp_timer_stop(g_netwin.job_timer);
+    if (next_us == INT64_MAX) {
+        return;
+    }
+    if (next_us < g_netwin.retry_after_us) {
+        next_us = g_netwin.retry_after_us;
+    }
+    int64_t delay_us = next_us - esp_timer_get_time();
+    esp_timer_start_once(g_netwin.job_timer, delay_us > 0 ? (uint64_t)delay_us : 0);
+}
+
+// Start a window task if any job is due and none is running; mutex held
+static void pin_netwin_spawn_window(void) {
+    if (g_netwin.window_task) {
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    for (uint8_t i = 0; i < g_netwin.job_count; i++) {
+        if (pin_netwin_job_due(&g_netwin.jobs[i], now_us)) {
+            if (xTaskCreate(pin_netwin_window_task, "netwin", PIN_NETWIN_WINDOW_STACK_SIZE, NULL,
+                            PIN_NETWIN_TASK_PRIORITY, &g_netwin.window_task) != pdPASS) {
+                g_netwin.window_task = NULL;
+                ESP_LOGE(TAG, "No task for the network window");
+            }
+            return;
+        }
+    }
+}
+
+static void pin_netwin_job_timer_cb(void* arg) {
+    xSemaphoreTake(g_netwin.mutex, portMAX_DELAY);
+    pin_netwin_spawn_window();
+    xSemaphoreGive(g_netwin.mutex);
+}
+
+/**
+ * Stop the radio once nobody holds it, the linger time is over and no one
+ * is using the web UI; otherwise check again when that may have changed.
+ */
+static void pin_netwin_check_radio(void* arg) {
+    xSemaphoreTake(g_netwin.mutex, portMAX_DELAY);
+    if (g_netwin.stats.holders == 0 && pin_wifi_radio_is_on()) {
+        int64_t wait_us = g_netwin.idle_since_us + (int64_t)PIN_NETWIN_LINGER_MS * 1000 - esp_timer_get_time();
+        int64_t hold_us = pin_config_get_sleep_enabled() ? pin_sleep_awake_hold_us() : INT64_MAX;
+        if (hold_us > wait_us) {
+            wait_us = hold_us;
+        }
+
+        if (wait_us <= 0) {
+            ESP_LOGI(TAG, "Radio off");
+            pin_wifi_radio_off();
+        } else if (wait_us != INT64_MAX) {
+            esp_timer_stop(g_netwin.radio_timer);
+            esp_timer_start_once(g_netwin.radio_timer, (uint64_t)wait_us);
+        }
+    }
+    xSemaphoreGive(g_netwin.mutex);
+}
+
+static void pin_netwin_job_task(void* pvParameters) {
+    pin_netwin_job_entry_t* entry = (pin_netwin_job_entry_t*)pvParameters;
+
+    entry->job(entry->arg);
+
+    xSemaphoreTake(g_netwin.mutex, portMAX_DELAY);
+    entry->running = false;
+    g_netwin.stats.jobs_run++;
+    TaskHandle_t notify = g_netwin.window_task;
+    xSemaphoreGive(g_netwin.mutex);
+
+    xTaskNotifyGive(notify);
+    vTaskDelete(NULL);
+}
+
+// Runs every due job on its own task with the radio held, then waits for all of them
+static void pin_netwin_window_task(void* pvParameters) {
+    if (pin_netwin_acquire(PIN_NETWIN_CONNECT_TIMEOUT_MS) == ESP_OK) {
+        uint8_t started = 0;
+
+        xSemaphoreTake(g_netwin.mutex, portMAX_DELAY);
+        int64_t now_us = esp_timer_get_time();
+        for (uint8_t i = 0; i < g_netwin.job_count; i++) {
+            pin_netwin_job_entry_t* entry = &g_netwin.jobs[i];
+            if (!pin_netwin_job_due(entry, now_us)) {
+                continue;
+            }
+            // One run per deadline; the job adds itself again if it repeats
+            entry->deadline_us = 0;
+            entry->running = true;
+            if (xTaskCreate(pin_netwin_job_task, entry->name, PIN_NETWIN_JOB_STACK_SIZE, entry,
+                            PIN_NETWIN_TASK_PRIORITY, NULL) == pdPASS) {
+                started++;
+            } else {
+                ESP_LOGE(TAG, "No task for job '%s'", entry->name);
+                entry->running = false;
+            }
+        }
+        xSemaphoreGive(g_netwin.mutex);
+
+        for (uint8_t i = 0; i < started; i++) {
+            ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+        }
+        pin_netwin_release();
+
+        if (g_netwin.failed_windows != 0) {
+            g_netwin.failed_windows = 0;
+            pin_retain_save(PIN_NETWIN_BACKOFF_NAME, PIN_NETWIN_BACKOFF_VERSION,
+                            &g_netwin.failed_windows, sizeof(g_netwin.failed_windows));
+        }
+    } else {
+        // Back off, and move the due jobs along so the sleep plan does not see them overdue
+        uint8_t shift = g_netwin.failed_windows < PIN_NETWIN_MAX_BACKOFF_SHIFT ? g_netwin.failed_windows
+                                                                               : PIN_NETWIN_MAX_BACKOFF_SHIFT;
+        int64_t now_us = esp_timer_get_time();
+        xSemaphoreTake(g_netwin.mutex, portMAX_DELAY);
+        g_netwin.retry_after_us = now_us + ((int64_t)PIN_NETWIN_RETRY_MS * 1000 << shift);
+        for (uint8_t i = 0; i < g_netwin.job_count; i++) {
+            pin_netwin_job_entry_t* entry = &g_netwin.jobs[i];
+            if (pin_netwin_job_due(entry, now_us)) {
+                entry->deadline_us = g_netwin.retry_after_us;
+            }
+        }
+        xSemaphoreGive(g_netwin.mutex);
+
+        if (g_netwin.failed_windows < UINT8_MAX) {
+            g_netwin.failed_windows++;
+        }
+        pin_retain_save(PIN_NETWIN_BACKOFF_NAME, PIN_NETWIN_BACKOFF_VERSION,
+                        &g_netwin.failed_windows, sizeof(g_netwin.failed_windows));
+        ESP_LOGW(TAG, "No connection, next window in %lu s",
+                 (unsigned long)((PIN_NETWIN_RETRY_MS << shift) / 1000));
+    }
+
+    xSemaphoreTake(g_netwin.mutex, portMAX_DELAY);
+    g_netwin.window_task = NULL;
+    pin_netwin_arm_job_timer();
+    xSemaphoreGive(g_netwin.mutex);
+
+    pin_sleep_plan_changed();
+    vTaskDelete(NULL);
+}
+
+static uint8_t pin_netwin_sleep_deadlines(pin_sleep_deadline_t* out, uint8_t max) {
+    uint8_t count = 0;
+
+    // Deadlines live on the esp_timer clock, which restarts after deep sleep
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    int64_t wall_now_us = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+    int64_t now_us = esp_timer_get_time();
+
+    xSemaphoreTake(g_netwin.mutex, portMAX_DELAY);
+    for (uint8_t i = 0; i < g_netwin.job_count && count < max; i++) {
+        const pin_netwin_job_entry_t* entry = &g_netwin.jobs[i];
+        if (entry->deadline_us == 0) {
+            continue;
+        }
+        // Jobs added again during a back-off still wait for it to end
+        int64_t due_us = entry->deadline_us > g_netwin.retry_after_us ? entry->deadline_us
+                                                                      : g_netwin.retry_after_us;
+        pin_sleep_deadline_t* deadline = &out[count++];
+        strncpy(deadline->name, entry->name, sizeof(deadline->name) - 1);
+        deadline->name[sizeof(deadline->name) - 1] = '\0';
+        deadline->due_us = wall_now_us + (due_us - now_us);
+        deadline->tolerance_ms = entry->tolerance_ms;
+    }
+    xSemaphoreGive(g_netwin.mutex);
+
+    return count;
+}
+
+esp_err_t pin_netwin_init(void) {
+    g_netwin.mutex = xSemaphoreCreateMutex();
+    if (!g_netwin.mutex) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    const esp_timer_create_args_t radio_timer_args = {
+        .callback = pin_netwin_check_radio,
+        .name = "netwin_radio",
+    };
+    esp_err_t ret = esp_timer_create(&radio_timer_args, &g_netwin.radio_timer);
+    if (ret == ESP_OK) {
+        const esp_timer_create_args_t job_timer_args = {
+            .callback = pin_netwin_job_timer_cb,
+            .name = "netwin_jobs",
+        };
+        ret = esp_timer_create(&job_timer_args, &g_netwin.job_timer);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create timers: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    if (pin_retain_restore(PIN_NETWIN_BACKOFF_NAME, PIN_NETWIN_BACKOFF_VERSION,
+                           &g_netwin.failed_windows, sizeof(g_netwin.failed_windows)) != ESP_OK) {
+        g_netwin.failed_windows = 0;
+    }
+
+    ret = pin_sleep_register_source(pin_netwin_sleep_deadlines);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Jobs will not wake the device: %s", esp_err_to_name(ret));
+    }
+
+    // A radio started at boot goes down like any other once it is not needed
+    g_netwin.idle_since_us = esp_timer_get_time();
+    esp_timer_start_once(g_netwin.radio_timer, (uint64_t)PIN_NETWIN_LINGER_MS * 1000);
+    return ESP_OK;
+}
+
+esp_err_t pin_netwin_acquire(uint32_t timeout_ms) {
+    if (!g_netwin.mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTake(g_netwin.mutex, portMAX_DELAY);
+    g_netwin.stats.holders++;
+    esp_timer_stop(g_netwin.radio_timer);
+    if (!pin_wifi_radio_is_on()) {
+        ret = pin_wifi_radio_on();
+        if (ret == ESP_OK) {
+            g_netwin.stats.windows++;
+        }
+    }
+    xSemaphoreGive(g_netwin.mutex);
+
+    if (ret == ESP_OK) {
+        ret = pin_wifi_wait_connected(timeout_ms);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "No connection after %u ms", (unsigned)timeout_ms);
+            g_netwin.stats.connect_failures++;
+        }
+    }
+    if (ret != ESP_OK) {
+        pin_netwin_release();
+        return ret;
+    }
+
+    // Jobs that are due anyway share the window
+    xSemaphoreTake(g_netwin.mutex, portMAX_DELAY);
+    pin_netwin_spawn_window();
+    xSemaphoreGive(g_netwin.mutex);
+    return ESP_OK;
+}
+
+void pin_netwin_release(void) {
+    if (!g_netwin.mutex) {
+        return;
+    }
+
+    xSemaphoreTake(g_netwin.mutex, portMAX_DELAY);
+    bool last = g_netwin.stats.holders > 0 && --g_netwin.stats.holders == 0;
+    if (last) {
+        g_netwin.idle_since_us = esp_timer_get_time();
+        esp_timer_stop(g_netwin.radio_timer);
+        esp_timer_start_once(g_netwin.radio_timer, (uint64_t)PIN_NETWIN_LINGER_MS * 1000);
+    }
+    xSemaphoreGive(g_netwin.mutex);
+
+    // Deep sleep was held off while the radio was in use
+    if (last) {
+        pin_sleep_plan_changed();
+    }
+}
+
+bool pin_netwin_is_held(void) {
+    if (!g_netwin.mutex) {
+        return false;
+    }
+
+    xSemaphoreTake(g_netwin.mutex, portMAX_DELAY);
+    bool held = g_netwin.stats.holders > 0;
+    xSemaphoreGive(g_netwin.mutex);
+    return held;
+}
+
+esp_err_t pin_netwin_add_job(const char* name, pin_netwin_job_t job, void* arg,
+                             int64_t deadline_us, uint32_t tolerance_ms) {
+    if (!name || !job || deadline_us <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!g_netwin.mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(g_netwin.mutex, portMAX_DELAY);
+    pin_netwin_job_entry_t* entry = pin_netwin_find(name);
+    if (!entry) {
+        if (g_netwin.job_count >= PIN_NETWIN_MAX_JOBS) {
+            xSemaphoreGive(g_netwin.mutex);
+            return ESP_ERR_NO_MEM;
+        }
+        entry = &g_netwin.jobs[g_netwin.job_count++];
+        memset(entry, 0, sizeof(pin_netwin_job_entry_t));
+        strncpy(entry->name, name, PIN_NETWIN_NAME_MAX_LEN - 1);
+
+        // First registration after a wake: keep the period that was running before the sleep
+        pin_sleep_deadline_t saved;
+        if (pin_sleep_restore_deadline(name, &saved) == ESP_OK) {
+            struct timeval tv;
+            gettimeofday(&tv, NULL);
+            int64_t delta_us = saved.due_us - ((int64_t)tv.tv_sec * 1000000 + tv.tv_usec);
+            int64_t restored_us = esp_timer_get_time() + (delta_us > 0 ? delta_us : 0);
+            if (restored_us < deadline_us) {
+                deadline_us = restored_us;
+                tolerance_ms = saved.tolerance_ms;
+            }
+        }
+    }
+    entry->job = job;
+    entry->arg = arg;
+    entry->deadline_us = deadline_us;
+    entry->tolerance_ms = tolerance_ms;
+    pin_netwin_arm_job_timer();
+    xSemaphoreGive(g_netwin.mutex);
+
+    pin_sleep_plan_changed();
+    return ESP_OK;
+}
+
+esp_err_t pin_netwin_remove_job(const char* name) {
+    if (!name || !g_netwin.mutex) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(g_netwin.mutex, portMAX_DELAY);
+    pin_netwin_job_entry_t* entry = pin_netwin_find(name);
+    if (entry) {
+        entry->deadline_us = 0;
+        pin_netwin_arm_job_timer();
+    }
+    xSemaphoreGive(g_netwin.mutex);
+
+    if (!entry) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    pin_sleep_plan_changed();
+    return ESP_OK;
+}
+
+esp_err_t pin_netwin_get_stats(pin_netwin_stats_t* stats) {
+    if (!stats || !g_netwin.mutex) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(g_netwin.mutex, portMAX_DELAY);
+    *stats = g_netwin.stats;
+    stats->radio_on = pin_wifi_radio_is_on();
+    xSemaphoreGive(g_netwin.mutex);
+    return ESP_OK;
+}
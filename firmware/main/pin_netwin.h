@@ -0,0 +1,109 @@
+/**
+ * @file pin_netwin.h
+ * @brief Pin Network Windows
+ *
+ * The radio is only on while something needs the network. Work that does
+ * takes a hold with pin_netwin_acquire(), which starts the station and
+ * waits for an address; when the last hold is released the radio stays up
+ * for PIN_NETWIN_LINGER_MS, so back-to-back work shares one window, and
+ * is then stopped. While someone is using the web UI (the sleep planner's
+ * interactive window) or deep sleep is disabled, the radio is kept up.
+ *
+ * Periodic network work that is not a plugin (e.g. the OTA check) is
+ * registered as a job with a deadline and tolerance. Due jobs run
+ * concurrently, each on its own task, in the next window that opens for
+ * any reason; a job whose tolerance runs out opens a window itself.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIN_NETWIN_MAX_JOBS 4
+#define PIN_NETWIN_NAME_MAX_LEN 16
+#define PIN_NETWIN_CONNECT_TIMEOUT_MS 10000
+#define PIN_NETWIN_LINGER_MS 2000           // Radio stays up this long after the last hold
+#define PIN_NETWIN_RETRY_MS 60000           // Next try after a window could not connect
+#define PIN_NETWIN_MAX_BACKOFF_SHIFT 5      // Retry delay doubles per failure, up to 32 min
+#define PIN_NETWIN_WINDOW_STACK_SIZE 3072
+#define PIN_NETWIN_JOB_STACK_SIZE 8192
+#define PIN_NETWIN_TASK_PRIORITY 4
+
+/**
+ * @brief Network job, runs on its own task with the radio up
+ * @param arg Argument passed to pin_netwin_add_job()
+ */
+typedef void (*pin_netwin_job_t)(void* arg);
+
+typedef struct {
+    uint32_t windows;                   // Times the radio was brought up
+    uint32_t connect_failures;          // Holds that got no address in time
+    uint32_t jobs_run;
+    uint8_t holders;                    // Holds open right now
+    bool radio_on;
+} pin_netwin_stats_t;
+
+/**
+ * @brief Initialize network windows; call after pin_wifi_init()
+ * @return ESP_OK on success
+ */
+esp_err_t pin_netwin_init(void);
+
+/**
+ * @brief Hold the radio up and wait until the station has an address
+ * @param timeout_ms Maximum wait for the connection
+ * @return ESP_OK with the hold taken, otherwise no hold is kept
+ *         (ESP_ERR_TIMEOUT, or ESP_ERR_INVALID_STATE without a saved network)
+ */
+esp_err_t pin_netwin_acquire(uint32_t timeout_ms);
+
+/**
+ * @brief Release a hold taken with pin_netwin_acquire()
+ */
+void pin_netwin_release(void);
+
+/**
+ * @brief Check whether anyone holds the radio; the device does not deep sleep while so
+ * @return true while at least one hold is taken
+ */
+bool pin_netwin_is_held(void);
+
+/**
+ * @brief Add a job or move its deadline; a job runs once per call
+ *
+ * A deadline for the same name kept over the last deep sleep wins if it is
+ * earlier, so periodic jobs keep their period across wakes.
+ *
+ * @param name Job name, also used in the sleep plan
+ * @param job Job function
+ * @param arg Argument for job
+ * @param deadline_us Earliest run time on the esp_timer clock
+ * @param tolerance_ms How long the job may wait for a window opened by others
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if all job slots are taken
+ */
+esp_err_t pin_netwin_add_job(const char* name, pin_netwin_job_t job, void* arg,
+                             int64_t deadline_us, uint32_t tolerance_ms);
+
+/**
+ * @brief Remove a job
+ * @param name Job name
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if no such job
+ */
+esp_err_t pin_netwin_remove_job(const char* name);
+
+/**
+ * @brief Get window statistics
+ * @param stats Output statistics
+ * @return ESP_OK on success
+ */
+esp_err_t pin_netwin_get_stats(pin_netwin_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
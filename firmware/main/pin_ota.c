@@ -14,6 +14,7 @@
 #include "nvs_flash.h"
 #include "nvs.h"
 #include "esp_timer.h"
+#include "pin_netwin.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
@@ -25,6 +26,8 @@ static const char *TAG = "PIN_OTA";
 #define PIN_OTA_BUFFER_SIZE 1024
 #define PIN_OTA_TIMEOUT_MS 30000
 #define PIN_OTA_NVS_NAMESPACE "ota_config"
+#define PIN_OTA_AUTO_CHECK_JOB "ota"
+#define PIN_OTA_AUTO_CHECK_TOLERANCE_PCT 10     // Of the interval, to share a network window
 
 // Event group for OTA coordination
 static EventGroupHandle_t ota_event_group;
@@ -46,12 +49,11 @@ static pin_ota_progress_callback_t g_progress_callback = NULL;
 static pin_ota_complete_callback_t g_complete_callback = NULL;
 
 // Auto-check configuration
-static esp_timer_handle_t g_auto_check_timer = NULL;
 static uint32_t g_auto_check_interval_hours = 0;
 
 // Forward declarations
 static void ota_update_task(void *pvParameter);
-static void auto_check_timer_callback(void *arg);
+static void auto_check_job(void *arg);
 static esp_err_t parse_update_info(const char *json_data, pin_ota_info_t *info);
 static esp_err_t download_and_install_update(const pin_ota_info_t *update_info);
 
@@ -82,20 +84,6 @@ esp_err_t pin_ota_init(void) {
         }
     }
     
-    // Initialize auto-check timer
-    esp_timer_create_args_t timer_args = {
-        .callback = auto_check_timer_callback,
-        .arg = NULL,
-        .dispatch_method = ESP_TIMER_TASK,
-        .name = "ota_auto_check"
-    };
-    
-    esp_err_t ret = esp_timer_create(&timer_args, &g_auto_check_timer);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create auto-check timer");
-        return ret;
-    }
-    
     ESP_LOGI(TAG, "OTA system initialized successfully");
     return ESP_OK;
 }
@@ -108,6 +96,15 @@ esp_err_t pin_ota_check_update(const char* update_url) {
     ESP_LOGI(TAG, "Checking for updates from: %s", update_url);
     g_ota_status.state = PIN_OTA_STATE_CHECKING;
     
+    // The hold keeps the radio up and the device out of deep sleep until the check ends
+    esp_err_t err = pin_netwin_acquire(PIN_NETWIN_CONNECT_TIMEOUT_MS);
+    if (err != ESP_OK) {
+        g_ota_status.state = PIN_OTA_STATE_ERROR;
+        snprintf(g_ota_status.error_message, sizeof(g_ota_status.error_message),
+                 "No network: %s", esp_err_to_name(err));
+        return err;
+    }
+    
     // Configure HTTP client
     esp_http_client_config_t config = {
         .url = update_url,
@@ -118,13 +115,14 @@ esp_err_t pin_ota_check_update(const char* update_url) {
     
     esp_http_client_handle_t client = esp_http_client_init(&config);
     if (!client) {
+        pin_netwin_release();
         g_ota_status.state = PIN_OTA_STATE_ERROR;
         strncpy(g_ota_status.error_message, "Failed to initialize HTTP client", 
                 sizeof(g_ota_status.error_message) - 1);
         return ESP_ERR_NO_MEM;
     }
     
-    esp_err_t err = esp_http_client_perform(client);
+    err = esp_http_client_perform(client);
     if (err == ESP_OK) {
         int status_code = esp_http_client_get_status_code(client);
         int content_length = esp_http_client_get_content_length(client);
@@ -163,6 +161,7 @@ esp_err_t pin_ota_check_update(const char* update_url) {
     }
     
     esp_http_client_cleanup(client);
+    pin_netwin_release();
     
     if (err != ESP_OK) {
         g_ota_status.state = PIN_OTA_STATE_ERROR;
@@ -259,21 +258,26 @@ esp_err_t pin_ota_mark_valid(void) {
     return err;
 }
 
+// The check runs as a network job, so it joins a window the plugins open anyway
+static esp_err_t schedule_auto_check(void) {
+    uint64_t interval_ms = (uint64_t)g_auto_check_interval_hours * 3600 * 1000;
+    return pin_netwin_add_job(PIN_OTA_AUTO_CHECK_JOB, auto_check_job, NULL,
+                              esp_timer_get_time() + (int64_t)interval_ms * 1000,
+                              (uint32_t)(interval_ms / 100 * PIN_OTA_AUTO_CHECK_TOLERANCE_PCT));
+}
+
 esp_err_t pin_ota_set_auto_check_interval(uint32_t interval_hours) {
     g_auto_check_interval_hours = interval_hours;
     
-    // Stop existing timer
-    esp_timer_stop(g_auto_check_timer);
-    
     if (interval_hours > 0) {
-        uint64_t interval_us = (uint64_t)interval_hours * 3600 * 1000000;
-        esp_err_t err = esp_timer_start_periodic(g_auto_check_timer, interval_us);
+        esp_err_t err = schedule_auto_check();
         if (err != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to start auto-check timer: %s", esp_err_to_name(err));
+            ESP_LOGE(TAG, "Failed to schedule auto-check: %s", esp_err_to_name(err));
             return err;
         }
         ESP_LOGI(TAG, "Auto-check enabled: every %d hours", interval_hours);
     } else {
+        pin_netwin_remove_job(PIN_OTA_AUTO_CHECK_JOB);
         ESP_LOGI(TAG, "Auto-check disabled");
     }
     
@@ -289,7 +293,12 @@ const char* pin_ota_get_current_version(void) {
 static void ota_update_task(void *pvParameter) {
     ESP_LOGI(TAG, "Starting OTA update task");
     
-    esp_err_t err = download_and_install_update(&g_ota_status.available_update);
+    // Radio up and no deep sleep for the whole download
+    esp_err_t err = pin_netwin_acquire(PIN_NETWIN_CONNECT_TIMEOUT_MS);
+    if (err == ESP_OK) {
+        err = download_and_install_update(&g_ota_status.available_update);
+        pin_netwin_release();
+    }
     
     if (err == ESP_OK) {
         g_ota_status.state = PIN_OTA_STATE_COMPLETE;
@@ -319,12 +328,16 @@ static void ota_update_task(void *pvParameter) {
     vTaskDelete(NULL);
 }
 
-static void auto_check_timer_callback(void *arg) {
+static void auto_check_job(void *arg) {
     ESP_LOGI(TAG, "Automatic update check triggered");
     
     // Use a default update server URL - this should be configurable
     const char* update_url = "https://api.github.com/repos/MePride/pin/releases/latest";
     pin_ota_check_update(update_url);
+    
+    if (g_auto_check_interval_hours > 0) {
+        schedule_auto_check();
+    }
 }
 
 static esp_err_t parse_update_info(const char *json_data, pin_ota_info_t *info) {
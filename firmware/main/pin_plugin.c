@@ -5,21 +5,47 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <sys/time.h>
 #include "pin_plugin.h"
+#include "pin_config.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "esp_system.h"
 #include "esp_http_client.h"
-#include "nvs_flash.h"
-#include "nvs.h"
 #include "cJSON.h"
 #include "pin_wifi.h"
 #include "pin_display.h"
+#include "pin_scheduler.h"
+#include "pin_event_bus.h"
+#include "pin_http_pool.h"
+#include "pin_http_cache.h"
+#include "pin_plugin_store.h"
+#include "pin_sleep.h"
+#include "pin_retain.h"
+#include "pin_power.h"
+#include "pin_netwin.h"
 
 static const char* TAG = "PIN_PLUGIN";
 
-#define PIN_PLUGIN_DEFAULT_MEMORY_LIMIT (64 * 1024)   // 64KB
+// 64KB arena, or the whole pool when the pool is smaller
+#if CONFIG_PIN_PLUGIN_HEAP_SIZE < 64 * 1024
+#define PIN_PLUGIN_DEFAULT_MEMORY_LIMIT CONFIG_PIN_PLUGIN_HEAP_SIZE
+#else
+#define PIN_PLUGIN_DEFAULT_MEMORY_LIMIT (64 * 1024)
+#endif
 #define PIN_PLUGIN_API_RATE_LIMIT 100                 // 100 calls per minute
+#define PIN_PLUGIN_RATE_BURST_SECONDS 10              // Bucket holds this many seconds of calls
+#define PIN_PLUGIN_RATE_MIN_BURST 4                   // ...but at least this many, a few default config writes
 #define PIN_PLUGIN_MAX_ERRORS 5                       // Maximum error count
+#define PIN_PLUGIN_DEFAULT_STACK_SIZE 4096            // Stack for blocking plugin tasks
+#define PIN_PLUGIN_SUSPEND_DELAY_MS 60000             // Retry delay after a resource violation
+#define PIN_PLUGIN_MIN_FREE_HEAP (16 * 1024)          // Updates wait while the heap is below this
+#define PIN_PLUGIN_DEFAULT_TOLERANCE_PCT 10           // Slack for interval-driven updates
+#define PIN_PLUGIN_BUDGET_WINDOW_US (60 * 1000000LL)  // cpu_budget_ms is per minute
+#define PIN_PLUGIN_HTTP_CHUNK_SIZE 256                // Response bytes read per chunk
+#define PIN_PLUGIN_CONFIG_FLUSH_DELAY_MS 5000         // Coalesce config writes this long
+#define PIN_PLUGIN_STOP_POLL_MS 10                    // Disable polls this often for a callback to finish
+#define PIN_PLUGIN_EVENT_QUEUE_LEN 4                  // Events waiting for a blocking plugin's task
 
 // Plugin manager structure
 typedef struct {
@@ -27,10 +53,21 @@ typedef struct {
     pin_plugin_context_t contexts[PIN_MAX_PLUGINS];   // Context array
     uint8_t plugin_count;                             // Current plugin count
     
-    // Task management
+    // Task management (non-blocking plugins share the scheduler worker)
     TaskHandle_t manager_task_handle;                 // Manager task handle
     QueueHandle_t message_queue;                      // Message queue
     SemaphoreHandle_t plugins_mutex;                  // Plugin list mutex
+    portMUX_TYPE run_lock;                            // plugin->running, ctx->busy_task, plugin->plugin_task
+    QueueHandle_t event_queues[PIN_MAX_PLUGINS];      // Events for blocking plugins, drained by their task
+    
+    // Scheduler batch (display refresh is shared by all plugins in a batch)
+    TaskHandle_t batch_task;                          // Task running the current batch
+    bool batch_refresh_pending;                       // A plugin drew during the batch
+    bool batch_net_tried;                             // A plugin asked for the network during the batch
+    esp_err_t batch_net_result;                       // ESP_OK: the batch holds a network window
+    
+    // Config writes are collected and committed once by the manager task
+    esp_timer_handle_t config_flush_timer;            // Armed by the first dirty write
     
     // System state
     bool plugins_enabled;                             // Plugin system enabled
@@ -39,13 +76,16 @@ typedef struct {
 } pin_plugin_manager_t;
 
 // Global plugin manager instance
-static pin_plugin_manager_t g_plugin_manager = {0};
+static pin_plugin_manager_t g_plugin_manager = {
+    .run_lock = portMUX_INITIALIZER_UNLOCKED,
+};
 
 // Plugin message types
 typedef enum {
     PLUGIN_MSG_ENABLE,
     PLUGIN_MSG_DISABLE,
     PLUGIN_MSG_CONFIG_CHANGED,
+    PLUGIN_MSG_FLUSH_CONFIG,
     PLUGIN_MSG_SHUTDOWN
 } pin_plugin_message_type_t;
 
@@ -56,11 +96,44 @@ typedef struct {
     char value[128];
 } pin_plugin_message_t;
 
+// Event handed from the event bus to a blocking plugin's task
+typedef struct {
+    void (*callback)(const char* data);
+    char data[PIN_EVENT_BUS_PAYLOAD_MAX_LEN];
+} pin_plugin_event_t;
+
 // Forward declarations
 static void pin_plugin_manager_task(void* pvParameters);
 static void pin_plugin_task_wrapper(void* pvParameters);
+static void pin_plugin_dispatch(const uint8_t* ids, uint8_t count);
+static void pin_plugin_poll_events(void);
+static void pin_plugin_deliver_event(uint8_t plugin_id, void (*callback)(const char* data), const char* data);
+static esp_err_t pin_plugin_arm(pin_plugin_context_t* ctx, int64_t deadline_us, uint32_t tolerance_ms);
+static uint32_t pin_plugin_run_update(pin_plugin_t* plugin, pin_plugin_context_t* ctx);
 static esp_err_t pin_plugin_init_context(pin_plugin_context_t* ctx, pin_plugin_t* plugin);
 static esp_err_t pin_plugin_check_resources(pin_plugin_context_t* ctx);
+static void pin_plugin_release_arena(pin_plugin_context_t* ctx);
+static void pin_plugin_config_dirty(void);
+static void pin_plugin_config_flush_timer(void* arg);
+static uint8_t pin_plugin_sleep_deadlines(pin_sleep_deadline_t* out, uint8_t max);
+static void pin_plugin_update_memory_stats(pin_plugin_context_t* ctx);
+static void pin_plugin_reset_rate_limits(pin_plugin_context_t* ctx);
+static void pin_plugin_save_retained(pin_plugin_t* plugin);
+static void pin_plugin_abort_enable(pin_plugin_t* plugin, pin_plugin_context_t* ctx, bool started);
+static bool pin_plugin_enter(pin_plugin_t* plugin, pin_plugin_context_t* ctx);
+static void pin_plugin_leave(pin_plugin_context_t* ctx);
+static void pin_plugin_drain_events(pin_plugin_t* plugin, pin_plugin_context_t* ctx);
+static void pin_plugin_close_events(pin_plugin_t* plugin);
+
+// Time accounting for one plugin callback
+typedef struct {
+    int64_t start_us;
+    uint64_t blocked_us;
+} pin_plugin_timing_t;
+
+static void pin_plugin_timing_begin(pin_plugin_context_t* ctx, pin_plugin_timing_t* timing);
+static uint32_t pin_plugin_timing_end(pin_plugin_context_t* ctx, const pin_plugin_timing_t* timing);
+static uint32_t pin_plugin_latency_percentile(const pin_plugin_context_t* ctx, uint8_t percentile);
 
 // API implementation functions
 static esp_err_t plugin_api_log_info(const char* tag, const char* format, ...);
@@ -68,6 +141,7 @@ static esp_err_t plugin_api_log_warn(const char* tag, const char* format, ...);
 static esp_err_t plugin_api_log_error(const char* tag, const char* format, ...);
 static esp_err_t plugin_api_http_get(const char* url, char* response, size_t max_len);
 static esp_err_t plugin_api_http_post(const char* url, const char* data, char* response, size_t max_len);
+static esp_err_t plugin_api_http_get_stream(const char* url, pin_plugin_http_chunk_cb_t on_chunk, void* user_data);
 static esp_err_t plugin_api_config_get(const char* key, char* value, size_t max_len);
 static esp_err_t plugin_api_config_set(const char* key, const char* value);
 static esp_err_t plugin_api_config_delete(const char* key);
@@ -76,10 +150,20 @@ static esp_err_t plugin_api_get_time_string(char* time_str, size_t max_len, cons
 static esp_err_t plugin_api_display_update_content(const char* content);
 static esp_err_t plugin_api_display_set_color(uint8_t color);
 static esp_err_t plugin_api_display_set_font_size(uint8_t font_size);
-static esp_err_t plugin_api_schedule_update(uint32_t delay_seconds);
+static esp_err_t plugin_api_schedule_update(uint32_t delay_ms, uint32_t tolerance_ms);
+static esp_err_t plugin_api_schedule_update_at(time_t when, uint32_t tolerance_ms);
 static esp_err_t plugin_api_cancel_scheduled_update(void);
 static esp_err_t plugin_api_emit_event(const char* event_name, const char* data);
 static esp_err_t plugin_api_subscribe_event(const char* event_name, void (*callback)(const char* data));
+static void plugin_api_log_debug(const char* tag, const char* format, ...);
+static uint32_t plugin_api_get_uptime(void);
+static uint32_t plugin_api_get_free_heap(void);
+static bool plugin_api_is_wifi_connected(void);
+static esp_err_t plugin_api_get_mac_address(char* mac_str, size_t mac_str_size);
+static esp_err_t plugin_api_create_timer(uint32_t interval_ms, bool repeat, void (*callback)(void*), void* arg);
+static esp_err_t plugin_api_start_timer(void* timer_handle);
+static esp_err_t plugin_api_stop_timer(void* timer_handle);
+static esp_err_t plugin_api_delete_timer(void* timer_handle);
 
 esp_err_t pin_plugin_manager_init(void) {
     ESP_LOGI(TAG, "Initializing plugin manager");
@@ -98,6 +182,48 @@ esp_err_t pin_plugin_manager_init(void) {
         return ESP_ERR_NO_MEM;
     }
     
+    // Start the shared scheduler that runs non-blocking plugins
+    esp_err_t sched_ret = pin_scheduler_init(pin_plugin_dispatch);
+    if (sched_ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start plugin scheduler: %s", esp_err_to_name(sched_ret));
+        vQueueDelete(g_plugin_manager.message_queue);
+        vSemaphoreDelete(g_plugin_manager.plugins_mutex);
+        return sched_ret;
+    }
+    
+    // Events are delivered on the scheduler worker whenever it wakes
+    esp_err_t bus_ret = pin_event_bus_init(pin_plugin_deliver_event, pin_scheduler_wake);
+    if (bus_ret == ESP_OK) {
+        bus_ret = pin_scheduler_set_poll_hook(pin_plugin_poll_events);
+    }
+    if (bus_ret != ESP_OK) {
+        ESP_LOGW(TAG, "Event bus unavailable: %s", esp_err_to_name(bus_ret));
+    }
+    
+    // Plugin HTTP requests borrow keep-alive connections from a shared pool;
+    // the cache records response headers through the pool's event handler
+    esp_err_t pool_ret = pin_http_cache_init();
+    if (pool_ret == ESP_OK) {
+        pool_ret = pin_http_pool_init(pin_http_cache_event_handler);
+    }
+    if (pool_ret != ESP_OK) {
+        ESP_LOGW(TAG, "HTTP pool unavailable: %s", esp_err_to_name(pool_ret));
+    }
+    
+    // The wake planner sleeps until the earliest plugin deadline
+    esp_err_t sleep_ret = pin_sleep_register_source(pin_plugin_sleep_deadlines);
+    if (sleep_ret != ESP_OK) {
+        ESP_LOGW(TAG, "Plugin deadlines not used for wake planning: %s", esp_err_to_name(sleep_ret));
+    }
+    
+    esp_timer_create_args_t flush_timer_args = {
+        .callback = pin_plugin_config_flush_timer,
+        .name = "plugin_cfg",
+    };
+    if (esp_timer_create(&flush_timer_args, &g_plugin_manager.config_flush_timer) != ESP_OK) {
+        ESP_LOGW(TAG, "Config flush timer unavailable, config writes commit on disable only");
+    }
+    
     // Create manager task
     BaseType_t ret = xTaskCreate(
         pin_plugin_manager_task,
@@ -128,7 +254,7 @@ esp_err_t pin_plugin_register(pin_plugin_t* plugin) {
     }
     
     // Validate plugin
-    esp_err_t ret = ESP_OK;
+    esp_err_t ret = pin_plugin_validate(plugin);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Plugin validation failed");
         return ret;
@@ -189,12 +315,56 @@ esp_err_t pin_plugin_enable(const char* plugin_name, bool enable) {
     if (enable && !plugin->enabled) {
         ESP_LOGI(TAG, "Enabling plugin '%s'", plugin_name);
         
+        // Every initialized plugin owns an arena until it is disabled
+        if (!ctx->arena.base) {
+            uint32_t arena_size = plugin->config.memory_limit > 0 ?
+                                  plugin->config.memory_limit : PIN_PLUGIN_DEFAULT_MEMORY_LIMIT;
+            esp_err_t ret = pin_arena_create(&ctx->arena, arena_size);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "No memory for plugin '%s' (%u bytes, %u free in the pool)", plugin_name,
+                         (unsigned)arena_size, (unsigned)pin_arena_pool_free());
+                plugin->state = PLUGIN_STATE_ERROR;
+                return ret;
+            }
+        }
+        
+        // Config is read from RAM from here on; see pin_plugin_flush_config()
+        if (!ctx->config_store) {
+            esp_err_t ret = pin_plugin_store_open(plugin_name, &ctx->config_store);
+            if (ret != ESP_OK) {
+                ESP_LOGW(TAG, "No config store for plugin '%s': %s", plugin_name, esp_err_to_name(ret));
+            }
+        }
+        
+        pin_plugin_reset_rate_limits(ctx);
+        
+        // Resume from the state kept over deep sleep, if it is still intact
+        ctx->state_restored = false;
+        if (plugin->retained.data && plugin->retained.size > 0) {
+            ctx->state_restored = pin_retain_restore(plugin_name, plugin->retained.version,
+                                                     plugin->retained.data,
+                                                     plugin->retained.size) == ESP_OK;
+        }
+        
+        // start() may pick the first deadline, otherwise the first update is due now
+        ctx->schedule.deadline_us = esp_timer_get_time();
+        ctx->schedule.tolerance_ms = 0;
+        ctx->schedule.requested = false;
+        
+        // Lifecycle callbacks use the context-scoped API from the caller's task
+        void* prev_ctx = pvTaskGetThreadLocalStoragePointer(NULL, 0);
+        vTaskSetThreadLocalStoragePointer(NULL, 0, ctx);
+        
         // Initialize plugin if not already done
         if (!plugin->initialized && plugin->init) {
+            pin_plugin_timing_t timing;
+            pin_plugin_timing_begin(ctx, &timing);
             esp_err_t ret = plugin->init(ctx);
+            pin_plugin_timing_end(ctx, &timing);
             if (ret != ESP_OK) {
+                vTaskSetThreadLocalStoragePointer(NULL, 0, prev_ctx);
                 ESP_LOGE(TAG, "Failed to initialize plugin '%s': %s", plugin_name, esp_err_to_name(ret));
-                plugin->state = PLUGIN_STATE_ERROR;
+                pin_plugin_abort_enable(plugin, ctx, false);
                 return ret;
             }
             plugin->initialized = true;
@@ -203,57 +373,140 @@ esp_err_t pin_plugin_enable(const char* plugin_name, bool enable) {
         
         // Start plugin
         if (plugin->start) {
+            pin_plugin_timing_t timing;
+            pin_plugin_timing_begin(ctx, &timing);
             esp_err_t ret = plugin->start(ctx);
+            pin_plugin_timing_end(ctx, &timing);
             if (ret != ESP_OK) {
+                vTaskSetThreadLocalStoragePointer(NULL, 0, prev_ctx);
                 ESP_LOGE(TAG, "Failed to start plugin '%s': %s", plugin_name, esp_err_to_name(ret));
-                plugin->state = PLUGIN_STATE_ERROR;
+                pin_plugin_abort_enable(plugin, ctx, false);
                 return ret;
             }
         }
         
+        vTaskSetThreadLocalStoragePointer(NULL, 0, prev_ctx);
+        pin_plugin_save_retained(plugin);
+        
+        // After deep sleep, pick up where the plugin left off instead of updating now
+        pin_sleep_deadline_t saved;
+        if (!ctx->schedule.requested && pin_sleep_restore_deadline(plugin_name, &saved) == ESP_OK) {
+            struct timeval tv;
+            gettimeofday(&tv, NULL);
+            int64_t delta_us = saved.due_us - ((int64_t)tv.tv_sec * 1000000 + tv.tv_usec);
+            ctx->schedule.deadline_us = esp_timer_get_time() + (delta_us > 0 ? delta_us : 0);
+            ctx->schedule.tolerance_ms = saved.tolerance_ms;
+        }
+        
+        // Event callbacks of blocking plugins run on the plugin's task, queued here
+        if (plugin->config.blocking) {
+            g_plugin_manager.event_queues[plugin->plugin_id] =
+                xQueueCreate(PIN_PLUGIN_EVENT_QUEUE_LEN, sizeof(pin_plugin_event_t));
+            if (!g_plugin_manager.event_queues[plugin->plugin_id]) {
+                ESP_LOGE(TAG, "Failed to create event queue for plugin '%s'", plugin_name);
+                pin_plugin_abort_enable(plugin, ctx, true);
+                return ESP_ERR_NO_MEM;
+            }
+        }
+        
         plugin->enabled = true;
         plugin->running = true;
         plugin->state = PLUGIN_STATE_RUNNING;
         
-        // Create plugin task
-        char task_name[32];
-        snprintf(task_name, sizeof(task_name), "plugin_%s", plugin_name);
-        BaseType_t task_ret = xTaskCreate(
-            pin_plugin_task_wrapper,
-            task_name,
-            4096,
-            plugin,
-            4,
-            &plugin->plugin_task
-        );
-        
-        if (task_ret != pdPASS) {
-            ESP_LOGE(TAG, "Failed to create task for plugin '%s'", plugin_name);
-            plugin->enabled = false;
-            plugin->running = false;
-            plugin->state = PLUGIN_STATE_ERROR;
-            return ESP_FAIL;
+        if (plugin->config.blocking) {
+            // Plugins that block get a dedicated task with their own stack
+            char task_name[32];
+            snprintf(task_name, sizeof(task_name), "plugin_%s", plugin_name);
+            uint32_t stack_size = plugin->config.task_stack_size > 0 ?
+                                  plugin->config.task_stack_size : PIN_PLUGIN_DEFAULT_STACK_SIZE;
+            BaseType_t task_ret = xTaskCreate(
+                pin_plugin_task_wrapper,
+                task_name,
+                stack_size,
+                plugin,
+                4,
+                &plugin->plugin_task
+            );
+            
+            if (task_ret != pdPASS) {
+                ESP_LOGE(TAG, "Failed to create task for plugin '%s'", plugin_name);
+                plugin->plugin_task = NULL;
+                pin_plugin_abort_enable(plugin, ctx, true);
+                return ESP_FAIL;
+            }
+        } else {
+            // Everything else runs on the shared scheduler
+            esp_err_t ret = ESP_OK;
+            if (ctx->schedule.deadline_us > 0) {
+                ret = pin_scheduler_add(plugin->plugin_id, ctx->schedule.deadline_us,
+                                        (int64_t)ctx->schedule.tolerance_ms * 1000);
+            }
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to schedule plugin '%s': %s", plugin_name, esp_err_to_name(ret));
+                pin_plugin_abort_enable(plugin, ctx, true);
+                return ret;
+            }
         }
         
         ESP_LOGI(TAG, "Plugin '%s' enabled successfully", plugin_name);
         
     } else if (!enable && plugin->enabled) {
+        // From inside one of the plugin's own callbacks, disable once it returns
+        TaskHandle_t self = xTaskGetCurrentTaskHandle();
+        if (ctx->busy_task == self || plugin->plugin_task == self) {
+            pin_plugin_message_t message = { .type = PLUGIN_MSG_DISABLE };
+            strncpy(message.plugin_name, plugin_name, sizeof(message.plugin_name) - 1);
+            return xQueueSend(g_plugin_manager.message_queue, &message, 0) == pdTRUE ? ESP_OK : ESP_ERR_NO_MEM;
+        }
+        
         ESP_LOGI(TAG, "Disabling plugin '%s'", plugin_name);
         
-        plugin->enabled = false;
+        portENTER_CRITICAL(&g_plugin_manager.run_lock);
         plugin->running = false;
-        plugin->state = PLUGIN_STATE_LOADED;
+        portEXIT_CRITICAL(&g_plugin_manager.run_lock);
         
-        // Delete plugin task
+        // Let the callback in progress finish. A blocking task is woken and
+        // exits on its own, so it never dies holding a pooled HTTP client,
+        // a power lock or a network window hold.
         if (plugin->plugin_task) {
-            vTaskDelete(plugin->plugin_task);
-            plugin->plugin_task = NULL;
+            xTaskNotifyGive(plugin->plugin_task);
+        }
+        while (ctx->busy_task || plugin->plugin_task) {
+            vTaskDelay(pdMS_TO_TICKS(PIN_PLUGIN_STOP_POLL_MS));
         }
+        pin_scheduler_remove(plugin->plugin_id);
+        pin_plugin_close_events(plugin);
         
-        // Stop plugin
+        // A plugin stopped for too many errors stays marked as failed
+        plugin->enabled = false;
+        if (plugin->state != PLUGIN_STATE_ERROR) {
+            plugin->state = PLUGIN_STATE_LOADED;
+        }
+        
+        // Stop plugin and tear it down, its arena goes back to the pool
+        void* prev_ctx = pvTaskGetThreadLocalStoragePointer(NULL, 0);
+        vTaskSetThreadLocalStoragePointer(NULL, 0, ctx);
         if (plugin->stop) {
             plugin->stop(ctx);
         }
+        if (plugin->initialized && plugin->cleanup) {
+            plugin->cleanup(ctx);
+        }
+        vTaskSetThreadLocalStoragePointer(NULL, 0, prev_ctx);
+        
+        plugin->initialized = false;
+        plugin->private_data = NULL;
+        pin_plugin_release_arena(ctx);
+        pin_retain_discard(plugin_name);
+        
+        // Detach under the list lock so a concurrent flush never sees a freed store
+        pin_plugin_store_t* store = NULL;
+        if (xSemaphoreTake(g_plugin_manager.plugins_mutex, portMAX_DELAY)) {
+            store = ctx->config_store;
+            ctx->config_store = NULL;
+            xSemaphoreGive(g_plugin_manager.plugins_mutex);
+        }
+        pin_plugin_store_close(store);
         
         ESP_LOGI(TAG, "Plugin '%s' disabled successfully", plugin_name);
     }
@@ -294,6 +547,33 @@ esp_err_t pin_plugin_get_list(pin_plugin_t** plugins, uint8_t max_plugins, uint8
     return ESP_ERR_TIMEOUT;
 }
 
+esp_err_t pin_plugin_get_stats(const pin_plugin_t* plugin, pin_plugin_stats_t* stats) {
+    if (!plugin || !stats || plugin->plugin_id >= g_plugin_manager.plugin_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    const pin_plugin_context_t* ctx = &g_plugin_manager.contexts[plugin->plugin_id];
+    
+    stats->memory_limit = plugin->config.memory_limit;
+    stats->memory_used = ctx->stats.memory_used;
+    stats->memory_peak = ctx->stats.memory_peak;
+    stats->update_count = ctx->stats.update_count;
+    stats->error_count = ctx->stats.error_count;
+    stats->api_calls_count = ctx->stats.api_calls_count;
+    stats->rate_limited_count = ctx->stats.rate_limited_count;
+    stats->cpu_time_us = ctx->stats.cpu_time_us;
+    stats->blocked_http_us = ctx->stats.blocked_http_us;
+    stats->blocked_display_us = ctx->stats.blocked_display_us;
+    stats->update_p50_us = pin_plugin_latency_percentile(ctx, 50);
+    stats->update_p99_us = pin_plugin_latency_percentile(ctx, 99);
+    stats->update_max_us = ctx->stats.update_max_us;
+    stats->throttle_count = ctx->stats.throttle_count;
+    stats->unchanged_updates = ctx->stats.unchanged_updates;
+    stats->throttled = ctx->is_suspended && ctx->suspension_reason == PIN_PLUGIN_SUSPEND_CPU_BUDGET;
+    
+    return ESP_OK;
+}
+
 static esp_err_t pin_plugin_init_context(pin_plugin_context_t* ctx, pin_plugin_t* plugin) {
     memset(ctx, 0, sizeof(pin_plugin_context_t));
     
@@ -306,6 +586,7 @@ static esp_err_t pin_plugin_init_context(pin_plugin_context_t* ctx, pin_plugin_t
     ctx->api.log_debug = plugin_api_log_debug;
     ctx->api.http_get = plugin_api_http_get;
     ctx->api.http_post = plugin_api_http_post;
+    ctx->api.http_get_stream = plugin_api_http_get_stream;
     ctx->api.config_get = plugin_api_config_get;
     ctx->api.config_set = plugin_api_config_set;
     ctx->api.config_delete = plugin_api_config_delete;
@@ -320,12 +601,390 @@ static esp_err_t pin_plugin_init_context(pin_plugin_context_t* ctx, pin_plugin_t
     ctx->api.start_timer = plugin_api_start_timer;
     ctx->api.stop_timer = plugin_api_stop_timer;
     ctx->api.delete_timer = plugin_api_delete_timer;
-    //ctx->api.emit_event = plugin_api_emit_event;
-    //ctx->api.subscribe_event = plugin_api_subscribe_event;
+    ctx->api.schedule_update = plugin_api_schedule_update;
+    ctx->api.schedule_update_at = plugin_api_schedule_update_at;
+    ctx->api.cancel_scheduled_update = plugin_api_cancel_scheduled_update;
+    ctx->api.emit_event = plugin_api_emit_event;
+    ctx->api.subscribe_event = plugin_api_subscribe_event;
     
     return ESP_OK;
 }
 
+static inline uint64_t pin_plugin_blocked_total(const pin_plugin_context_t* ctx) {
+    return ctx->stats.blocked_http_us + ctx->stats.blocked_display_us;
+}
+
+static void pin_plugin_timing_begin(pin_plugin_context_t* ctx, pin_plugin_timing_t* timing) {
+    timing->blocked_us = pin_plugin_blocked_total(ctx);
+    timing->start_us = esp_timer_get_time();
+}
+
+/**
+ * Charge the CPU time of a callback to its plugin, leaving out time spent
+ * blocked in HTTP or display calls. Returns the wall-clock duration.
+ */
+static uint32_t pin_plugin_timing_end(pin_plugin_context_t* ctx, const pin_plugin_timing_t* timing) {
+    int64_t elapsed_us = esp_timer_get_time() - timing->start_us;
+    uint64_t blocked_us = pin_plugin_blocked_total(ctx) - timing->blocked_us;
+    uint32_t cpu_us = elapsed_us > (int64_t)blocked_us ? (uint32_t)(elapsed_us - blocked_us) : 0;
+    
+    ctx->stats.cpu_time_us += cpu_us;
+    ctx->stats.budget_used_us += cpu_us;
+    return (uint32_t)elapsed_us;
+}
+
+// Latency histogram: two buckets per power of two microseconds
+static uint8_t pin_plugin_latency_bucket(uint32_t us) {
+    if (us < 2) {
+        return 0;
+    }
+    uint8_t msb = 31 - __builtin_clz(us);
+    uint8_t bucket = msb * 2 + ((us >> (msb - 1)) & 1);
+    return bucket < PIN_PLUGIN_LATENCY_BUCKETS ? bucket : PIN_PLUGIN_LATENCY_BUCKETS - 1;
+}
+
+static uint32_t pin_plugin_latency_bucket_limit(uint8_t bucket) {
+    if (bucket < 2) {
+        return bucket + 1;
+    }
+    uint8_t msb = bucket / 2;
+    uint32_t half = 1u << (msb - 1);
+    return (1u << msb) + (bucket & 1) * half + half;
+}
+
+static void pin_plugin_record_latency(pin_plugin_context_t* ctx, uint32_t us) {
+    uint16_t* hist = ctx->stats.update_latency;
+    uint8_t bucket = pin_plugin_latency_bucket(us);
+    
+    // Halve everything instead of saturating, recent samples keep their weight
+    if (hist[bucket] == UINT16_MAX) {
+        for (int i = 0; i < PIN_PLUGIN_LATENCY_BUCKETS; i++) {
+            hist[i] >>= 1;
+        }
+    }
+    hist[bucket]++;
+    
+    if (us > ctx->stats.update_max_us) {
+        ctx->stats.update_max_us = us;
+    }
+}
+
+static uint32_t pin_plugin_latency_percentile(const pin_plugin_context_t* ctx, uint8_t percentile) {
+    const uint16_t* hist = ctx->stats.update_latency;
+    uint32_t total = 0;
+    for (int i = 0; i < PIN_PLUGIN_LATENCY_BUCKETS; i++) {
+        total += hist[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    
+    uint32_t target = (total * percentile + 99) / 100;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < PIN_PLUGIN_LATENCY_BUCKETS; i++) {
+        seen += hist[i];
+        if (seen >= target) {
+            // Report the bucket's upper edge, never more than the observed maximum
+            uint32_t limit = pin_plugin_latency_bucket_limit(i);
+            return limit < ctx->stats.update_max_us ? limit : ctx->stats.update_max_us;
+        }
+    }
+    return ctx->stats.update_max_us;
+}
+
+/**
+ * Returns how long a plugin over its CPU budget must wait, or 0 if it may run.
+ */
+static uint32_t pin_plugin_budget_delay(pin_plugin_t* plugin, pin_plugin_context_t* ctx) {
+    if (plugin->config.cpu_budget_ms == 0) {
+        return 0;
+    }
+    
+    int64_t now = esp_timer_get_time();
+    if (now - ctx->stats.budget_window_start_us >= PIN_PLUGIN_BUDGET_WINDOW_US) {
+        ctx->stats.budget_window_start_us = now;
+        ctx->stats.budget_used_us = 0;
+    }
+    
+    if (ctx->stats.budget_used_us < plugin->config.cpu_budget_ms * 1000) {
+        return 0;
+    }
+    
+    int64_t remaining_us = ctx->stats.budget_window_start_us + PIN_PLUGIN_BUDGET_WINDOW_US - now;
+    return (uint32_t)(remaining_us / 1000) + 1;
+}
+
+/**
+ * Run one update cycle. Returns the delay in milliseconds until the next
+ * cycle, or 0 if the plugin must not run again.
+ */
+static uint32_t pin_plugin_run_update(pin_plugin_t* plugin, pin_plugin_context_t* ctx) {
+    // Check resource limits; a suspended plugin is not retried sooner than it would have run
+    esp_err_t resources = pin_plugin_check_resources(ctx);
+    if (resources != ESP_OK) {
+        if (ctx->suspension_reason != PIN_PLUGIN_SUSPEND_RESOURCES) {
+            ESP_LOGW(TAG, "Plugin '%s' suspended due to resource limits: %s",
+                     plugin->metadata.name, esp_err_to_name(resources));
+        }
+        ctx->is_suspended = true;
+        ctx->suspension_reason = PIN_PLUGIN_SUSPEND_RESOURCES;
+        plugin->state = PLUGIN_STATE_SUSPENDED;
+        uint32_t interval_ms = plugin->config.update_interval * 1000;
+        return interval_ms > PIN_PLUGIN_SUSPEND_DELAY_MS ? interval_ms : PIN_PLUGIN_SUSPEND_DELAY_MS;
+    }
+    
+    // Throttle until the budget window rolls over
+    uint32_t budget_delay = pin_plugin_budget_delay(plugin, ctx);
+    if (budget_delay > 0) {
+        if (ctx->suspension_reason != PIN_PLUGIN_SUSPEND_CPU_BUDGET) {
+            ESP_LOGW(TAG, "Plugin '%s' throttled: CPU budget of %u ms/min used up",
+                     plugin->metadata.name, (unsigned)plugin->config.cpu_budget_ms);
+            ctx->stats.throttle_count++;
+        }
+        ctx->is_suspended = true;
+        ctx->suspension_reason = PIN_PLUGIN_SUSPEND_CPU_BUDGET;
+        plugin->state = PLUGIN_STATE_SUSPENDED;
+        return budget_delay;
+    }
+    
+    if (ctx->is_suspended) {
+        ctx->is_suspended = false;
+        ctx->suspension_reason = PIN_PLUGIN_SUSPEND_NONE;
+        plugin->state = PLUGIN_STATE_RUNNING;
+    }
+    
+    // Call plugin update function
+    if (plugin->update) {
+        pin_plugin_timing_t timing;
+        pin_plugin_timing_begin(ctx, &timing);
+        esp_err_t ret = plugin->update(ctx);
+        pin_plugin_record_latency(ctx, pin_plugin_timing_end(ctx, &timing));
+        
+        // Scratch only lives for one update
+        pin_plugin_update_memory_stats(ctx);
+        pin_arena_scratch_reset(&ctx->arena);
+        pin_plugin_update_memory_stats(ctx);
+        
+        if (ret != ESP_OK) {
+            plugin->error_count++;
+            ctx->stats.error_count++;
+            
+            if (plugin->error_count >= PIN_PLUGIN_MAX_ERRORS) {
+                ESP_LOGE(TAG, "Plugin '%s' disabled due to too many errors", plugin->metadata.name);
+                portENTER_CRITICAL(&g_plugin_manager.run_lock);
+                plugin->running = false;
+                portEXIT_CRITICAL(&g_plugin_manager.run_lock);
+                plugin->state = PLUGIN_STATE_ERROR;
+                
+                // The manager task tears it down like any disable, returning its arena to the pool
+                pin_plugin_message_t message = { .type = PLUGIN_MSG_DISABLE };
+                strncpy(message.plugin_name, plugin->metadata.name, sizeof(message.plugin_name) - 1);
+                if (xQueueSend(g_plugin_manager.message_queue, &message, 0) != pdTRUE) {
+                    ESP_LOGE(TAG, "Plugin '%s' stays allocated, manager queue full", plugin->metadata.name);
+                }
+                return 0;
+            }
+        } else {
+            plugin->error_count = 0;  // Reset error count on success
+            ctx->stats.update_count++;
+            pin_plugin_save_retained(plugin);
+        }
+    }
+    
+    plugin->last_update_time = (uint32_t)(esp_timer_get_time() / 1000);
+    
+    // Next cycle according to configured update interval
+    uint32_t interval = plugin->config.update_interval > 0 ? plugin->config.update_interval : 60;
+    return interval * 1000;
+}
+
+/**
+ * Record the next update deadline and hand it to whoever runs the plugin.
+ * A deadline of 0 leaves the plugin idle until it schedules again.
+ */
+static esp_err_t pin_plugin_arm(pin_plugin_context_t* ctx, int64_t deadline_us, uint32_t tolerance_ms) {
+    pin_plugin_t* plugin = ctx->plugin;
+    
+    ctx->schedule.deadline_us = deadline_us;
+    ctx->schedule.tolerance_ms = tolerance_ms;
+    
+    if (!plugin->running) {
+        // Called from init/start, pin_plugin_enable() picks the deadline up
+        return ESP_OK;
+    }
+    
+    if (plugin->config.blocking) {
+        // Wake the plugin task so it re-reads its deadline
+        if (plugin->plugin_task && plugin->plugin_task != xTaskGetCurrentTaskHandle()) {
+            xTaskNotifyGive(plugin->plugin_task);
+        }
+        return ESP_OK;
+    }
+    
+    if (deadline_us == 0) {
+        esp_err_t ret = pin_scheduler_remove(plugin->plugin_id);
+        return ret == ESP_ERR_NOT_FOUND ? ESP_OK : ret;
+    }
+    
+    return pin_scheduler_add(plugin->plugin_id, deadline_us, (int64_t)tolerance_ms * 1000);
+}
+
+static uint32_t pin_plugin_interval_tolerance(uint32_t delay_ms) {
+    return delay_ms / 100 * PIN_PLUGIN_DEFAULT_TOLERANCE_PCT;
+}
+
+static void pin_plugin_dispatch_one(uint8_t plugin_id) {
+    if (plugin_id >= g_plugin_manager.plugin_count) {
+        return;
+    }
+    
+    pin_plugin_t* plugin = g_plugin_manager.plugins[plugin_id];
+    pin_plugin_context_t* ctx = &g_plugin_manager.contexts[plugin_id];
+    if (!pin_plugin_enter(plugin, ctx)) {
+        return;
+    }
+    
+    // The worker is shared, so expose this plugin's context only for the call
+    ctx->schedule.requested = false;
+    vTaskSetThreadLocalStoragePointer(NULL, 0, ctx);
+    uint32_t delay_ms = pin_plugin_run_update(plugin, ctx);
+    vTaskSetThreadLocalStoragePointer(NULL, 0, NULL);
+    
+    // Fall back to update_interval unless the plugin scheduled (or cancelled) itself
+    if (delay_ms > 0 && plugin->running && !ctx->schedule.requested) {
+        pin_plugin_arm(ctx, esp_timer_get_time() + (int64_t)delay_ms * 1000,
+                       pin_plugin_interval_tolerance(delay_ms));
+    }
+    pin_plugin_leave(ctx);
+}
+
+static void pin_plugin_batch_begin(void) {
+    g_plugin_manager.batch_refresh_pending = false;
+    g_plugin_manager.batch_net_tried = false;
+    g_plugin_manager.batch_task = xTaskGetCurrentTaskHandle();
+}
+
+static void pin_plugin_batch_end(void) {
+    g_plugin_manager.batch_task = NULL;
+    
+    // Every plugin in the batch has fetched, the radio may go down
+    if (g_plugin_manager.batch_net_tried && g_plugin_manager.batch_net_result == ESP_OK) {
+        pin_netwin_release();
+    }
+    g_plugin_manager.batch_net_tried = false;
+    
+    // One partial refresh covers every widget drawn in this batch
+    if (g_plugin_manager.batch_refresh_pending) {
+        g_plugin_manager.batch_refresh_pending = false;
+        esp_err_t ret = pin_display_refresh(PIN_REFRESH_PARTIAL);
+        if (ret != ESP_OK) {
+            // The refresh bumped the panel generation, so every widget in the batch redraws next time
+            ESP_LOGW(TAG, "Batch refresh failed: %s", esp_err_to_name(ret));
+        }
+    }
+}
+
+static void pin_plugin_dispatch(const uint8_t* ids, uint8_t count) {
+    pin_plugin_batch_begin();
+    for (uint8_t i = 0; i < count; i++) {
+        pin_plugin_dispatch_one(ids[i]);
+    }
+    pin_plugin_batch_end();
+    
+    // The batch moved its deadlines, which may make deep sleep worthwhile
+    pin_sleep_plan_changed();
+}
+
+static void pin_plugin_poll_events(void) {
+    // Handlers woken by the same burst of events share one refresh
+    pin_plugin_batch_begin();
+    pin_event_bus_dispatch();
+    pin_plugin_batch_end();
+}
+
+static void pin_plugin_deliver_event(uint8_t plugin_id, void (*callback)(const char* data), const char* data) {
+    if (plugin_id >= g_plugin_manager.plugin_count) {
+        return;
+    }
+    
+    pin_plugin_t* plugin = g_plugin_manager.plugins[plugin_id];
+    pin_plugin_context_t* ctx = &g_plugin_manager.contexts[plugin_id];
+    if (!pin_plugin_enter(plugin, ctx)) {
+        return;
+    }
+    
+    if (plugin->config.blocking) {
+        // Its task may be inside update() on the same arena, let the task run the callback
+        pin_plugin_event_t event = { .callback = callback };
+        strncpy(event.data, data, sizeof(event.data) - 1);
+        if (xQueueSend(g_plugin_manager.event_queues[plugin_id], &event, 0) != pdTRUE) {
+            ESP_LOGW(TAG, "Event queue of plugin '%s' is full, dropping event", plugin->metadata.name);
+        }
+        // Under the lock so the task cannot exit between the check and the notify
+        portENTER_CRITICAL(&g_plugin_manager.run_lock);
+        if (plugin->plugin_task) {
+            xTaskNotifyGive(plugin->plugin_task);
+        }
+        portEXIT_CRITICAL(&g_plugin_manager.run_lock);
+        pin_plugin_leave(ctx);
+        return;
+    }
+    
+    pin_plugin_timing_t timing;
+    vTaskSetThreadLocalStoragePointer(NULL, 0, ctx);
+    pin_plugin_timing_begin(ctx, &timing);
+    callback(data);
+    pin_plugin_timing_end(ctx, &timing);
+    vTaskSetThreadLocalStoragePointer(NULL, 0, NULL);
+    
+    pin_plugin_update_memory_stats(ctx);
+    pin_arena_scratch_reset(&ctx->arena);
+    pin_plugin_update_memory_stats(ctx);
+    pin_plugin_leave(ctx);
+}
+
+// Run the event callbacks queued for a blocking plugin; runs on the plugin's task
+static void pin_plugin_drain_events(pin_plugin_t* plugin, pin_plugin_context_t* ctx) {
+    pin_plugin_event_t event;
+    while (plugin->running &&
+           xQueueReceive(g_plugin_manager.event_queues[plugin->plugin_id], &event, 0) == pdTRUE) {
+        pin_plugin_timing_t timing;
+        pin_plugin_timing_begin(ctx, &timing);
+        event.callback(event.data);
+        pin_plugin_timing_end(ctx, &timing);
+        
+        pin_plugin_update_memory_stats(ctx);
+        pin_arena_scratch_reset(&ctx->arena);
+        pin_plugin_update_memory_stats(ctx);
+    }
+}
+
+// Drop a blocking plugin's event queue once its task and deliveries are gone
+static void pin_plugin_close_events(pin_plugin_t* plugin) {
+    QueueHandle_t queue = g_plugin_manager.event_queues[plugin->plugin_id];
+    g_plugin_manager.event_queues[plugin->plugin_id] = NULL;
+    if (queue) {
+        vQueueDelete(queue);
+    }
+}
+
+// Claim the plugin for a callback on this task; fails once it is being disabled
+static bool pin_plugin_enter(pin_plugin_t* plugin, pin_plugin_context_t* ctx) {
+    portENTER_CRITICAL(&g_plugin_manager.run_lock);
+    bool running = plugin->running;
+    if (running) {
+        ctx->busy_task = xTaskGetCurrentTaskHandle();
+    }
+    portEXIT_CRITICAL(&g_plugin_manager.run_lock);
+    return running;
+}
+
+static void pin_plugin_leave(pin_plugin_context_t* ctx) {
+    portENTER_CRITICAL(&g_plugin_manager.run_lock);
+    ctx->busy_task = NULL;
+    portEXIT_CRITICAL(&g_plugin_manager.run_lock);
+}
+
 static void pin_plugin_task_wrapper(void* pvParameters) {
     pin_plugin_t* plugin = (pin_plugin_t*)pvParameters;
     pin_plugin_context_t* ctx = &g_plugin_manager.contexts[plugin->plugin_id];
@@ -335,41 +994,38 @@ static void pin_plugin_task_wrapper(void* pvParameters) {
     vTaskSetThreadLocalStoragePointer(NULL, 0, ctx);
     
     while (plugin->running) {
-        // Check resource limits
-        if (pin_plugin_check_resources(ctx) != ESP_OK) {
-            ESP_LOGW(TAG, "Plugin '%s' suspended due to resource limits", plugin->metadata.name);
-            ctx->is_suspended = true;
-            plugin->state = PLUGIN_STATE_SUSPENDED;
-            vTaskDelay(pdMS_TO_TICKS(60000));  // Sleep for 1 minute
+        // Event callbacks wake the task the same way a reschedule does
+        pin_plugin_drain_events(plugin, ctx);
+        
+        // Sleep until the deadline, re-reading it whenever the plugin reschedules
+        int64_t deadline_us = ctx->schedule.deadline_us;
+        if (deadline_us == 0) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
             continue;
         }
-        
-        // Call plugin update function
-        if (plugin->update) {
-            esp_err_t ret = plugin->update(ctx);
-            if (ret != ESP_OK) {
-                plugin->error_count++;
-                ctx->stats.error_count++;
-                
-                if (plugin->error_count >= PIN_PLUGIN_MAX_ERRORS) {
-                    ESP_LOGE(TAG, "Plugin '%s' disabled due to too many errors", plugin->metadata.name);
-                    plugin->enabled = false;
-                    plugin->state = PLUGIN_STATE_ERROR;
-                    break;
-                }
-            } else {
-                plugin->error_count = 0;  // Reset error count on success
-                ctx->stats.update_count++;
-            }
+        int64_t delta_us = deadline_us - esp_timer_get_time();
+        if (delta_us > 0) {
+            TickType_t wait = pdMS_TO_TICKS((delta_us + 999) / 1000);
+            ulTaskNotifyTake(pdTRUE, wait > 0 ? wait : 1);
+            continue;
         }
         
-        // Sleep according to configured update interval
-        uint32_t interval = plugin->config.update_interval > 0 ? plugin->config.update_interval : 60;
-        vTaskDelay(pdMS_TO_TICKS(interval * 1000));
+        ctx->schedule.requested = false;
+        uint32_t delay_ms = pin_plugin_run_update(plugin, ctx);
+        if (delay_ms == 0) {
+            break;
+        }
+        if (!ctx->schedule.requested) {
+            ctx->schedule.deadline_us = esp_timer_get_time() + (int64_t)delay_ms * 1000;
+        }
+        pin_sleep_plan_changed();
     }
     
     ESP_LOGI(TAG, "Plugin '%s' task stopped", plugin->metadata.name);
+    // pin_plugin_enable(false) waits for this before tearing the plugin down
+    portENTER_CRITICAL(&g_plugin_manager.run_lock);
     plugin->plugin_task = NULL;
+    portEXIT_CRITICAL(&g_plugin_manager.run_lock);
     vTaskDelete(NULL);
 }
 
@@ -391,6 +1047,9 @@ static void pin_plugin_manager_task(void* pvParameters) {
                 case PLUGIN_MSG_CONFIG_CHANGED:
                     //pin_plugin_set_config(message.plugin_name, message.key, message.value);
                     break;
+                case PLUGIN_MSG_FLUSH_CONFIG:
+                    pin_plugin_flush_config();
+                    break;
                 case PLUGIN_MSG_SHUTDOWN:
                     ESP_LOGI(TAG, "Plugin manager shutting down");
                     goto exit;
@@ -408,30 +1067,78 @@ exit:
     vTaskDelete(NULL);
 }
 
+/**
+ * Check whether an update can run: enough free heap for the HTTP and display
+ * work it does, and a battery that is not low. Both recover on their own.
+ * The arena needs no check: it refuses allocations past memory_limit, and a
+ * plugin suspended for a full arena could never run to free it. API rates
+ * are enforced per call by the token buckets.
+ */
 static esp_err_t pin_plugin_check_resources(pin_plugin_context_t* ctx) {
-    // Check memory usage
-    if (ctx->stats.memory_used > ctx->plugin->config.memory_limit) {
-        ESP_LOGW(TAG, "Plugin '%s' memory limit exceeded: %d/%d", 
-                 ctx->plugin->metadata.name, ctx->stats.memory_used, ctx->plugin->config.memory_limit);
+    if (esp_get_free_heap_size() < PIN_PLUGIN_MIN_FREE_HEAP) {
         return ESP_ERR_NO_MEM;
     }
     
-    // Check API call rate
-    uint64_t now = esp_timer_get_time() / 1000;  // Convert to milliseconds
-    if (now - 0 > 60000) {  // Reset every minute
-        ctx->stats.api_calls_count = 0;
-        
-    }
-    
-    if (ctx->stats.api_calls_count > ctx->plugin->config.api_rate_limit) {
-        ESP_LOGW(TAG, "Plugin '%s' API rate limit exceeded: %d/%d", 
-                 ctx->plugin->metadata.name, ctx->stats.api_calls_count, ctx->plugin->config.api_rate_limit);
+    if (pin_power_is_battery_low()) {
         return ESP_ERR_INVALID_STATE;
     }
     
     return ESP_OK;
 }
 
+static inline uint32_t pin_plugin_rate_limit(const pin_plugin_context_t* ctx) {
+    return ctx->plugin->config.api_rate_limit > 0 ?
+           ctx->plugin->config.api_rate_limit : PIN_PLUGIN_API_RATE_LIMIT;
+}
+
+static inline uint32_t pin_plugin_rate_capacity(uint32_t rate_per_min) {
+    // Burst of a few seconds worth of calls, but always enough for the handful
+    // of default config writes an init makes even at a rate of a call per minute
+    uint32_t capacity = rate_per_min * 1000 / 60 * PIN_PLUGIN_RATE_BURST_SECONDS;
+    return capacity > PIN_PLUGIN_RATE_MIN_BURST * 1000 ? capacity : PIN_PLUGIN_RATE_MIN_BURST * 1000;
+}
+
+static void pin_plugin_reset_rate_limits(pin_plugin_context_t* ctx) {
+    uint32_t capacity = pin_plugin_rate_capacity(pin_plugin_rate_limit(ctx));
+    int64_t now = esp_timer_get_time();
+    for (int i = 0; i < PIN_PLUGIN_API_CLASS_COUNT; i++) {
+        ctx->rate_buckets[i].tokens = capacity;
+        ctx->rate_buckets[i].last_refill_us = now;
+    }
+}
+
+/**
+ * Take one call from the plugin's bucket for an API class. Buckets refill
+ * continuously at api_rate_limit calls per minute.
+ */
+static inline bool pin_plugin_take_token(pin_plugin_context_t* ctx, pin_plugin_api_class_t api_class) {
+    uint32_t rate = pin_plugin_rate_limit(ctx);
+    uint32_t capacity = pin_plugin_rate_capacity(rate);
+    int64_t now = esp_timer_get_time();
+    
+    // Refill: rate calls per minute is rate milli-calls per 60000 us
+    uint64_t elapsed_us = (uint64_t)(now - ctx->rate_buckets[api_class].last_refill_us);
+    uint64_t refill = elapsed_us * rate / 60000;
+    if (refill > 0) {
+        uint64_t tokens = ctx->rate_buckets[api_class].tokens + refill;
+        ctx->rate_buckets[api_class].tokens = tokens < capacity ? (uint32_t)tokens : capacity;
+        ctx->rate_buckets[api_class].last_refill_us = now;
+    }
+    
+    ctx->stats.api_calls_count++;
+    
+    if (ctx->rate_buckets[api_class].tokens < 1000) {
+        if (ctx->stats.rate_limited_count++ % 16 == 0) {
+            ESP_LOGW(TAG, "Plugin '%s' API rate limit exceeded (%u/min)",
+                     ctx->plugin->metadata.name, (unsigned)rate);
+        }
+        return false;
+    }
+    
+    ctx->rate_buckets[api_class].tokens -= 1000;
+    return true;
+}
+
 esp_err_t pin_plugin_validate(pin_plugin_t* plugin) {
     if (!plugin) {
         return ESP_ERR_INVALID_ARG;
@@ -453,8 +1160,12 @@ esp_err_t pin_plugin_validate(pin_plugin_t* plugin) {
         plugin->config.memory_limit = PIN_PLUGIN_DEFAULT_MEMORY_LIMIT;
     }
     
-    if (plugin->config.memory_limit > PIN_PLUGIN_DEFAULT_MEMORY_LIMIT * 4) {
-        ESP_LOGW(TAG, "Plugin memory limit exceeds recommended size: %d", plugin->config.memory_limit);
+    // Arenas are carved from the pool, so a larger one could never be created
+    if (plugin->config.memory_limit > CONFIG_PIN_PLUGIN_HEAP_SIZE) {
+        ESP_LOGE(TAG, "Plugin '%s' memory limit of %u bytes exceeds the %u byte plugin pool",
+                 plugin->metadata.name, (unsigned)plugin->config.memory_limit,
+                 (unsigned)CONFIG_PIN_PLUGIN_HEAP_SIZE);
+        return ESP_ERR_INVALID_SIZE;
     }
     
     // Check update interval
@@ -476,39 +1187,192 @@ esp_err_t pin_plugin_validate(pin_plugin_t* plugin) {
     return ESP_OK;
 }
 
+static void pin_plugin_update_memory_stats(pin_plugin_context_t* ctx) {
+    ctx->stats.memory_used = pin_arena_used(&ctx->arena);
+    if (ctx->stats.memory_used > ctx->stats.memory_peak) {
+        ctx->stats.memory_peak = ctx->stats.memory_used;
+    }
+}
+
+static void pin_plugin_config_flush_timer(void* arg) {
+    // NVS writes belong on the manager task, not the esp_timer task
+    pin_plugin_message_t message = { .type = PLUGIN_MSG_FLUSH_CONFIG };
+    xQueueSend(g_plugin_manager.message_queue, &message, 0);
+}
+
+static void pin_plugin_config_dirty(void) {
+    if (g_plugin_manager.config_flush_timer &&
+        !esp_timer_is_active(g_plugin_manager.config_flush_timer)) {
+        esp_timer_start_once(g_plugin_manager.config_flush_timer,
+                             PIN_PLUGIN_CONFIG_FLUSH_DELAY_MS * 1000ULL);
+    }
+}
+
+esp_err_t pin_plugin_flush_config(void) {
+    esp_err_t result = ESP_OK;
+    
+    if (!g_plugin_manager.plugins_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (g_plugin_manager.config_flush_timer) {
+        esp_timer_stop(g_plugin_manager.config_flush_timer);
+    }
+    
+    xSemaphoreTake(g_plugin_manager.plugins_mutex, portMAX_DELAY);
+    for (uint8_t i = 0; i < g_plugin_manager.plugin_count; i++) {
+        pin_plugin_store_t* store = g_plugin_manager.contexts[i].config_store;
+        if (store) {
+            esp_err_t err = pin_plugin_store_flush(store);
+            if (err != ESP_OK) {
+                result = err;
+            }
+        }
+    }
+    xSemaphoreGive(g_plugin_manager.plugins_mutex);
+    
+    return result;
+}
+
+static void pin_plugin_save_retained(pin_plugin_t* plugin) {
+    if (!plugin->retained.data || plugin->retained.size == 0) {
+        return;
+    }
+    
+    // A memcpy into RTC memory, cheap enough to do after every update
+    pin_retain_save(plugin->metadata.name, plugin->retained.version,
+                    plugin->retained.data, plugin->retained.size);
+}
+
+static uint8_t pin_plugin_sleep_deadlines(pin_sleep_deadline_t* out, uint8_t max) {
+    uint8_t count = 0;
+    
+    if (!xSemaphoreTake(g_plugin_manager.plugins_mutex, pdMS_TO_TICKS(1000))) {
+        return 0;
+    }
+    
+    // Deadlines live on the esp_timer clock, which restarts after deep sleep
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    int64_t wall_now_us = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+    int64_t now_us = esp_timer_get_time();
+    
+    for (uint8_t i = 0; i < g_plugin_manager.plugin_count && count < max; i++) {
+        pin_plugin_t* plugin = g_plugin_manager.plugins[i];
+        const pin_plugin_context_t* ctx = &g_plugin_manager.contexts[i];
+        if (!plugin->running || ctx->schedule.deadline_us == 0) {
+            continue;
+        }
+        
+        pin_sleep_deadline_t* deadline = &out[count++];
+        strncpy(deadline->name, plugin->metadata.name, sizeof(deadline->name) - 1);
+        deadline->name[sizeof(deadline->name) - 1] = '\0';
+        deadline->due_us = wall_now_us + (ctx->schedule.deadline_us - now_us);
+        deadline->tolerance_ms = ctx->schedule.tolerance_ms;
+    }
+    xSemaphoreGive(g_plugin_manager.plugins_mutex);
+    
+    return count;
+}
+
+// Undo a failed pin_plugin_enable() once the arena and config store exist
+static void pin_plugin_abort_enable(pin_plugin_t* plugin, pin_plugin_context_t* ctx, bool started) {
+    // An event may already be on its way in, let it finish first
+    portENTER_CRITICAL(&g_plugin_manager.run_lock);
+    plugin->running = false;
+    portEXIT_CRITICAL(&g_plugin_manager.run_lock);
+    while (ctx->busy_task) {
+        vTaskDelay(pdMS_TO_TICKS(PIN_PLUGIN_STOP_POLL_MS));
+    }
+    
+    void* prev_ctx = pvTaskGetThreadLocalStoragePointer(NULL, 0);
+    vTaskSetThreadLocalStoragePointer(NULL, 0, ctx);
+    if (started && plugin->stop) {
+        plugin->stop(ctx);
+    }
+    if (plugin->initialized && plugin->cleanup) {
+        plugin->cleanup(ctx);
+    }
+    vTaskSetThreadLocalStoragePointer(NULL, 0, prev_ctx);
+    
+    plugin->enabled = false;
+    plugin->initialized = false;
+    plugin->private_data = NULL;
+    plugin->state = PLUGIN_STATE_ERROR;
+    pin_plugin_close_events(plugin);
+    pin_plugin_release_arena(ctx);
+    
+    // Detach under the list lock like pin_plugin_enable(false) does
+    pin_plugin_store_t* store = NULL;
+    if (xSemaphoreTake(g_plugin_manager.plugins_mutex, portMAX_DELAY)) {
+        store = ctx->config_store;
+        ctx->config_store = NULL;
+        xSemaphoreGive(g_plugin_manager.plugins_mutex);
+    }
+    pin_plugin_store_close(store);
+}
+
+static void pin_plugin_release_arena(pin_plugin_context_t* ctx) {
+    // Everything the plugin allocated lives in the arena, including widget content
+    pin_arena_destroy(&ctx->arena);
+    ctx->widget_region.content = NULL;
+    ctx->drawn.valid = false;
+    ctx->stats.memory_used = 0;
+}
+
 void* pin_plugin_malloc(pin_plugin_context_t* ctx, size_t size) {
     if (!ctx || size == 0) {
         return NULL;
     }
     
-    if (ctx->stats.memory_used + size > ctx->plugin->config.memory_limit) {
-        ESP_LOGW(TAG, "Plugin '%s' memory allocation failed: would exceed limit", 
-                 ctx->plugin->metadata.name);
+    void* ptr = pin_arena_alloc(&ctx->arena, size);
+    if (!ptr) {
+        ESP_LOGW(TAG, "Plugin '%s' memory allocation of %u bytes failed: %u/%u used", 
+                 ctx->plugin->metadata.name, (unsigned)size,
+                 (unsigned)ctx->stats.memory_used, (unsigned)ctx->arena.size);
         return NULL;
     }
     
-    void* ptr = malloc(size);
-    if (ptr) {
-        ctx->stats.memory_used += size;
-        ctx->stats.memory_peak = ctx->stats.memory_peak > ctx->stats.memory_used ? 
-                                 ctx->stats.memory_peak : ctx->stats.memory_used;
+    pin_plugin_update_memory_stats(ctx);
+    return ptr;
+}
+
+void pin_plugin_free(pin_plugin_context_t* ctx, void* ptr) {
+    if (ptr && ctx) {
+        pin_arena_free(&ctx->arena, ptr);
+        pin_plugin_update_memory_stats(ctx);
+    }
+}
+
+char* pin_plugin_strdup(pin_plugin_context_t* ctx, const char* str) {
+    if (!str) {
+        return NULL;
     }
     
-    return ptr;
+    size_t len = strlen(str);
+    char* copy = (char*)pin_plugin_malloc(ctx, len + 1);
+    if (copy) {
+        memcpy(copy, str, len + 1);
+    }
+    return copy;
 }
 
-void pin_plugin_free(pin_plugin_context_t* ctx, void* ptr, size_t size) {
-    if (ptr && ctx && size > 0) {
-        free(ptr);
-        if (ctx->stats.memory_used >= size) {
-            ctx->stats.memory_used -= size;
-        } else {
-            ctx->stats.memory_used = 0;
-        }
+void* pin_plugin_scratch_alloc(pin_plugin_context_t* ctx, size_t size) {
+    if (!ctx || size == 0) {
+        return NULL;
     }
+    
+    void* ptr = pin_arena_scratch_alloc(&ctx->arena, size);
+    if (!ptr) {
+        ESP_LOGW(TAG, "Plugin '%s' scratch allocation of %u bytes failed", 
+                 ctx->plugin->metadata.name, (unsigned)size);
+        return NULL;
+    }
+    
+    pin_plugin_update_memory_stats(ctx);
+    return ptr;
 }
 
-// API Implementation functions
 static esp_err_t plugin_api_log_info(const char* tag, const char* format, ...) {
     va_list args;
     va_start(args, format);
@@ -552,153 +1416,290 @@ static esp_err_t plugin_api_get_time_string(char* time_str, size_t max_len, cons
     return ESP_OK;
 }
 
-// Stub implementations for other API functions
-static esp_err_t plugin_api_http_get(const char* url, char* response, size_t max_len) {
-    if (!url || !response || max_len == 0) {
-        return ESP_ERR_INVALID_ARG;
+// Hosts plugins may reach; the URL host must match an entry exactly
+static const char* const g_allowed_domains[] = {
+    "api.github.com",
+    "httpbin.org",
+    "jsonplaceholder.typicode.com",
+    "api.openweathermap.org",
+    NULL
+};
+
+static bool plugin_url_allowed(const char* url) {
+    const char* host = url ? strstr(url, "://") : NULL;
+    if (!host) {
+        return false;
+    }
+    host += 3;
+    size_t host_len = strcspn(host, ":/?#");
+    
+    for (int i = 0; g_allowed_domains[i] != NULL; i++) {
+        size_t len = strlen(g_allowed_domains[i]);
+        if (host_len == len && strncmp(host, g_allowed_domains[i], len) == 0) {
+            return true;
+        }
     }
-    
-    // Simple domain whitelist for security
-    const char* allowed_domains[] = {
-        "api.github.com",
-        "httpbin.org",
-        "jsonplaceholder.typicode.com",
-        NULL
-    };
-    
-    // Extract domain from URL
-    const char* domain_start = strstr(url, "://");
-    if (!domain_start) {
-        ESP_LOGE(TAG, "Invalid URL format");
-        return ESP_ERR_INVALID_ARG;
+    return false;
+}
+
+static void plugin_http_set_header(esp_http_client_handle_t client, const char* key, const char* value) {
+    // Pooled clients keep request headers between requests, so clear what is unused
+    if (value && value[0]) {
+        esp_http_client_set_header(client, key, value);
+    } else {
+        esp_http_client_delete_header(client, key);
     }
-    domain_start += 3; // Skip "://"
-    
-    // Check if domain is whitelisted
-    bool domain_allowed = false;
-    for (int i = 0; allowed_domains[i] != NULL; i++) {
-        if (strncmp(domain_start, allowed_domains[i], strlen(allowed_domains[i])) == 0) {
-            domain_allowed = true;
-            break;
+}
+
+// Collects a response into the caller's buffer, truncating what does not fit
+typedef struct {
+    char* buffer;
+    size_t max_len;
+    size_t len;
+} plugin_http_buffer_t;
+
+static esp_err_t plugin_http_buffer_sink(const char* data, size_t len, void* arg) {
+    plugin_http_buffer_t* out = (plugin_http_buffer_t*)arg;
+    size_t room = out->max_len - 1 - out->len;
+    size_t n = len < room ? len : room;
+    memcpy(out->buffer + out->len, data, n);
+    out->len += n;
+    out->buffer[out->len] = '\0';
+    return ESP_OK;
+}
+
+// Bring the radio up for a request. Within a batch the first request opens
+// one window for the whole batch (and one failed connect is not retried by
+// every plugin); it is closed by pin_plugin_batch_end()
+static esp_err_t plugin_net_begin(void) {
+    if (g_plugin_manager.batch_task != xTaskGetCurrentTaskHandle()) {
+        return pin_netwin_acquire(PIN_NETWIN_CONNECT_TIMEOUT_MS);
+    }
+    if (!g_plugin_manager.batch_net_tried) {
+        g_plugin_manager.batch_net_tried = true;
+        g_plugin_manager.batch_net_result = pin_netwin_acquire(PIN_NETWIN_CONNECT_TIMEOUT_MS);
+    }
+    return g_plugin_manager.batch_net_result;
+}
+
+static void plugin_net_end(void) {
+    if (g_plugin_manager.batch_task != xTaskGetCurrentTaskHandle()) {
+        pin_netwin_release();
+    }
+}
+
+// One request on a pooled client. The body is read through open/fetch/read
+// (perform() consumes the body itself, leaving nothing for read()) and
+// passed to sink chunk by chunk. GET responses go through the HTTP cache;
+// cache_ttl is the freshness used when the server sends no max-age
+static esp_err_t plugin_http_exchange(esp_http_client_method_t method, const char* url, const char* body,
+                                      int timeout_ms, uint32_t cache_ttl,
+                                      pin_http_cache_sink_t sink, void* sink_arg) {
+    bool cacheable = method == HTTP_METHOD_GET;
+    pin_http_cache_headers_t validators;
+    bool conditional = cacheable && pin_http_cache_get_validators(url, &validators);
+    
+    int body_len = body ? strlen(body) : 0;
+    esp_err_t err = ESP_FAIL;
+    
+    // A pooled connection may have been closed by the server; retry once on a fresh one
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool reused = false;
+        esp_http_client_handle_t client = pin_http_pool_acquire(url, timeout_ms, &reused);
+        if (!client) {
+            return ESP_ERR_NO_MEM;
+        }
+        
+        pin_http_cache_headers_t received;
+        pin_http_cache_headers_reset(&received);
+        esp_http_client_set_user_data(client, &received);
+        
+        esp_http_client_set_method(client, method);
+        plugin_http_set_header(client, "Content-Type", body ? "application/json" : NULL);
+        plugin_http_set_header(client, "If-None-Match", conditional ? validators.etag : NULL);
+        plugin_http_set_header(client, "If-Modified-Since", conditional ? validators.last_modified : NULL);
+        
+        // Full clock for the handshake and upload, not while the server thinks
+        bool sent = false;
+        pin_power_acquire(PIN_POWER_CLIENT_HTTP);
+        err = esp_http_client_open(client, body_len);
+        if (err == ESP_OK && body_len > 0 &&
+            esp_http_client_write(client, body, body_len) != body_len) {
+            err = ESP_FAIL;
         }
+        pin_power_release(PIN_POWER_CLIENT_HTTP);
+        if (err == ESP_OK) {
+            sent = true;
+            if (esp_http_client_fetch_headers(client) < 0) {
+                err = ESP_FAIL;
+            }
+        }
+        
+        if (err != ESP_OK) {
+            esp_http_client_set_user_data(client, NULL);
+            pin_http_pool_release(client, false);
+            // Only retry requests that never reached a live server
+            if (reused && (!sent || method == HTTP_METHOD_GET)) {
+                continue;
+            }
+            return err;
+        }
+        
+        pin_power_acquire(PIN_POWER_CLIENT_HTTP);
+        int status = esp_http_client_get_status_code(client);
+        
+        if (status == 304 && conditional) {
+            // Not modified: the cached body is the answer
+            err = pin_http_cache_revalidated(url, &received, cache_ttl, sink, sink_arg);
+        } else {
+            bool store = cacheable && status == 200;
+            pin_http_cache_body_t copy = {0};
+            char chunk[PIN_PLUGIN_HTTP_CHUNK_SIZE];
+            
+            while (1) {
+                int n = esp_http_client_read(client, chunk, sizeof(chunk));
+                if (n < 0) {
+                    err = ESP_FAIL;
+                }
+                if (n <= 0) {
+                    break;
+                }
+                if (store) {
+                    pin_http_cache_body_append(&copy, chunk, n);
+                }
+                err = sink(chunk, n, sink_arg);
+                if (err != ESP_OK) {
+                    break;
+                }
+            }
+            
+            if (err == ESP_OK && store && esp_http_client_is_complete_data_received(client)) {
+                pin_http_cache_store(url, &received, cache_ttl, copy.overflow ? NULL : copy.data, copy.len);
+            }
+            pin_http_cache_body_free(&copy);
+        }
+        
+        esp_http_client_set_user_data(client, NULL);
+        
+        // A consumer that stopped early leaves unread data: drop the connection then
+        bool keep_alive = err == ESP_OK && esp_http_client_flush_response(client, NULL) == ESP_OK;
+        pin_http_pool_release(client, keep_alive);
+        pin_power_release(PIN_POWER_CLIENT_HTTP);
+        return err;
     }
     
-    if (!domain_allowed) {
+    return err;
+}
+
+static esp_err_t plugin_http_request(esp_http_client_method_t method, const char* url, const char* body,
+                                     int timeout_ms, uint32_t cache_ttl,
+                                     pin_http_cache_sink_t sink, void* sink_arg) {
+    if (!plugin_url_allowed(url)) {
         ESP_LOGW(TAG, "Domain not in whitelist: %s", url);
         return ESP_ERR_NOT_ALLOWED;
     }
     
-    esp_http_client_config_t config = {
-        .url = url,
-        .method = HTTP_METHOD_GET,
-        .timeout_ms = 5000,
-    };
-    
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (!client) {
-        return ESP_ERR_NO_MEM;
-    }
-    
-    esp_err_t err = esp_http_client_perform(client);
-    if (err == ESP_OK) {
-        int content_length = esp_http_client_read(client, response, max_len - 1);
-        if (content_length >= 0) {
-            response[content_length] = '\0';
-        } else {
-            err = ESP_FAIL;
-        }
+    esp_err_t err = plugin_net_begin();
+    if (err != ESP_OK) {
+        return err;
     }
-    
-    esp_http_client_cleanup(client);
+    err = plugin_http_exchange(method, url, body, timeout_ms, cache_ttl, sink, sink_arg);
+    plugin_net_end();
     return err;
 }
 
-static esp_err_t plugin_api_http_post(const char* url, const char* data, char* response, size_t max_len) {
-    if (!url || !data || !response || max_len == 0) {
+static esp_err_t plugin_http_get(const char* url, uint32_t cache_ttl, char* response, size_t max_len) {
+    if (!url || !response || max_len == 0) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    // Use same domain whitelist as GET
-    const char* allowed_domains[] = {
-        "api.github.com",
-        "httpbin.org", 
-        "jsonplaceholder.typicode.com",
-        NULL
-    };
-    
-    // Extract and validate domain
-    const char* domain_start = strstr(url, "://");
-    if (!domain_start) {
+    plugin_http_buffer_t out = { .buffer = response, .max_len = max_len };
+    response[0] = '\0';
+    return plugin_http_request(HTTP_METHOD_GET, url, NULL, 5000, cache_ttl, plugin_http_buffer_sink, &out);
+}
+
+static esp_err_t plugin_http_post(const char* url, const char* data, char* response, size_t max_len) {
+    if (!url || !data || !response || max_len == 0) {
         return ESP_ERR_INVALID_ARG;
     }
-    domain_start += 3;
     
-    bool domain_allowed = false;
-    for (int i = 0; allowed_domains[i] != NULL; i++) {
-        if (strncmp(domain_start, allowed_domains[i], strlen(allowed_domains[i])) == 0) {
-            domain_allowed = true;
-            break;
+    plugin_http_buffer_t out = { .buffer = response, .max_len = max_len };
+    response[0] = '\0';
+    return plugin_http_request(HTTP_METHOD_POST, url, data, 10000, 0, plugin_http_buffer_sink, &out);
+}
+
+// HTTP thunks: time spent waiting on the network is charged as blocked, not CPU.
+// A fresh cached response costs neither radio time nor a rate-limit token
+static esp_err_t plugin_api_http_get(const char* url, char* response, size_t max_len) {
+    pin_plugin_context_t* ctx = (pin_plugin_context_t*)pvTaskGetThreadLocalStoragePointer(NULL, 0);
+    if (response && max_len > 0 && plugin_url_allowed(url)) {
+        plugin_http_buffer_t out = { .buffer = response, .max_len = max_len };
+        if (pin_http_cache_get_fresh(url, plugin_http_buffer_sink, &out) == ESP_OK) {
+            return ESP_OK;
         }
     }
-    
-    if (!domain_allowed) {
-        ESP_LOGW(TAG, "Domain not in whitelist for POST: %s", url);
-        return ESP_ERR_NOT_ALLOWED;
+    if (ctx && !pin_plugin_take_token(ctx, PIN_PLUGIN_API_HTTP)) {
+        return PIN_PLUGIN_ERR_RATE_LIMITED;
     }
-    
-    esp_http_client_config_t config = {
-        .url = url,
-        .method = HTTP_METHOD_POST,
-        .timeout_ms = 10000,
-    };
-    
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (!client) {
-        return ESP_ERR_NO_MEM;
+    uint32_t cache_ttl = ctx ? ctx->plugin->config.http_cache_ttl : 0;
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = plugin_http_get(url, cache_ttl, response, max_len);
+    if (ctx) {
+        ctx->stats.blocked_http_us += esp_timer_get_time() - start_us;
     }
-    
-    esp_http_client_set_header(client, "Content-Type", "application/json");
-    esp_http_client_set_post_field(client, data, strlen(data));
-    
-    esp_err_t err = esp_http_client_perform(client);
-    if (err == ESP_OK) {
-        int content_length = esp_http_client_read(client, response, max_len - 1);
-        if (content_length >= 0) {
-            response[content_length] = '\0';
-        } else {
-            err = ESP_FAIL;
+    return ret;
+}
+
+static esp_err_t plugin_api_http_get_stream(const char* url, pin_plugin_http_chunk_cb_t on_chunk, void* user_data) {
+    if (!url || !on_chunk) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pin_plugin_context_t* ctx = (pin_plugin_context_t*)pvTaskGetThreadLocalStoragePointer(NULL, 0);
+    if (plugin_url_allowed(url)) {
+        esp_err_t cached = pin_http_cache_get_fresh(url, on_chunk, user_data);
+        if (cached != ESP_ERR_NOT_FOUND) {
+            return cached;
         }
     }
-    
-    esp_http_client_cleanup(client);
-    return err;
+    if (ctx && !pin_plugin_take_token(ctx, PIN_PLUGIN_API_HTTP)) {
+        return PIN_PLUGIN_ERR_RATE_LIMITED;
+    }
+    uint32_t cache_ttl = ctx ? ctx->plugin->config.http_cache_ttl : 0;
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = plugin_http_request(HTTP_METHOD_GET, url, NULL, 5000, cache_ttl, on_chunk, user_data);
+    if (ctx) {
+        ctx->stats.blocked_http_us += esp_timer_get_time() - start_us;
+    }
+    return ret;
 }
 
+static esp_err_t plugin_api_http_post(const char* url, const char* data, char* response, size_t max_len) {
+    pin_plugin_context_t* ctx = (pin_plugin_context_t*)pvTaskGetThreadLocalStoragePointer(NULL, 0);
+    if (ctx && !pin_plugin_take_token(ctx, PIN_PLUGIN_API_HTTP)) {
+        return PIN_PLUGIN_ERR_RATE_LIMITED;
+    }
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = plugin_http_post(url, data, response, max_len);
+    if (ctx) {
+        ctx->stats.blocked_http_us += esp_timer_get_time() - start_us;
+    }
+    return ret;
+}
+
+// Config thunks: reads and writes hit the plugin's in-RAM store; writes
+// reach NVS in one batched commit a few seconds later
 static esp_err_t plugin_api_config_get(const char* key, char* value, size_t max_len) {
     if (!key || !value || max_len == 0) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    // Get current plugin context to create scoped key
+    // A RAM lookup, so reads cost no token; only writes reach NVS
     pin_plugin_context_t* ctx = (pin_plugin_context_t*)pvTaskGetThreadLocalStoragePointer(NULL, 0);
-    if (!ctx || !ctx->plugin) {
+    if (!ctx || !ctx->config_store) {
         return ESP_ERR_INVALID_STATE;
     }
     
-    char scoped_key[128];
-    snprintf(scoped_key, sizeof(scoped_key), "plugin_%s_%s", ctx->plugin->metadata.name, key);
-    
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open("plugins", NVS_READONLY, &nvs_handle);
-    if (err != ESP_OK) {
-        return err;
-    }
-    
-    size_t required_size = max_len;
-    err = nvs_get_str(nvs_handle, scoped_key, value, &required_size);
-    nvs_close(nvs_handle);
-    
-    return err;
+    return pin_plugin_store_get(ctx->config_store, key, value, max_len);
 }
 
 static esp_err_t plugin_api_config_set(const char* key, const char* value) {
@@ -706,27 +1707,18 @@ static esp_err_t plugin_api_config_set(const char* key, const char* value) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    // Get current plugin context to create scoped key
     pin_plugin_context_t* ctx = (pin_plugin_context_t*)pvTaskGetThreadLocalStoragePointer(NULL, 0);
-    if (!ctx || !ctx->plugin) {
+    if (!ctx || !ctx->config_store) {
         return ESP_ERR_INVALID_STATE;
     }
-    
-    char scoped_key[128];
-    snprintf(scoped_key, sizeof(scoped_key), "plugin_%s_%s", ctx->plugin->metadata.name, key);
-    
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open("plugins", NVS_READWRITE, &nvs_handle);
-    if (err != ESP_OK) {
-        return err;
+    if (!pin_plugin_take_token(ctx, PIN_PLUGIN_API_CONFIG)) {
+        return PIN_PLUGIN_ERR_RATE_LIMITED;
     }
     
-    err = nvs_set_str(nvs_handle, scoped_key, value);
+    esp_err_t err = pin_plugin_store_set(ctx->config_store, key, value);
     if (err == ESP_OK) {
-        err = nvs_commit(nvs_handle);
+        pin_plugin_config_dirty();
     }
-    
-    nvs_close(nvs_handle);
     return err;
 }
 
@@ -735,30 +1727,41 @@ static esp_err_t plugin_api_config_delete(const char* key) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    // Get current plugin context to create scoped key
     pin_plugin_context_t* ctx = (pin_plugin_context_t*)pvTaskGetThreadLocalStoragePointer(NULL, 0);
-    if (!ctx || !ctx->plugin) {
+    if (!ctx || !ctx->config_store) {
         return ESP_ERR_INVALID_STATE;
     }
-    
-    char scoped_key[128];
-    snprintf(scoped_key, sizeof(scoped_key), "plugin_%s_%s", ctx->plugin->metadata.name, key);
-    
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open("plugins", NVS_READWRITE, &nvs_handle);
-    if (err != ESP_OK) {
-        return err;
+    if (!pin_plugin_take_token(ctx, PIN_PLUGIN_API_CONFIG)) {
+        return PIN_PLUGIN_ERR_RATE_LIMITED;
     }
     
-    err = nvs_erase_key(nvs_handle, scoped_key);
+    esp_err_t err = pin_plugin_store_erase(ctx->config_store, key);
     if (err == ESP_OK) {
-        err = nvs_commit(nvs_handle);
+        pin_plugin_config_dirty();
     }
-    
-    nvs_close(nvs_handle);
     return err;
 }
 
+static inline uint32_t plugin_fnv_update(uint32_t hash, const void* data, size_t len) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Everything that decides what display_update_content draws
+static uint32_t plugin_widget_state_hash(const pin_widget_region_t* region, const char* content, size_t len) {
+    uint32_t hash = plugin_fnv_update(2166136261u, content, len);
+    hash = plugin_fnv_update(hash, &region->color, sizeof(region->color));
+    hash = plugin_fnv_update(hash, &region->font_size, sizeof(region->font_size));
+    hash = plugin_fnv_update(hash, &region->x, sizeof(region->x));
+    hash = plugin_fnv_update(hash, &region->y, sizeof(region->y));
+    hash = plugin_fnv_update(hash, &region->width, sizeof(region->width));
+    hash = plugin_fnv_update(hash, &region->height, sizeof(region->height));
+    return hash;
+}
+
 static esp_err_t plugin_api_display_update_content(const char* content) {
     if (!content) {
         return ESP_ERR_INVALID_ARG;
@@ -767,6 +1770,9 @@ static esp_err_t plugin_api_display_update_content(const char* content) {
     if (!ctx) {
         return ESP_ERR_INVALID_STATE;
     }
+    if (!pin_plugin_take_token(ctx, PIN_PLUGIN_API_DISPLAY)) {
+        return PIN_PLUGIN_ERR_RATE_LIMITED;
+    }
     // Default widget region if unset
     if (ctx->widget_region.width == 0 || ctx->widget_region.height == 0) {
         ctx->widget_region.x = 20;
@@ -774,10 +1780,22 @@ static esp_err_t plugin_api_display_update_content(const char* content) {
         ctx->widget_region.width = 560;
         ctx->widget_region.height = 120;
     }
-    // Store content in context (truncate if necessary)
+    // Nothing to do if the same state is already on the panel
     size_t len = strnlen(content, 200);
-    free(ctx->widget_region.content);
-    ctx->widget_region.content = (char*)malloc(len + 1);
+    uint32_t state_hash = plugin_widget_state_hash(&ctx->widget_region, content, len);
+    uint32_t generation = pin_display_get_generation();
+    if (ctx->drawn.valid && ctx->drawn.generation != generation) {
+        // Someone else drew over the panel since
+        ctx->drawn.valid = false;
+    }
+    if (ctx->drawn.valid && ctx->drawn.state_hash == state_hash) {
+        ctx->stats.unchanged_updates++;
+        return ESP_OK;
+    }
+    
+    // Store content in the plugin's arena (truncate if necessary)
+    pin_plugin_free(ctx, ctx->widget_region.content);
+    ctx->widget_region.content = (char*)pin_plugin_malloc(ctx, len + 1);
     if (!ctx->widget_region.content) {
         return ESP_ERR_NO_MEM;
     }
@@ -807,6 +1825,7 @@ static esp_err_t plugin_api_display_update_content(const char* content) {
     }
 
     // Clear region and draw text
+    int64_t display_start_us = esp_timer_get_time();
     pin_display_draw_rect(ctx->widget_region.x,
                           ctx->widget_region.y,
                           ctx->widget_region.width,
@@ -818,10 +1837,33 @@ static esp_err_t plugin_api_display_update_content(const char* content) {
                                           ctx->widget_region.content,
                                           font,
                                           color);
-    if (ret == ESP_OK) {
-        ret = pin_display_refresh(PIN_REFRESH_PARTIAL);
+    
+    // A different string can still rasterize to the same pixels
+    uint32_t pixel_hash = 0;
+    bool have_pixels = ret == ESP_OK &&
+                       pin_display_hash_region(ctx->widget_region.x,
+                                               ctx->widget_region.y,
+                                               ctx->widget_region.width,
+                                               ctx->widget_region.height,
+                                               &pixel_hash) == ESP_OK;
+    if (have_pixels && ctx->drawn.valid && ctx->drawn.pixel_hash == pixel_hash) {
+        ctx->stats.unchanged_updates++;
+        ctx->drawn.state_hash = state_hash;
+        ctx->widget_region.dirty = false;
+    } else if (ret == ESP_OK) {
+        if (g_plugin_manager.batch_task == xTaskGetCurrentTaskHandle()) {
+            // Part of a scheduler batch, refreshed once when the batch ends
+            g_plugin_manager.batch_refresh_pending = true;
+        } else {
+            ret = pin_display_refresh(PIN_REFRESH_PARTIAL);
+        }
         ctx->widget_region.dirty = false;
+        ctx->drawn.state_hash = state_hash;
+        ctx->drawn.pixel_hash = pixel_hash;
+        ctx->drawn.generation = generation;
+        ctx->drawn.valid = have_pixels && ret == ESP_OK;
     }
+    ctx->stats.blocked_display_us += esp_timer_get_time() - display_start_us;
     return ret;
 }
 
@@ -843,24 +1885,55 @@ static esp_err_t plugin_api_display_set_font_size(uint8_t font_size) {
     return ESP_OK;
 }
 
-static esp_err_t plugin_api_schedule_update(uint32_t delay_seconds) {
-    // TODO: Implement plugin update scheduling
-    return ESP_ERR_NOT_SUPPORTED;
+static esp_err_t plugin_api_schedule_update(uint32_t delay_ms, uint32_t tolerance_ms) {
+    pin_plugin_context_t* ctx = (pin_plugin_context_t*)pvTaskGetThreadLocalStoragePointer(NULL, 0);
+    if (!ctx) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    ctx->schedule.requested = true;
+    return pin_plugin_arm(ctx, esp_timer_get_time() + (int64_t)delay_ms * 1000, tolerance_ms);
+}
+
+static esp_err_t plugin_api_schedule_update_at(time_t when, uint32_t tolerance_ms) {
+    pin_plugin_context_t* ctx = (pin_plugin_context_t*)pvTaskGetThreadLocalStoragePointer(NULL, 0);
+    if (!ctx) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // Convert wall-clock time to the monotonic esp_timer clock
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    int64_t delta_us = ((int64_t)when - tv.tv_sec) * 1000000 - tv.tv_usec;
+    if (delta_us < 0) {
+        delta_us = 0;
+    }
+    
+    ctx->schedule.requested = true;
+    return pin_plugin_arm(ctx, esp_timer_get_time() + delta_us, tolerance_ms);
 }
 
 static esp_err_t plugin_api_cancel_scheduled_update(void) {
-    // TODO: Implement plugin update cancellation
-    return ESP_ERR_NOT_SUPPORTED;
+    pin_plugin_context_t* ctx = (pin_plugin_context_t*)pvTaskGetThreadLocalStoragePointer(NULL, 0);
+    if (!ctx) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    ctx->schedule.requested = true;
+    return pin_plugin_arm(ctx, 0, 0);
 }
 
 static esp_err_t plugin_api_emit_event(const char* event_name, const char* data) {
-    // TODO: Implement event emission
-    return ESP_ERR_NOT_SUPPORTED;
+    // No context lookup: events may be emitted from timer callbacks
+    return pin_event_bus_publish(event_name, data);
 }
 
 static esp_err_t plugin_api_subscribe_event(const char* event_name, void (*callback)(const char* data)) {
-    // TODO: Implement event subscription
-    return ESP_ERR_NOT_SUPPORTED;
+    pin_plugin_context_t* ctx = (pin_plugin_context_t*)pvTaskGetThreadLocalStoragePointer(NULL, 0);
+    if (!ctx) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return pin_event_bus_subscribe(event_name, ctx->plugin->plugin_id, callback);
 }
 
 static void plugin_api_log_debug(const char* tag, const char* format, ...) {
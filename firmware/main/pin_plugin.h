@@ -5,10 +5,13 @@
 
 #pragma once
 
+#include <time.h>
 #include "esp_err.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "pin_arena.h"
+#include "pin_plugin_store.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -20,6 +23,23 @@ extern "C" {
 #define PIN_PLUGIN_AUTHOR_MAX_LEN 64
 #define PIN_PLUGIN_DESC_MAX_LEN 128
 #define PIN_PLUGIN_HOMEPAGE_MAX_LEN 256
+#define PIN_PLUGIN_LATENCY_BUCKETS 48       // Two buckets per power of two, up to ~16 s
+
+// Reasons for PLUGIN_STATE_SUSPENDED
+#define PIN_PLUGIN_SUSPEND_NONE 0
+#define PIN_PLUGIN_SUSPEND_RESOURCES 1
+#define PIN_PLUGIN_SUSPEND_CPU_BUDGET 2
+
+// Returned by API calls refused by the plugin's rate limit
+#define PIN_PLUGIN_ERR_RATE_LIMITED ESP_ERR_NOT_ALLOWED
+
+// API classes with their own rate limit bucket (config reads are free)
+typedef enum {
+    PIN_PLUGIN_API_HTTP,
+    PIN_PLUGIN_API_DISPLAY,
+    PIN_PLUGIN_API_CONFIG,
+    PIN_PLUGIN_API_CLASS_COUNT
+} pin_plugin_api_class_t;
 
 // Forward declarations
 typedef struct pin_plugin pin_plugin_t;
@@ -39,9 +59,13 @@ typedef struct {
 typedef struct {
     uint32_t memory_limit;
     uint32_t update_interval;
-    uint32_t api_rate_limit;
+    uint32_t api_rate_limit;    // Calls per minute for each API class (0 = default)
     bool auto_start;
     bool persistent;
+    bool blocking;              // Runs in its own task instead of the shared scheduler
+    uint32_t task_stack_size;   // Stack size for blocking plugins (0 = default)
+    uint32_t cpu_budget_ms;     // CPU time allowed per minute before throttling (0 = unlimited)
+    uint32_t http_cache_ttl;    // Seconds a GET response stays fresh when it has no max-age (0 = revalidate)
 } pin_plugin_config_t;
 
 // Plugin states
@@ -64,6 +88,9 @@ typedef struct {
     bool dirty;
 } pin_widget_region_t;
 
+// Receives one chunk of a streamed HTTP response body
+typedef esp_err_t (*pin_plugin_http_chunk_cb_t)(const char* data, size_t len, void* user_data);
+
 // Plugin context
 struct pin_plugin_context {
     pin_plugin_t* plugin;
@@ -79,8 +106,10 @@ struct pin_plugin_context {
         // HTTP client functions
         esp_err_t (*http_get)(const char* url, char* response, size_t response_size);
         esp_err_t (*http_post)(const char* url, const char* data, char* response, size_t response_size);
+        // Streams the body to on_chunk as it arrives; returning an error from on_chunk stops the transfer
+        esp_err_t (*http_get_stream)(const char* url, pin_plugin_http_chunk_cb_t on_chunk, void* user_data);
         
-        // Configuration management
+        // Configuration management; reads are RAM lookups and not rate limited
         esp_err_t (*config_get)(const char* key, char* value, size_t value_size);
         esp_err_t (*config_set)(const char* key, const char* value);
         esp_err_t (*config_delete)(const char* key);
@@ -102,20 +131,78 @@ struct pin_plugin_context {
         esp_err_t (*start_timer)(void* timer_handle);
         esp_err_t (*stop_timer)(void* timer_handle);
         esp_err_t (*delete_timer)(void* timer_handle);
+        
+        // Update scheduling (the next update may run up to tolerance_ms late
+        // so it can share a wakeup with other plugins)
+        esp_err_t (*schedule_update)(uint32_t delay_ms, uint32_t tolerance_ms);
+        esp_err_t (*schedule_update_at)(time_t when, uint32_t tolerance_ms);
+        esp_err_t (*cancel_scheduled_update)(void);
+        
+        // Inter-plugin events (callbacks run on the plugin executor)
+        esp_err_t (*emit_event)(const char* event_name, const char* data);
+        esp_err_t (*subscribe_event)(const char* event_name, void (*callback)(const char* data));
     } api;
     
+    // Plugin-owned memory, carved from the plugin pool while initialized
+    pin_arena_t arena;
+    
+    // Plugin config, loaded from NVS while enabled
+    pin_plugin_store_t* config_store;
+    
+    // plugin->retained was restored from before the last deep sleep
+    bool state_restored;
+    
     // Resource monitoring
     struct {
         uint32_t memory_used;
         uint32_t memory_peak;
         uint32_t api_calls_count;
+        uint32_t rate_limited_count;
         uint32_t update_count;
         uint32_t error_count;
+        
+        // Time accounting (esp_timer microseconds)
+        uint64_t cpu_time_us;           // Callbacks, minus time blocked below
+        uint64_t blocked_http_us;       // Inside http_get/http_post
+        uint64_t blocked_display_us;    // Inside display drawing and refresh
+        uint32_t update_max_us;
+        uint16_t update_latency[PIN_PLUGIN_LATENCY_BUCKETS];
+        
+        // CPU budget window
+        int64_t budget_window_start_us;
+        uint32_t budget_used_us;
+        uint32_t throttle_count;
+        uint32_t unchanged_updates;     // display_update_content calls that skipped the refresh
     } stats;
     
+    // Token buckets for rate-limited API classes, in thousandths of a call
+    struct {
+        uint32_t tokens;
+        int64_t last_refill_us;
+    } rate_buckets[PIN_PLUGIN_API_CLASS_COUNT];
+    
+    // Next update, set by the scheduling API or from update_interval
+    struct {
+        int64_t deadline_us;    // esp_timer clock, 0 = no update scheduled
+        uint32_t tolerance_ms;
+        bool requested;         // Plugin picked its own deadline this cycle
+    } schedule;
+    
+    // What display_update_content last put on the panel
+    struct {
+        uint32_t state_hash;    // Content, color, font and bounds
+        uint32_t pixel_hash;    // Framebuffer bytes of the region after drawing
+        uint32_t generation;    // Panel generation when drawn, see pin_display_invalidate()
+        bool valid;
+    } drawn;
+    
     bool is_suspended;
     bool is_blocked;
     uint32_t suspension_reason;
+    
+    // Task inside one of the plugin's callbacks on the scheduler worker, NULL
+    // when idle; disabling waits for it so the arena is never freed under it
+    TaskHandle_t busy_task;
 };
 
 // Plugin structure
@@ -123,6 +210,14 @@ struct pin_plugin {
     pin_plugin_metadata_t metadata;
     pin_plugin_config_t config;
     
+    // Optional state kept in RTC memory across deep sleep. It is restored
+    // before init() and saved after start() and every successful update().
+    struct {
+        void* data;
+        uint16_t size;
+        uint16_t version;       // Bump when the layout changes
+    } retained;
+    
     // Lifecycle callback functions
     esp_err_t (*init)(pin_plugin_context_t* ctx);
     esp_err_t (*start)(pin_plugin_context_t* ctx);
@@ -142,17 +237,87 @@ struct pin_plugin {
     
     void* private_data;
     uint8_t plugin_id;
-    TaskHandle_t plugin_task;
+    TaskHandle_t plugin_task;   // Only used by blocking plugins
 };
 
+// Per-plugin statistics snapshot
+typedef struct {
+    uint32_t memory_limit;      // Arena size in bytes
+    uint32_t memory_used;
+    uint32_t memory_peak;
+    uint32_t update_count;
+    uint32_t error_count;
+    uint32_t api_calls_count;
+    uint32_t rate_limited_count;
+    uint64_t cpu_time_us;
+    uint64_t blocked_http_us;
+    uint64_t blocked_display_us;
+    uint32_t update_p50_us;
+    uint32_t update_p99_us;
+    uint32_t update_max_us;
+    uint32_t throttle_count;
+    uint32_t unchanged_updates;
+    bool throttled;
+} pin_plugin_stats_t;
+
 // Function declarations
 esp_err_t pin_plugin_manager_init(void);
 esp_err_t pin_plugin_register(pin_plugin_t* plugin);
 esp_err_t pin_plugin_enable(const char* plugin_name, bool enable);
 pin_plugin_t* pin_plugin_find_by_name(const char* plugin_name);
 esp_err_t pin_plugin_get_list(pin_plugin_t** plugins, uint8_t max_plugins, uint8_t* plugin_count);
+
+/**
+ * @brief Check a plugin's metadata and config, filling in defaults
+ * @param plugin Plugin to check
+ * @return ESP_OK if valid, ESP_ERR_INVALID_SIZE if its memory limit exceeds the plugin pool
+ */
+esp_err_t pin_plugin_validate(pin_plugin_t* plugin);
+
+/**
+ * @brief Get time, latency and memory statistics for a plugin
+ * @param plugin Plugin
+ * @param stats Output statistics
+ * @return ESP_OK on success
+ */
+esp_err_t pin_plugin_get_stats(const pin_plugin_t* plugin, pin_plugin_stats_t* stats);
+
+/**
+ * @brief Commit pending plugin config writes to NVS now (e.g. before sleeping)
+ * @return ESP_OK on success
+ */
+esp_err_t pin_plugin_flush_config(void);
+
+/**
+ * @brief Allocate persistent memory from the plugin's arena
+ * @param ctx Plugin context
+ * @param size Size in bytes (at most PIN_ARENA_MAX_ALLOC)
+ * @return Pointer, or NULL if the plugin's memory_limit would be exceeded
+ */
 void* pin_plugin_malloc(pin_plugin_context_t* ctx, size_t size);
-void pin_plugin_free(pin_plugin_context_t* ctx, void* ptr, size_t size);
+
+/**
+ * @brief Free memory returned by pin_plugin_malloc() or pin_plugin_strdup()
+ * @param ctx Plugin context
+ * @param ptr Pointer to free (NULL is ignored)
+ */
+void pin_plugin_free(pin_plugin_context_t* ctx, void* ptr);
+
+/**
+ * @brief Duplicate a string into the plugin's arena
+ * @param ctx Plugin context
+ * @param str String to copy
+ * @return Copy, or NULL on failure
+ */
+char* pin_plugin_strdup(pin_plugin_context_t* ctx, const char* str);
+
+/**
+ * @brief Allocate scratch memory that is released when the current update() returns
+ * @param ctx Plugin context
+ * @param size Size in bytes
+ * @return Pointer, or NULL if the plugin's memory_limit would be exceeded
+ */
+void* pin_plugin_scratch_alloc(pin_plugin_context_t* ctx, size_t size);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,283 @@
+/**
+ * @file pin_plugin_store.c
+ * @brief Pin Plugin Config Store Implementation
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include "pin_plugin_store.h"
+
+static const char* TAG = "PIN_PLUGIN_STORE";
+
+#define STORE_MASK (PIN_PLUGIN_STORE_MAX_ENTRIES - 1)
+
+_Static_assert((PIN_PLUGIN_STORE_MAX_ENTRIES & STORE_MASK) == 0,
+               "PIN_PLUGIN_STORE_MAX_ENTRIES must be a power of two");
+
+typedef struct {
+    uint32_t hash;
+    char key[PIN_PLUGIN_STORE_KEY_MAX_LEN];     // Empty when the slot is unused
+    char* value;                                // NULL once erased
+    bool dirty;
+} pin_plugin_store_entry_t;
+
+struct pin_plugin_store {
+    char namespace_name[PIN_PLUGIN_STORE_KEY_MAX_LEN];
+    pin_plugin_store_entry_t entries[PIN_PLUGIN_STORE_MAX_ENTRIES];
+    bool dirty;
+    SemaphoreHandle_t mutex;
+};
+
+static uint32_t key_hash(const char* key) {
+    uint32_t hash = 2166136261u;
+    while (*key) {
+        hash ^= (uint8_t)*key++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Linear probing; returns the key's slot, or the empty slot it would go in (NULL if full)
+static pin_plugin_store_entry_t* entry_lookup(pin_plugin_store_t* store, const char* key, uint32_t hash) {
+    for (uint32_t i = 0; i < PIN_PLUGIN_STORE_MAX_ENTRIES; i++) {
+        pin_plugin_store_entry_t* entry = &store->entries[(hash + i) & STORE_MASK];
+        if (entry->key[0] == '\0' ||
+            (entry->hash == hash && strcmp(entry->key, key) == 0)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static bool key_valid(const char* key) {
+    size_t len = key ? strlen(key) : 0;
+    return len > 0 && len < PIN_PLUGIN_STORE_KEY_MAX_LEN;
+}
+
+static esp_err_t store_load(pin_plugin_store_t* store) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(store->namespace_name, NVS_READONLY, &handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_OK;          // Nothing saved yet
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    nvs_iterator_t it = NULL;
+    esp_err_t found = nvs_entry_find(NVS_DEFAULT_PART_NAME, store->namespace_name, NVS_TYPE_STR, &it);
+    while (found == ESP_OK) {
+        nvs_entry_info_t info;
+        nvs_entry_info(it, &info);
+
+        size_t len = 0;
+        uint32_t hash = key_hash(info.key);
+        pin_plugin_store_entry_t* entry = entry_lookup(store, info.key, hash);
+        if (entry && nvs_get_str(handle, info.key, NULL, &len) == ESP_OK) {
+            char* value = malloc(len);
+            if (value && nvs_get_str(handle, info.key, value, &len) == ESP_OK) {
+                entry->hash = hash;
+                strcpy(entry->key, info.key);
+                entry->value = value;
+            } else {
+                free(value);
+            }
+        } else if (!entry) {
+            ESP_LOGW(TAG, "%s: more than %d keys, '%s' not loaded",
+                     store->namespace_name, PIN_PLUGIN_STORE_MAX_ENTRIES, info.key);
+        }
+
+        found = nvs_entry_next(&it);
+    }
+    nvs_release_iterator(it);
+    nvs_close(handle);
+
+    return ESP_OK;
+}
+
+esp_err_t pin_plugin_store_open(const char* plugin_name, pin_plugin_store_t** store) {
+    if (!plugin_name || !store) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pin_plugin_store_t* s = calloc(1, sizeof(pin_plugin_store_t));
+    if (!s) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    s->mutex = xSemaphoreCreateMutex();
+    if (!s->mutex) {
+        free(s);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Namespace names share the 15 character key limit; long plugin names are hashed
+    if (strlen(plugin_name) <= PIN_PLUGIN_STORE_KEY_MAX_LEN - 3) {
+        snprintf(s->namespace_name, sizeof(s->namespace_name), "p_%s", plugin_name);
+    } else {
+        snprintf(s->namespace_name, sizeof(s->namespace_name), "p_%08x", (unsigned)key_hash(plugin_name));
+    }
+
+    esp_err_t err = store_load(s);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to load %s: %s", s->namespace_name, esp_err_to_name(err));
+    }
+
+    *store = s;
+    return ESP_OK;
+}
+
+void pin_plugin_store_close(pin_plugin_store_t* store) {
+    if (!store) {
+        return;
+    }
+
+    pin_plugin_store_flush(store);
+
+    for (int i = 0; i < PIN_PLUGIN_STORE_MAX_ENTRIES; i++) {
+        free(store->entries[i].value);
+    }
+    vSemaphoreDelete(store->mutex);
+    free(store);
+}
+
+esp_err_t pin_plugin_store_get(pin_plugin_store_t* store, const char* key, char* value, size_t max_len) {
+    if (!store || !key_valid(key) || !value || max_len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_ERR_NVS_NOT_FOUND;
+
+    xSemaphoreTake(store->mutex, portMAX_DELAY);
+    pin_plugin_store_entry_t* entry = entry_lookup(store, key, key_hash(key));
+    if (entry && entry->value) {
+        size_t len = strlen(entry->value);
+        if (len < max_len) {
+            memcpy(value, entry->value, len + 1);
+            ret = ESP_OK;
+        } else {
+            ret = ESP_ERR_NVS_INVALID_LENGTH;
+        }
+    }
+    xSemaphoreGive(store->mutex);
+
+    return ret;
+}
+
+esp_err_t pin_plugin_store_set(pin_plugin_store_t* store, const char* key, const char* value) {
+    if (!store || !key_valid(key) || !value) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (strlen(value) >= PIN_PLUGIN_STORE_VALUE_MAX_LEN) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    uint32_t hash = key_hash(key);
+    esp_err_t ret = ESP_OK;
+
+    xSemaphoreTake(store->mutex, portMAX_DELAY);
+    pin_plugin_store_entry_t* entry = entry_lookup(store, key, hash);
+    if (!entry) {
+        ret = ESP_ERR_NO_MEM;
+    } else if (!entry->value || strcmp(entry->value, value) != 0) {
+        // Unchanged values never become dirty, so rewriting defaults costs nothing
+        char* copy = strdup(value);
+        if (!copy) {
+            ret = ESP_ERR_NO_MEM;
+        } else {
+            free(entry->value);
+            entry->value = copy;
+            entry->hash = hash;
+            strcpy(entry->key, key);
+            entry->dirty = true;
+            store->dirty = true;
+        }
+    }
+    xSemaphoreGive(store->mutex);
+
+    return ret;
+}
+
+esp_err_t pin_plugin_store_erase(pin_plugin_store_t* store, const char* key) {
+    if (!store || !key_valid(key)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_ERR_NVS_NOT_FOUND;
+
+    xSemaphoreTake(store->mutex, portMAX_DELAY);
+    pin_plugin_store_entry_t* entry = entry_lookup(store, key, key_hash(key));
+    if (entry && entry->value) {
+        // The slot stays as a tombstone so the flush knows to erase the key
+        free(entry->value);
+        entry->value = NULL;
+        entry->dirty = true;
+        store->dirty = true;
+        ret = ESP_OK;
+    }
+    xSemaphoreGive(store->mutex);
+
+    return ret;
+}
+
+esp_err_t pin_plugin_store_flush(pin_plugin_store_t* store) {
+    if (!store) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(store->mutex, portMAX_DELAY);
+
+    if (!store->dirty) {
+        xSemaphoreGive(store->mutex);
+        return ESP_OK;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(store->namespace_name, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        xSemaphoreGive(store->mutex);
+        ESP_LOGE(TAG, "Failed to open %s: %s", store->namespace_name, esp_err_to_name(err));
+        return err;
+    }
+
+    int written = 0;
+    for (int i = 0; i < PIN_PLUGIN_STORE_MAX_ENTRIES && err == ESP_OK; i++) {
+        pin_plugin_store_entry_t* entry = &store->entries[i];
+        if (!entry->dirty) {
+            continue;
+        }
+        if (entry->value) {
+            err = nvs_set_str(handle, entry->key, entry->value);
+        } else {
+            err = nvs_erase_key(handle, entry->key);
+            if (err == ESP_ERR_NVS_NOT_FOUND) {
+                err = ESP_OK;
+            }
+        }
+        written++;
+    }
+
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (err == ESP_OK) {
+        for (int i = 0; i < PIN_PLUGIN_STORE_MAX_ENTRIES; i++) {
+            store->entries[i].dirty = false;
+        }
+        store->dirty = false;
+        ESP_LOGD(TAG, "%s: %d change(s) committed", store->namespace_name, written);
+    } else {
+        ESP_LOGE(TAG, "Failed to flush %s: %s", store->namespace_name, esp_err_to_name(err));
+    }
+
+    xSemaphoreGive(store->mutex);
+    return err;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file pin_plugin_store.h
+ * @brief Pin Plugin Config Store
+ *
+ * Each enabled plugin gets its configuration loaded from its own NVS
+ * namespace into a small hashed map. Reads are memory lookups; writes
+ * and deletes only mark entries dirty, and pin_plugin_store_flush()
+ * writes every dirty entry with a single nvs_commit().
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIN_PLUGIN_STORE_MAX_ENTRIES 16         // Keys per plugin, power of two
+#define PIN_PLUGIN_STORE_KEY_MAX_LEN 16         // NVS key limit, NUL included
+#define PIN_PLUGIN_STORE_VALUE_MAX_LEN 256      // NUL included
+
+typedef struct pin_plugin_store pin_plugin_store_t;
+
+/**
+ * @brief Load a plugin's configuration
+ * @param plugin_name Plugin name, used to derive the NVS namespace
+ * @param store Output store handle
+ * @return ESP_OK on success (an empty namespace is not an error)
+ */
+esp_err_t pin_plugin_store_open(const char* plugin_name, pin_plugin_store_t** store);
+
+/**
+ * @brief Flush and free a store
+ * @param store Store (NULL is ignored)
+ */
+void pin_plugin_store_close(pin_plugin_store_t* store);
+
+/**
+ * @brief Read a value
+ * @param store Store
+ * @param key Key
+ * @param value Output buffer
+ * @param max_len Size of value
+ * @return ESP_OK, ESP_ERR_NVS_NOT_FOUND, or ESP_ERR_NVS_INVALID_LENGTH if value is too small
+ */
+esp_err_t pin_plugin_store_get(pin_plugin_store_t* store, const char* key, char* value, size_t max_len);
+
+/**
+ * @brief Write a value; it reaches flash on the next flush
+ * @param store Store
+ * @param key Key (at most PIN_PLUGIN_STORE_KEY_MAX_LEN - 1 characters)
+ * @param value Value
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the map is full
+ */
+esp_err_t pin_plugin_store_set(pin_plugin_store_t* store, const char* key, const char* value);
+
+/**
+ * @brief Delete a value; it leaves flash on the next flush
+ * @param store Store
+ * @param key Key
+ * @return ESP_OK on success, ESP_ERR_NVS_NOT_FOUND if the key does not exist
+ */
+esp_err_t pin_plugin_store_erase(pin_plugin_store_t* store, const char* key);
+
+/**
+ * @brief Write all dirty entries with one commit
+ * @param store Store
+ * @return ESP_OK on success (also when nothing was dirty)
+ */
+esp_err_t pin_plugin_store_flush(pin_plugin_store_t* store);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,179 @@
+/**
+ * @file pin_power.c
+ * @brief Pin Power Management Implementation
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "pin_power.h"
+
+static const char* TAG = "PIN_POWER";
+
+typedef struct {
+    esp_pm_lock_handle_t lock;
+    uint32_t depth;                 // Nested holds
+    int64_t since_us;               // When depth went from 0 to 1
+    pin_power_client_stats_t stats;
+} pin_power_client_state_t;
+
+static struct {
+    pin_power_client_state_t clients[PIN_POWER_CLIENT_COUNT];
+    uint32_t holders;               // Clients with depth > 0
+    int64_t active_since_us;
+    int64_t active_us;
+    int64_t light_sleep_us;
+    bool dfs_enabled;
+    bool light_sleep_enabled;
+    volatile bool battery_low;      // Set by whoever samples the battery
+    portMUX_TYPE lock;
+} g_power = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static const char* s_client_names[PIN_POWER_CLIENT_COUNT] = {
+    [PIN_POWER_CLIENT_SPI] = "spi",
+    [PIN_POWER_CLIENT_HTTP] = "http",
+};
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+// Runs on the idle task with interrupts off, right after waking
+static IRAM_ATTR esp_err_t pin_power_light_sleep_exit(int64_t sleep_time_us, void* arg) {
+    g_power.light_sleep_us += sleep_time_us;
+    return ESP_OK;
+}
+#endif
+
+esp_err_t pin_power_init(void) {
+    for (int i = 0; i < PIN_POWER_CLIENT_COUNT; i++) {
+        esp_err_t ret = esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, s_client_names[i], &g_power.clients[i].lock);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to create '%s' lock: %s", s_client_names[i], esp_err_to_name(ret));
+            return ret;
+        }
+    }
+
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = PIN_POWER_MIN_FREQ_MHZ,
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+        .light_sleep_enable = true,
+#endif
+    };
+    esp_err_t ret = esp_pm_configure(&pm_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure power management: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    g_power.dfs_enabled = true;
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    g_power.light_sleep_enabled = true;
+#endif
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+    esp_pm_sleep_cbs_register_config_t cbs = {
+        .exit_cb = pin_power_light_sleep_exit,
+    };
+    if (esp_pm_light_sleep_register_cbs(&cbs) != ESP_OK) {
+        ESP_LOGW(TAG, "Light sleep time will not be tracked");
+    }
+#endif
+
+    ESP_LOGI(TAG, "DFS %d-%d MHz, light sleep %s", PIN_POWER_MIN_FREQ_MHZ, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+             g_power.light_sleep_enabled ? "on" : "off");
+    return ESP_OK;
+}
+
+void pin_power_acquire(pin_power_client_t client) {
+    if (client >= PIN_POWER_CLIENT_COUNT || !g_power.clients[client].lock) {
+        return;
+    }
+
+    pin_power_client_state_t* state = &g_power.clients[client];
+    esp_pm_lock_acquire(state->lock);
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&g_power.lock);
+    if (state->depth++ == 0) {
+        state->since_us = now;
+        state->stats.acquisitions++;
+        if (g_power.holders++ == 0) {
+            g_power.active_since_us = now;
+        }
+    }
+    portEXIT_CRITICAL(&g_power.lock);
+}
+
+void pin_power_release(pin_power_client_t client) {
+    if (client >= PIN_POWER_CLIENT_COUNT || !g_power.clients[client].lock) {
+        return;
+    }
+
+    pin_power_client_state_t* state = &g_power.clients[client];
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&g_power.lock);
+    bool held = state->depth > 0;
+    if (held && --state->depth == 0) {
+        state->stats.active_us += now - state->since_us;
+        if (--g_power.holders == 0) {
+            g_power.active_us += now - g_power.active_since_us;
+        }
+    }
+    portEXIT_CRITICAL(&g_power.lock);
+
+    if (held) {
+        esp_pm_lock_release(state->lock);
+    }
+}
+
+esp_err_t pin_power_get_stats(pin_power_stats_t* stats) {
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(stats, 0, sizeof(pin_power_stats_t));
+    int64_t now = esp_timer_get_time();
+
+    // Open holds count up to now
+    portENTER_CRITICAL(&g_power.lock);
+    stats->active_us = g_power.active_us;
+    if (g_power.holders > 0) {
+        stats->active_us += now - g_power.active_since_us;
+    }
+    stats->light_sleep_us = g_power.light_sleep_us;
+    for (int i = 0; i < PIN_POWER_CLIENT_COUNT; i++) {
+        stats->clients[i] = g_power.clients[i].stats;
+        if (g_power.clients[i].depth > 0) {
+            stats->clients[i].active_us += now - g_power.clients[i].since_us;
+        }
+    }
+    portEXIT_CRITICAL(&g_power.lock);
+
+    stats->uptime_us = now;
+    stats->idle_us = now - stats->active_us - stats->light_sleep_us;
+    if (stats->idle_us < 0) {
+        stats->idle_us = 0;
+    }
+    stats->dfs_enabled = g_power.dfs_enabled;
+    stats->light_sleep_enabled = g_power.light_sleep_enabled;
+    return ESP_OK;
+}
+
+void pin_power_set_battery_low(bool low) {
+    g_power.battery_low = low;
+}
+
+bool pin_power_is_battery_low(void) {
+    return g_power.battery_low;
+}
+
+const char* pin_power_client_name(pin_power_client_t client) {
+    if (client >= PIN_POWER_CLIENT_COUNT) {
+        return "unknown";
+    }
+    return s_client_names[client];
+}
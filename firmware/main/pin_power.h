@@ -0,0 +1,94 @@
+/**
+ * @file pin_power.h
+ * @brief Pin Power Management
+ *
+ * Configures dynamic frequency scaling and automatic light sleep, so the CPU
+ * drops to the crystal clock and sleeps whenever every task is blocked. Work
+ * that needs the full clock (SPI transfers to the panel, HTTP requests) holds
+ * an ESP_PM_APB_FREQ_MAX lock for its client only while it runs; waiting
+ * for the panel's BUSY line or for a server's reply does not.
+ *
+ * Time is accounted per power state: active (some client holds the lock),
+ * light sleep, and idle (awake at the low clock).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIN_POWER_MIN_FREQ_MHZ 40   // Crystal clock, the lowest DFS step on the ESP32-C3
+
+typedef enum {
+    PIN_POWER_CLIENT_SPI,           // Display transfers
+    PIN_POWER_CLIENT_HTTP,          // Outgoing requests and web server handlers
+    PIN_POWER_CLIENT_COUNT
+} pin_power_client_t;
+
+typedef struct {
+    int64_t active_us;              // Held by this client
+    uint32_t acquisitions;
+} pin_power_client_stats_t;
+
+typedef struct {
+    int64_t uptime_us;
+    int64_t active_us;              // At least one client held the full clock
+    int64_t light_sleep_us;         // 0 unless light sleep callbacks are available
+    int64_t idle_us;                // Awake at the low clock
+    bool dfs_enabled;
+    bool light_sleep_enabled;
+    pin_power_client_stats_t clients[PIN_POWER_CLIENT_COUNT];
+} pin_power_stats_t;
+
+/**
+ * @brief Configure DFS and automatic light sleep and create the client locks
+ * @return ESP_OK on success; the device still runs (at full clock) on failure
+ */
+esp_err_t pin_power_init(void);
+
+/**
+ * @brief Hold the full APB clock for a client; calls nest
+ * @param client Client taking the lock
+ */
+void pin_power_acquire(pin_power_client_t client);
+
+/**
+ * @brief Drop one hold taken with pin_power_acquire()
+ * @param client Client releasing the lock
+ */
+void pin_power_release(pin_power_client_t client);
+
+/**
+ * @brief Get the time spent in each power state since boot
+ * @param stats Output statistics
+ * @return ESP_OK on success
+ */
+esp_err_t pin_power_get_stats(pin_power_stats_t* stats);
+
+/**
+ * @brief Record whether the battery is below its low threshold
+ * @param low True while the battery is low
+ */
+void pin_power_set_battery_low(bool low);
+
+/**
+ * @brief Check whether the battery was last reported low
+ * @return True if the battery is low
+ */
+bool pin_power_is_battery_low(void);
+
+/**
+ * @brief Get a printable name for a client
+ * @param client Client
+ * @return Static string
+ */
+const char* pin_power_client_name(pin_power_client_t client);
+
+#ifdef __cplusplus
+}
+#endif
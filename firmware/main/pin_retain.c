@@ -0,0 +1,163 @@
+/**
+ * @file pin_retain.c
+ * @brief Pin RTC Retained State Implementation
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "pin_retain.h"
+
+static const char* TAG = "PIN_RETAIN";
+
+#define PIN_RETAIN_MAGIC 0x52544E31     // "RTN1"
+
+typedef struct {
+    char name[PIN_RETAIN_NAME_MAX_LEN];
+    uint16_t offset;        // Into data
+    uint16_t capacity;      // Bytes reserved, fixed once allocated
+    uint16_t size;          // Bytes saved, 0 = discarded
+    uint16_t version;
+    uint32_t crc;           // Over the saved bytes
+} pin_retain_entry_t;
+
+// Blobs are bump-allocated and keep their slot; the set of users is fixed per firmware
+typedef struct {
+    uint32_t magic;
+    uint32_t directory_crc;
+    uint16_t used;
+    uint8_t entry_count;
+    pin_retain_entry_t entries[PIN_RETAIN_MAX_ENTRIES];
+    uint8_t data[PIN_RETAIN_POOL_SIZE] __attribute__((aligned(4)));
+} pin_retain_pool_t;
+
+static RTC_NOINIT_ATTR pin_retain_pool_t s_pool;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t pin_retain_directory_crc(void) {
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t*)&s_pool.used, sizeof(s_pool.used));
+    crc = esp_rom_crc32_le(crc, &s_pool.entry_count, sizeof(s_pool.entry_count));
+    return esp_rom_crc32_le(crc, (const uint8_t*)s_pool.entries, sizeof(s_pool.entries));
+}
+
+static void pin_retain_wipe(void) {
+    memset(&s_pool, 0, sizeof(s_pool));
+    s_pool.magic = PIN_RETAIN_MAGIC;
+    s_pool.directory_crc = pin_retain_directory_crc();
+}
+
+static pin_retain_entry_t* pin_retain_find(const char* name) {
+    for (uint8_t i = 0; i < s_pool.entry_count; i++) {
+        if (strncmp(s_pool.entries[i].name, name, PIN_RETAIN_NAME_MAX_LEN - 1) == 0) {
+            return &s_pool.entries[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t pin_retain_init(bool after_deep_sleep) {
+    bool valid = after_deep_sleep &&
+                 s_pool.magic == PIN_RETAIN_MAGIC &&
+                 s_pool.entry_count <= PIN_RETAIN_MAX_ENTRIES &&
+                 s_pool.used <= PIN_RETAIN_POOL_SIZE &&
+                 s_pool.directory_crc == pin_retain_directory_crc();
+    if (!valid) {
+        if (after_deep_sleep) {
+            ESP_LOGW(TAG, "Retained state corrupt, discarding");
+        }
+        pin_retain_wipe();
+        return ESP_OK;
+    }
+
+    ESP_LOGI(TAG, "%u retained blobs, %u bytes", (unsigned)s_pool.entry_count, (unsigned)s_pool.used);
+    return ESP_OK;
+}
+
+esp_err_t pin_retain_restore(const char* name, uint16_t version, void* data, size_t size) {
+    if (!name || !data || size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&s_lock);
+    const pin_retain_entry_t* entry = pin_retain_find(name);
+    if (!entry || entry->size == 0) {
+        ret = ESP_ERR_NOT_FOUND;
+    } else if (entry->version != version) {
+        ret = ESP_ERR_INVALID_VERSION;
+    } else if (entry->size != size) {
+        ret = ESP_ERR_INVALID_SIZE;
+    } else if (esp_rom_crc32_le(0, &s_pool.data[entry->offset], entry->size) != entry->crc) {
+        ret = ESP_ERR_INVALID_CRC;
+    } else {
+        memcpy(data, &s_pool.data[entry->offset], size);
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (ret != ESP_OK && ret != ESP_ERR_NOT_FOUND) {
+        ESP_LOGW(TAG, "Ignoring retained '%s': %s", name, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+esp_err_t pin_retain_save(const char* name, uint16_t version, const void* data, size_t size) {
+    if (!name || !data || size == 0 || size > PIN_RETAIN_POOL_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Checksum outside the critical section, the caller owns data
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t*)data, size);
+    esp_err_t ret = ESP_OK;
+
+    portENTER_CRITICAL(&s_lock);
+    pin_retain_entry_t* entry = pin_retain_find(name);
+    if (entry && entry->capacity < size) {
+        // Grown after a firmware change; the old space stays unused until the next cold boot
+        entry->size = 0;
+        entry->name[0] = '\0';
+        entry = NULL;
+    }
+    if (!entry) {
+        uint16_t capacity = (uint16_t)((size + 3) & ~(size_t)3);
+        if (s_pool.entry_count >= PIN_RETAIN_MAX_ENTRIES ||
+            s_pool.used + capacity > PIN_RETAIN_POOL_SIZE) {
+            ret = ESP_ERR_NO_MEM;
+        } else {
+            entry = &s_pool.entries[s_pool.entry_count++];
+            strncpy(entry->name, name, PIN_RETAIN_NAME_MAX_LEN - 1);
+            entry->name[PIN_RETAIN_NAME_MAX_LEN - 1] = '\0';
+            entry->offset = s_pool.used;
+            entry->capacity = capacity;
+            s_pool.used += capacity;
+        }
+    }
+    if (entry) {
+        memcpy(&s_pool.data[entry->offset], data, size);
+        entry->size = (uint16_t)size;
+        entry->version = version;
+        entry->crc = crc;
+    }
+    s_pool.directory_crc = pin_retain_directory_crc();
+    portEXIT_CRITICAL(&s_lock);
+
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "No room to retain '%s' (%u bytes)", name, (unsigned)size);
+    }
+    return ret;
+}
+
+void pin_retain_discard(const char* name) {
+    if (!name) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    pin_retain_entry_t* entry = pin_retain_find(name);
+    if (entry) {
+        entry->size = 0;
+        s_pool.directory_crc = pin_retain_directory_crc();
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
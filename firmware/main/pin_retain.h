@@ -0,0 +1,63 @@
+/**
+ * @file pin_retain.h
+ * @brief Pin RTC Retained State
+ *
+ * Small named blobs kept in RTC slow memory, which survives deep sleep but
+ * not a power cycle. Each blob carries a version and a CRC, so a firmware
+ * change to its layout or a corrupted copy reads as missing rather than
+ * as garbage. The pool is wiped on any boot that is not a deep sleep wake.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIN_RETAIN_POOL_SIZE 2048
+#define PIN_RETAIN_MAX_ENTRIES 8
+#define PIN_RETAIN_NAME_MAX_LEN 16
+
+/**
+ * @brief Validate the pool, or wipe it unless this boot is a deep sleep wake
+ * @param after_deep_sleep true if the device woke from deep sleep
+ * @return ESP_OK on success
+ */
+esp_err_t pin_retain_init(bool after_deep_sleep);
+
+/**
+ * @brief Copy a retained blob back into RAM
+ * @param name Blob name
+ * @param version Layout version the caller expects
+ * @param data Destination
+ * @param size Size of data, must match the saved size
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if nothing was kept,
+ *         ESP_ERR_INVALID_VERSION or ESP_ERR_INVALID_SIZE on a layout change,
+ *         ESP_ERR_INVALID_CRC if the copy is corrupt
+ */
+esp_err_t pin_retain_restore(const char* name, uint16_t version, void* data, size_t size);
+
+/**
+ * @brief Save a blob to RTC memory, replacing any earlier copy
+ * @param name Blob name
+ * @param version Layout version
+ * @param data Source
+ * @param size Size in bytes
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the pool is full
+ */
+esp_err_t pin_retain_save(const char* name, uint16_t version, const void* data, size_t size);
+
+/**
+ * @brief Drop a retained blob
+ * @param name Blob name
+ */
+void pin_retain_discard(const char* name);
+
+#ifdef __cplusplus
+}
+#endif
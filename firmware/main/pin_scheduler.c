@@ -0,0 +1,278 @@
+/**
+ * @file pin_scheduler.c
+ * @brief Pin Cooperative Plugin Scheduler Implementation
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "pin_scheduler.h"
+
+static const char* TAG = "PIN_SCHED";
+
+#define PIN_SCHEDULER_NOT_QUEUED 0xFF
+
+typedef struct {
+    int64_t deadline_us;    // Earliest time the entry may run
+    int64_t latest_us;      // Deadline plus tolerance, heap key
+    uint8_t id;
+} pin_scheduler_entry_t;
+
+// Scheduler state: binary min-heap ordered by latest run time, plus an id -> heap slot map
+static struct {
+    pin_scheduler_entry_t heap[PIN_SCHEDULER_MAX_ENTRIES];
+    uint8_t position[PIN_SCHEDULER_MAX_ENTRIES];
+    uint8_t count;
+    SemaphoreHandle_t mutex;
+    TaskHandle_t worker;
+    pin_scheduler_dispatch_t dispatch;
+    pin_scheduler_poll_t poll;
+} g_scheduler = {0};
+
+static void heap_swap(uint8_t a, uint8_t b) {
+    pin_scheduler_entry_t tmp = g_scheduler.heap[a];
+    g_scheduler.heap[a] = g_scheduler.heap[b];
+    g_scheduler.heap[b] = tmp;
+    g_scheduler.position[g_scheduler.heap[a].id] = a;
+    g_scheduler.position[g_scheduler.heap[b].id] = b;
+}
+
+static void heap_sift_up(uint8_t i) {
+    while (i > 0) {
+        uint8_t parent = (i - 1) / 2;
+        if (g_scheduler.heap[parent].latest_us <= g_scheduler.heap[i].latest_us) {
+            break;
+        }
+        heap_swap(i, parent);
+        i = parent;
+    }
+}
+
+static void heap_sift_down(uint8_t i) {
+    while (true) {
+        uint8_t left = 2 * i + 1;
+        uint8_t right = left + 1;
+        uint8_t smallest = i;
+
+        if (left < g_scheduler.count &&
+            g_scheduler.heap[left].latest_us < g_scheduler.heap[smallest].latest_us) {
+            smallest = left;
+        }
+        if (right < g_scheduler.count &&
+            g_scheduler.heap[right].latest_us < g_scheduler.heap[smallest].latest_us) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            break;
+        }
+        heap_swap(i, smallest);
+        i = smallest;
+    }
+}
+
+static void heap_remove_at(uint8_t i) {
+    uint8_t last = --g_scheduler.count;
+    g_scheduler.position[g_scheduler.heap[i].id] = PIN_SCHEDULER_NOT_QUEUED;
+
+    if (i != last) {
+        g_scheduler.heap[i] = g_scheduler.heap[last];
+        g_scheduler.position[g_scheduler.heap[i].id] = i;
+        heap_sift_down(i);
+        heap_sift_up(i);
+    }
+}
+
+// Pop every entry whose window has opened, earliest deadline first
+static uint8_t collect_due_batch(int64_t now, uint8_t* ids) {
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < g_scheduler.count; i++) {
+        if (g_scheduler.heap[i].deadline_us > now) {
+            continue;
+        }
+        // Insertion sort keeps the batch in deadline order
+        uint8_t j = count++;
+        while (j > 0 &&
+               g_scheduler.heap[g_scheduler.position[ids[j - 1]]].deadline_us >
+               g_scheduler.heap[i].deadline_us) {
+            ids[j] = ids[j - 1];
+            j--;
+        }
+        ids[j] = g_scheduler.heap[i].id;
+    }
+
+    // Remove after scanning, removal reorders the heap
+    for (uint8_t i = 0; i < count; i++) {
+        heap_remove_at(g_scheduler.position[ids[i]]);
+    }
+
+    return count;
+}
+
+static void pin_scheduler_task(void* pvParameters) {
+    uint8_t batch[PIN_SCHEDULER_MAX_ENTRIES];
+
+    ESP_LOGI(TAG, "Scheduler worker started");
+
+    while (1) {
+        TickType_t wait = portMAX_DELAY;
+        uint8_t batch_count = 0;
+
+        if (g_scheduler.poll) {
+            g_scheduler.poll();
+        }
+
+        xSemaphoreTake(g_scheduler.mutex, portMAX_DELAY);
+        if (g_scheduler.count > 0) {
+            int64_t now = esp_timer_get_time();
+            int64_t delta_us = g_scheduler.heap[0].latest_us - now;
+            if (delta_us <= 0) {
+                // The most urgent window is closing: take everything that may run now
+                batch_count = collect_due_batch(now, batch);
+            } else {
+                // Round up so we never wake just before the deadline
+                wait = pdMS_TO_TICKS((delta_us + 999) / 1000);
+                if (wait == 0) {
+                    wait = 1;
+                }
+            }
+        }
+        xSemaphoreGive(g_scheduler.mutex);
+
+        if (batch_count > 0) {
+            // Dispatch outside the lock so callbacks may re-arm themselves
+            ESP_LOGD(TAG, "Dispatching batch of %d", batch_count);
+            g_scheduler.dispatch(batch, batch_count);
+            continue;
+        }
+
+        // Sleep until the next window closes, the heap changes or we are woken
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+}
+
+esp_err_t pin_scheduler_init(pin_scheduler_dispatch_t dispatch) {
+    if (!dispatch) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (g_scheduler.worker) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    g_scheduler.mutex = xSemaphoreCreateMutex();
+    if (!g_scheduler.mutex) {
+        ESP_LOGE(TAG, "Failed to create scheduler mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(g_scheduler.position, PIN_SCHEDULER_NOT_QUEUED, sizeof(g_scheduler.position));
+    g_scheduler.count = 0;
+    g_scheduler.dispatch = dispatch;
+
+    BaseType_t ret = xTaskCreate(pin_scheduler_task,
+                                 "plugin_sched",
+                                 PIN_SCHEDULER_TASK_STACK_SIZE,
+                                 NULL,
+                                 PIN_SCHEDULER_TASK_PRIORITY,
+                                 &g_scheduler.worker);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create scheduler task");
+        vSemaphoreDelete(g_scheduler.mutex);
+        g_scheduler.mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Scheduler initialized");
+    return ESP_OK;
+}
+
+esp_err_t pin_scheduler_set_poll_hook(pin_scheduler_poll_t poll) {
+    if (!g_scheduler.worker) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    g_scheduler.poll = poll;
+    pin_scheduler_wake();
+    return ESP_OK;
+}
+
+void pin_scheduler_wake(void) {
+    if (g_scheduler.worker) {
+        xTaskNotifyGive(g_scheduler.worker);
+    }
+}
+
+esp_err_t pin_scheduler_add(uint8_t id, int64_t deadline_us, int64_t tolerance_us) {
+    if (id >= PIN_SCHEDULER_MAX_ENTRIES || tolerance_us < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!g_scheduler.worker) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(g_scheduler.mutex, portMAX_DELAY);
+
+    uint8_t i = g_scheduler.position[id];
+    if (i == PIN_SCHEDULER_NOT_QUEUED) {
+        i = g_scheduler.count++;
+        g_scheduler.heap[i].id = id;
+        g_scheduler.position[id] = i;
+    }
+    g_scheduler.heap[i].deadline_us = deadline_us;
+    g_scheduler.heap[i].latest_us = deadline_us + tolerance_us;
+    heap_sift_down(i);
+    heap_sift_up(g_scheduler.position[id]);
+
+    bool is_first = (g_scheduler.heap[0].id == id);
+    xSemaphoreGive(g_scheduler.mutex);
+
+    // Only the head of the heap changes how long the worker sleeps
+    if (is_first && xTaskGetCurrentTaskHandle() != g_scheduler.worker) {
+        xTaskNotifyGive(g_scheduler.worker);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t pin_scheduler_remove(uint8_t id) {
+    if (id >= PIN_SCHEDULER_MAX_ENTRIES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!g_scheduler.worker) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(g_scheduler.mutex, portMAX_DELAY);
+
+    uint8_t i = g_scheduler.position[id];
+    if (i == PIN_SCHEDULER_NOT_QUEUED) {
+        xSemaphoreGive(g_scheduler.mutex);
+        return ESP_ERR_NOT_FOUND;
+    }
+    heap_remove_at(i);
+
+    xSemaphoreGive(g_scheduler.mutex);
+    return ESP_OK;
+}
+
+int64_t pin_scheduler_next_deadline(void) {
+    int64_t deadline = INT64_MAX;
+
+    if (!g_scheduler.worker) {
+        return deadline;
+    }
+
+    xSemaphoreTake(g_scheduler.mutex, portMAX_DELAY);
+    if (g_scheduler.count > 0) {
+        deadline = g_scheduler.heap[0].latest_us;
+    }
+    xSemaphoreGive(g_scheduler.mutex);
+
+    return deadline;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file pin_scheduler.h
+ * @brief Pin Cooperative Plugin Scheduler
+ *
+ * Runs plugin callbacks from a single worker task, driven by a min-heap
+ * of deadlines, instead of one FreeRTOS task per plugin.
+ *
+ * Every entry is a window [deadline, deadline + tolerance]. The worker
+ * sleeps until the earliest window closes and then runs every entry whose
+ * window has opened as one batch, so nearby deadlines share a single wakeup.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIN_SCHEDULER_MAX_ENTRIES 16
+#define PIN_SCHEDULER_TASK_STACK_SIZE 8192
+#define PIN_SCHEDULER_TASK_PRIORITY 4
+
+/**
+ * @brief Callback invoked on the worker task with a batch of due entries
+ * @param ids Entry identifiers passed to pin_scheduler_add(), earliest deadline first
+ * @param count Number of entries in the batch (at least 1)
+ */
+typedef void (*pin_scheduler_dispatch_t)(const uint8_t* ids, uint8_t count);
+
+/**
+ * @brief Hook run on the worker task every time it wakes up
+ */
+typedef void (*pin_scheduler_poll_t)(void);
+
+/**
+ * @brief Initialize the scheduler and start its worker task
+ * @param dispatch Callback invoked for every batch of due entries
+ * @return ESP_OK on success
+ */
+esp_err_t pin_scheduler_init(pin_scheduler_dispatch_t dispatch);
+
+/**
+ * @brief Install a hook run on the worker before it checks deadlines
+ * @param poll Hook to run, or NULL to remove it
+ * @return ESP_OK on success
+ */
+esp_err_t pin_scheduler_set_poll_hook(pin_scheduler_poll_t poll);
+
+/**
+ * @brief Wake the worker so it runs the poll hook soon
+ */
+void pin_scheduler_wake(void);
+
+/**
+ * @brief Add or move an entry
+ * @param id Entry identifier (0 .. PIN_SCHEDULER_MAX_ENTRIES - 1)
+ * @param deadline_us Absolute deadline on the esp_timer clock, never run earlier
+ * @param tolerance_us How long the entry may be delayed to join a batch
+ * @return ESP_OK on success
+ */
+esp_err_t pin_scheduler_add(uint8_t id, int64_t deadline_us, int64_t tolerance_us);
+
+/**
+ * @brief Remove an entry
+ * @param id Entry identifier
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if not scheduled
+ */
+esp_err_t pin_scheduler_remove(uint8_t id);
+
+/**
+ * @brief Get the time the worker will next wake up
+ * @return Latest acceptable time of the most urgent entry in microseconds,
+ *         or INT64_MAX if nothing is scheduled
+ */
+int64_t pin_scheduler_next_deadline(void);
+
+#ifdef __cplusplus
+}
+#endif
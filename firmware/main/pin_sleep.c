@@ -0,0 +1,200 @@
+/**
+ * @file pin_sleep.c
+ * @brief Pin Deep Sleep Wake Planner Implementation
+ */
+
+#include <string.h>
+#include <sys/time.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "pin_display.h"
+#include "pin_retain.h"
+#include "pin_sleep.h"
+
+static const char* TAG = "PIN_SLEEP";
+
+#define PIN_SLEEP_PLAN_NAME "sleep.plan"
+#define PIN_SLEEP_PLAN_VERSION 1
+
+// Kept in RTC memory over deep sleep
+typedef struct {
+    uint8_t count;
+    pin_sleep_deadline_t deadlines[PIN_SLEEP_MAX_DEADLINES];
+} pin_sleep_plan_t;
+
+static struct {
+    pin_sleep_source_t sources[PIN_SLEEP_MAX_SOURCES];
+    uint8_t source_count;
+    esp_sleep_wakeup_cause_t wake_cause;
+    pin_sleep_plan_t saved;     // Plan from before the last sleep, empty after a cold boot
+    pin_sleep_hook_t plan_hook;
+    int64_t last_activity_us;   // esp_timer clock
+} g_sleep = {0};
+
+// last_activity_us is 64-bit and written from HTTP server tasks
+static portMUX_TYPE s_activity_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static int64_t pin_sleep_wall_time_us(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+esp_err_t pin_sleep_init(void) {
+    g_sleep.wake_cause = esp_sleep_get_wakeup_cause();
+
+    // RTC memory also survives a reset, so it only counts after a sleep wake
+    esp_err_t ret = pin_retain_init(g_sleep.wake_cause != ESP_SLEEP_WAKEUP_UNDEFINED);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (pin_retain_restore(PIN_SLEEP_PLAN_NAME, PIN_SLEEP_PLAN_VERSION,
+                           &g_sleep.saved, sizeof(g_sleep.saved)) != ESP_OK ||
+        g_sleep.saved.count > PIN_SLEEP_MAX_DEADLINES) {
+        memset(&g_sleep.saved, 0, sizeof(g_sleep.saved));
+    }
+
+    // Someone may be looking at the device after a cold boot or button press
+    if (!pin_sleep_is_planned_wake()) {
+        pin_sleep_note_activity();
+    }
+
+    ESP_LOGI(TAG, "Wake cause %d, %u saved deadlines", (int)g_sleep.wake_cause,
+             (unsigned)g_sleep.saved.count);
+    return ESP_OK;
+}
+
+esp_err_t pin_sleep_register_source(pin_sleep_source_t source) {
+    if (!source) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (g_sleep.source_count >= PIN_SLEEP_MAX_SOURCES) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    g_sleep.sources[g_sleep.source_count++] = source;
+    return ESP_OK;
+}
+
+void pin_sleep_set_plan_hook(pin_sleep_hook_t hook) {
+    g_sleep.plan_hook = hook;
+}
+
+void pin_sleep_plan_changed(void) {
+    pin_sleep_hook_t hook = g_sleep.plan_hook;
+    if (hook) {
+        hook();
+    }
+}
+
+void pin_sleep_note_activity(void) {
+    int64_t now_us = esp_timer_get_time();
+    portENTER_CRITICAL(&s_activity_lock);
+    g_sleep.last_activity_us = now_us;
+    portEXIT_CRITICAL(&s_activity_lock);
+}
+
+int64_t pin_sleep_awake_hold_us(void) {
+    portENTER_CRITICAL(&s_activity_lock);
+    int64_t last_us = g_sleep.last_activity_us;
+    portEXIT_CRITICAL(&s_activity_lock);
+
+    if (last_us == 0) {
+        return 0;
+    }
+    int64_t remaining_us = last_us + (int64_t)PIN_SLEEP_INTERACTIVE_AWAKE_MS * 1000 - esp_timer_get_time();
+    return remaining_us > 0 ? remaining_us : 0;
+}
+
+bool pin_sleep_is_planned_wake(void) {
+    return g_sleep.wake_cause == ESP_SLEEP_WAKEUP_TIMER;
+}
+
+esp_err_t pin_sleep_restore_deadline(const char* name, pin_sleep_deadline_t* deadline) {
+    if (!name || !deadline) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (uint8_t i = 0; i < g_sleep.saved.count; i++) {
+        if (strncmp(g_sleep.saved.deadlines[i].name, name, PIN_SLEEP_NAME_MAX_LEN - 1) == 0) {
+            *deadline = g_sleep.saved.deadlines[i];
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+/**
+ * Gather every source's deadlines into plan and return the wake time on the
+ * wall clock: the latest acceptable time of the most urgent deadline.
+ */
+static int64_t pin_sleep_collect(pin_sleep_plan_t* plan) {
+    plan->count = 0;
+    for (uint8_t i = 0; i < g_sleep.source_count; i++) {
+        plan->count += g_sleep.sources[i](&plan->deadlines[plan->count],
+                                          PIN_SLEEP_MAX_DEADLINES - plan->count);
+    }
+
+    int64_t wake_us = INT64_MAX;
+    for (uint8_t i = 0; i < plan->count; i++) {
+        int64_t latest_us = plan->deadlines[i].due_us + (int64_t)plan->deadlines[i].tolerance_ms * 1000;
+        if (latest_us < wake_us) {
+            wake_us = latest_us;
+        }
+    }
+    return wake_us;
+}
+
+int64_t pin_sleep_next_wake_in_us(void) {
+    pin_sleep_plan_t plan;
+    int64_t wake_us = pin_sleep_collect(&plan);
+    if (wake_us == INT64_MAX) {
+        return INT64_MAX;
+    }
+    return wake_us - pin_sleep_wall_time_us();
+}
+
+bool pin_sleep_should_enter(void) {
+    if (pin_sleep_awake_hold_us() > 0) {
+        return false;
+    }
+
+    return pin_sleep_next_wake_in_us() >= (int64_t)PIN_SLEEP_MIN_SLEEP_MS * 1000;
+}
+
+void pin_sleep_enter(void) {
+    pin_sleep_plan_t plan;
+    int64_t wake_us = pin_sleep_collect(&plan);
+
+    if (pin_retain_save(PIN_SLEEP_PLAN_NAME, PIN_SLEEP_PLAN_VERSION, &plan, sizeof(plan)) != ESP_OK) {
+        ESP_LOGW(TAG, "Plan not saved, every plugin will update on wake");
+    }
+
+    // Put display to sleep first
+    pin_display_sleep();
+
+    // Never sleep without a timer: the button may not be able to wake the chip
+    int64_t sleep_us = (int64_t)PIN_SLEEP_FALLBACK_WAKE_MS * 1000;
+    if (wake_us != INT64_MAX) {
+        sleep_us = wake_us - pin_sleep_wall_time_us();
+        if (sleep_us < 1000000) {
+            sleep_us = 1000000;
+        }
+        ESP_LOGI(TAG, "Sleeping %lld s, %u deadlines saved", (long long)(sleep_us / 1000000), (unsigned)plan.count);
+    } else {
+        ESP_LOGI(TAG, "Nothing scheduled, sleeping %lld s", (long long)(sleep_us / 1000000));
+    }
+    esp_sleep_enable_timer_wakeup((uint64_t)sleep_us);
+
+    // Only GPIO0-5 can wake the ESP32-C3 from deep sleep
+    if (esp_sleep_is_valid_wakeup_gpio(PIN_SLEEP_WAKE_BUTTON_GPIO)) {
+        esp_deep_sleep_enable_gpio_wakeup(1ULL << PIN_SLEEP_WAKE_BUTTON_GPIO, ESP_GPIO_WAKEUP_GPIO_LOW);
+    } else {
+        ESP_LOGW(TAG, "GPIO%d cannot wake from deep sleep, timer wake only", PIN_SLEEP_WAKE_BUTTON_GPIO);
+    }
+
+    esp_deep_sleep_start();
+}
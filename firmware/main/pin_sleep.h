@@ -0,0 +1,126 @@
+/**
+ * @file pin_sleep.h
+ * @brief Pin Deep Sleep Wake Planner
+ *
+ * Before deep sleep the planner asks every registered source (the plugin
+ * manager, and anything else that needs to run at a given time) for its
+ * next deadline. The device wakes at the latest acceptable time of the most
+ * urgent deadline, the same window rule the scheduler uses, so deadlines
+ * that fit inside that window share one wakeup. With no deadlines at all
+ * the device wakes on the button or, as a fallback, after
+ * PIN_SLEEP_FALLBACK_WAKE_MS.
+ *
+ * Deadlines are kept in RTC memory on the wall clock, which keeps running
+ * through deep sleep. After a wake each source restores its own deadlines,
+ * so only the work that is actually due runs.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIN_SLEEP_NAME_MAX_LEN 16
+#define PIN_SLEEP_MAX_DEADLINES 12
+#define PIN_SLEEP_MAX_SOURCES 4
+#define PIN_SLEEP_MIN_SLEEP_MS 20000            // Not worth rebooting for anything closer
+#define PIN_SLEEP_INTERACTIVE_AWAKE_MS 120000   // Stay up this long after a cold boot, button wake or HTTP request
+#define PIN_SLEEP_FALLBACK_WAKE_MS (10 * 60 * 1000) // Timer wake when nothing is scheduled
+#define PIN_SLEEP_WAKE_BUTTON_GPIO 9            // User button, active low (README pin assignment)
+
+// One piece of work that must run at a given time
+typedef struct {
+    char name[PIN_SLEEP_NAME_MAX_LEN];  // Identifies the deadline to its source after waking
+    int64_t due_us;                     // Wall clock, microseconds since the epoch
+    uint32_t tolerance_ms;              // How late it may run to share a wakeup
+} pin_sleep_deadline_t;
+
+/**
+ * @brief Reports the pending deadlines of one subsystem
+ * @param out Deadlines to fill in
+ * @param max Capacity of out
+ * @return Number of deadlines written
+ */
+typedef uint8_t (*pin_sleep_source_t)(pin_sleep_deadline_t* out, uint8_t max);
+
+/**
+ * @brief Called whenever the sleep plan may have changed
+ */
+typedef void (*pin_sleep_hook_t)(void);
+
+/**
+ * @brief Read the wake cause and the deadlines kept over the last sleep
+ * @return ESP_OK on success
+ */
+esp_err_t pin_sleep_init(void);
+
+/**
+ * @brief Add a deadline source consulted by the planner
+ * @param source Source callback
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if all source slots are taken
+ */
+esp_err_t pin_sleep_register_source(pin_sleep_source_t source);
+
+/**
+ * @brief Install the hook run by pin_sleep_plan_changed()
+ * @param hook Hook, or NULL to remove it
+ */
+void pin_sleep_set_plan_hook(pin_sleep_hook_t hook);
+
+/**
+ * @brief Tell the planner that a source's deadlines moved (e.g. after a plugin update)
+ */
+void pin_sleep_plan_changed(void);
+
+/**
+ * @brief Record user activity, which keeps the device awake for a while
+ */
+void pin_sleep_note_activity(void);
+
+/**
+ * @brief Get how much longer user activity keeps the device awake
+ * @return Microseconds until the interactive window closes, 0 if closed
+ */
+int64_t pin_sleep_awake_hold_us(void);
+
+/**
+ * @brief Check whether the device woke from a planned (timer) deep sleep wake
+ * @return true after a timer wake
+ */
+bool pin_sleep_is_planned_wake(void);
+
+/**
+ * @brief Look up a deadline saved before the last deep sleep
+ * @param name Deadline name
+ * @param deadline Output deadline
+ * @return ESP_OK if found, ESP_ERR_NOT_FOUND otherwise (always after a cold boot)
+ */
+esp_err_t pin_sleep_restore_deadline(const char* name, pin_sleep_deadline_t* deadline);
+
+/**
+ * @brief Compute when the device next has to be awake
+ * @return Microseconds from now until the planned wake (may be negative if
+ *         work is overdue), or INT64_MAX if nothing is scheduled
+ */
+int64_t pin_sleep_next_wake_in_us(void);
+
+/**
+ * @brief Check whether deep sleep is worth entering now
+ * @return true if nothing is due within PIN_SLEEP_MIN_SLEEP_MS and no
+ *         interactive window is open
+ */
+bool pin_sleep_should_enter(void);
+
+/**
+ * @brief Save the plan to RTC memory and enter deep sleep until the planned wake
+ */
+void pin_sleep_enter(void);
+
+#ifdef __cplusplus
+}
+#endif
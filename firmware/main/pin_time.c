@@ -0,0 +1,272 @@
+/**
+ * @file pin_time.c
+ * @brief Pin Time Service Implementation
+ */
+
+#include <math.h>
+#include <string.h>
+#include <sys/time.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_netif_sntp.h"
+#include "esp_timer.h"
+#include "pin_time.h"
+#include "pin_netwin.h"
+#include "pin_retain.h"
+
+static const char* TAG = "PIN_TIME";
+
+#define PIN_TIME_STATE_NAME "time.drift"
+#define PIN_TIME_STATE_VERSION 1
+#define PIN_TIME_JOB "time"
+#define PIN_TIME_MAX_DRIFT_PPM 5000         // Larger offsets mean the clock was set by hand
+
+// Kept in RTC memory over deep sleep
+typedef struct {
+    int64_t sync_us;            // Wall clock at the last sync, 0 if never synced
+    int64_t corrected_us;       // Drift has been taken out of the clock up to here
+    float drift_ppm;
+    uint32_t uncertainty_ppm;
+    uint32_t syncs;
+    uint32_t failures;
+    uint16_t samples;
+} pin_time_state_t;
+
+static struct {
+    pin_time_state_t state;
+    int64_t request_wall_us;    // Local wall clock when the SNTP request went out
+    int64_t request_us;         // esp_timer at the same moment
+    int64_t offset_us;          // Local minus SNTP time, set by the sync callback
+    bool offset_valid;
+    portMUX_TYPE lock;
+} g_time = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static void pin_time_sync_job(void* arg);
+
+static int64_t pin_time_wall_us(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static void pin_time_set_wall_us(int64_t wall_us) {
+    struct timeval tv = {
+        .tv_sec = wall_us / 1000000,
+        .tv_usec = wall_us % 1000000,
+    };
+    settimeofday(&tv, NULL);
+}
+
+static uint32_t pin_time_error_ms(const pin_time_state_t* state, int64_t wall_us) {
+    if (state->sync_us == 0) {
+        return UINT32_MAX;
+    }
+
+    int64_t elapsed_ms = (wall_us - state->sync_us) / 1000;
+    if (elapsed_ms < 0) {
+        elapsed_ms = 0;
+    }
+    int64_t error_ms = PIN_TIME_SYNC_ERROR_MS + elapsed_ms * state->uncertainty_ppm / 1000000;
+    return error_ms > UINT32_MAX ? UINT32_MAX : (uint32_t)error_ms;
+}
+
+static void pin_time_save(void) {
+    pin_time_state_t state;
+    portENTER_CRITICAL(&g_time.lock);
+    state = g_time.state;
+    portEXIT_CRITICAL(&g_time.lock);
+    pin_retain_save(PIN_TIME_STATE_NAME, PIN_TIME_STATE_VERSION, &state, sizeof(state));
+}
+
+// Take the drift accumulated since the last correction out of the clock
+static void pin_time_compensate(void) {
+    pin_time_state_t* state = &g_time.state;
+    if (state->sync_us == 0 || state->samples == 0) {
+        return;
+    }
+
+    int64_t now_us = pin_time_wall_us();
+    int64_t elapsed_us = now_us - state->corrected_us;
+    if (elapsed_us <= 0) {
+        return;
+    }
+
+    int64_t correction_us = (int64_t)((double)elapsed_us * state->drift_ppm / 1e6);
+    if (correction_us != 0) {
+        pin_time_set_wall_us(now_us - correction_us);
+        ESP_LOGI(TAG, "Corrected clock by %lld ms for %.1f ppm drift",
+                 (long long)(-correction_us / 1000), state->drift_ppm);
+    }
+    state->corrected_us = now_us - correction_us;
+}
+
+// Next sync: eligible at half the error budget, forced when it runs out
+static void pin_time_schedule(bool failed) {
+    int64_t now_us = esp_timer_get_time();
+    pin_time_state_t state;
+    portENTER_CRITICAL(&g_time.lock);
+    state = g_time.state;
+    portEXIT_CRITICAL(&g_time.lock);
+
+    int64_t deadline_us;
+    uint32_t tolerance_ms;
+    if (failed) {
+        deadline_us = now_us + (int64_t)PIN_TIME_RETRY_MS * 1000;
+        tolerance_ms = state.sync_us == 0 ? 0 : PIN_TIME_RETRY_MS;
+    } else if (state.sync_us == 0) {
+        deadline_us = now_us;
+        tolerance_ms = 0;
+    } else {
+        int64_t budget_us = (int64_t)(PIN_TIME_ERROR_BUDGET_MS - PIN_TIME_SYNC_ERROR_MS) * 1000;
+        int64_t reach_us = budget_us * 1000000 / state.uncertainty_ppm;
+        int64_t due_us = now_us + (state.sync_us + reach_us - pin_time_wall_us());
+        deadline_us = due_us - reach_us / 2;
+        if (deadline_us < now_us) {
+            deadline_us = now_us;
+        }
+        tolerance_ms = due_us > deadline_us ? (uint32_t)((due_us - deadline_us) / 1000) : 0;
+    }
+
+    esp_err_t ret = pin_netwin_add_job(PIN_TIME_JOB, pin_time_sync_job, NULL, deadline_us, tolerance_ms);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to schedule sync: %s", esp_err_to_name(ret));
+        return;
+    }
+    ESP_LOGD(TAG, "Next sync in %lld s (tolerance %lu s)",
+             (long long)((deadline_us - now_us) / 1000000), (unsigned long)(tolerance_ms / 1000));
+}
+
+// Runs on the lwIP task right after SNTP has set the clock
+static void pin_time_sync_cb(struct timeval* tv) {
+    int64_t now_us = esp_timer_get_time();
+    int64_t synced_us = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec;
+
+    // The local clock would have advanced with esp_timer since the request
+    portENTER_CRITICAL(&g_time.lock);
+    g_time.offset_us = g_time.request_wall_us + (now_us - g_time.request_us) - synced_us;
+    g_time.offset_valid = true;
+    portEXIT_CRITICAL(&g_time.lock);
+}
+
+// Learn the drift that compensation missed since the last sync
+static void pin_time_learn(pin_time_state_t* state, int64_t wall_us, int64_t offset_us) {
+    int64_t elapsed_us = wall_us - state->sync_us;
+
+    if (state->sync_us != 0 && elapsed_us >= (int64_t)PIN_TIME_MIN_LEARN_S * 1000000) {
+        float residual_ppm = (float)((double)offset_us * 1e6 / (double)elapsed_us);
+        if (fabsf(residual_ppm) <= PIN_TIME_MAX_DRIFT_PPM) {
+            // The first sample is the whole drift, later ones only refine it
+            state->drift_ppm += state->samples == 0 ? residual_ppm : residual_ppm / 2;
+            state->samples++;
+            uint32_t uncertainty_ppm = (uint32_t)fabsf(residual_ppm);
+            state->uncertainty_ppm = uncertainty_ppm < PIN_TIME_MIN_DRIFT_PPM ? PIN_TIME_MIN_DRIFT_PPM
+                                                                              : uncertainty_ppm;
+        } else {
+            ESP_LOGW(TAG, "Ignoring %.0f ppm offset, clock was set elsewhere", residual_ppm);
+        }
+    }
+
+    state->sync_us = wall_us;
+    state->corrected_us = wall_us;
+    state->syncs++;
+}
+
+static void pin_time_sync_job(void* arg) {
+    esp_sntp_config_t config = ESP_NETIF_SNTP_DEFAULT_CONFIG(PIN_TIME_SNTP_SERVER);
+    config.sync_cb = pin_time_sync_cb;
+
+    portENTER_CRITICAL(&g_time.lock);
+    g_time.offset_valid = false;
+    g_time.request_wall_us = pin_time_wall_us();
+    g_time.request_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&g_time.lock);
+
+    // One-shot: the schedule below decides when to ask again, not SNTP polling
+    esp_err_t ret = esp_netif_sntp_init(&config);
+    if (ret == ESP_OK) {
+        ret = esp_netif_sntp_sync_wait(pdMS_TO_TICKS(PIN_TIME_SYNC_TIMEOUT_MS));
+        esp_netif_sntp_deinit();
+    }
+
+    portENTER_CRITICAL(&g_time.lock);
+    bool offset_valid = g_time.offset_valid;
+    int64_t offset_us = g_time.offset_us;
+    portEXIT_CRITICAL(&g_time.lock);
+
+    bool failed = ret != ESP_OK || !offset_valid;
+    if (failed) {
+        portENTER_CRITICAL(&g_time.lock);
+        g_time.state.failures++;
+        portEXIT_CRITICAL(&g_time.lock);
+        ESP_LOGW(TAG, "SNTP sync failed: %s", esp_err_to_name(ret == ESP_OK ? ESP_ERR_TIMEOUT : ret));
+    } else {
+        // Only this task writes the state; the lock keeps readers consistent
+        pin_time_state_t state = g_time.state;
+        bool first = state.sync_us == 0;
+        pin_time_learn(&state, pin_time_wall_us(), offset_us);
+        portENTER_CRITICAL(&g_time.lock);
+        g_time.state = state;
+        portEXIT_CRITICAL(&g_time.lock);
+        if (first) {
+            ESP_LOGI(TAG, "Clock set by SNTP");
+        } else {
+            ESP_LOGI(TAG, "Synced, clock was off by %lld ms, drift %.1f ppm from %u samples",
+                     (long long)(offset_us / 1000), state.drift_ppm, state.samples);
+        }
+    }
+
+    pin_time_save();
+    pin_time_schedule(failed);
+}
+
+esp_err_t pin_time_init(void) {
+    // Nothing is kept after a cold boot, so the drift is learned again
+    if (pin_retain_restore(PIN_TIME_STATE_NAME, PIN_TIME_STATE_VERSION,
+                           &g_time.state, sizeof(g_time.state)) != ESP_OK) {
+        memset(&g_time.state, 0, sizeof(g_time.state));
+        g_time.state.uncertainty_ppm = PIN_TIME_DEFAULT_DRIFT_PPM;
+    }
+
+    pin_time_compensate();
+    pin_time_save();
+    pin_time_schedule(false);
+
+    if (g_time.state.sync_us != 0) {
+        ESP_LOGI(TAG, "Time service initialized, estimated error %lu ms",
+                 (unsigned long)pin_time_error_ms(&g_time.state, pin_time_wall_us()));
+    } else {
+        ESP_LOGI(TAG, "Time service initialized, clock not set yet");
+    }
+    return ESP_OK;
+}
+
+bool pin_time_is_synced(void) {
+    portENTER_CRITICAL(&g_time.lock);
+    bool synced = g_time.state.sync_us != 0;
+    portEXIT_CRITICAL(&g_time.lock);
+    return synced;
+}
+
+esp_err_t pin_time_get_status(pin_time_status_t* status) {
+    if (!status) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pin_time_state_t state;
+    portENTER_CRITICAL(&g_time.lock);
+    state = g_time.state;
+    portEXIT_CRITICAL(&g_time.lock);
+
+    memset(status, 0, sizeof(pin_time_status_t));
+    status->synced = state.sync_us != 0;
+    status->last_sync = state.sync_us / 1000000;
+    status->drift_ppm = state.drift_ppm;
+    status->uncertainty_ppm = state.uncertainty_ppm;
+    status->error_ms = pin_time_error_ms(&state, pin_time_wall_us());
+    status->syncs = state.syncs;
+    status->failures = state.failures;
+    status->samples = state.samples;
+    return ESP_OK;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file pin_time.h
+ * @brief Pin Time Service
+ *
+ * Keeps the wall clock within an error budget without syncing on every
+ * wake. Each SNTP sync measures how far the local clock has wandered since
+ * the previous one; that drift (in ppm) is learned across syncs, kept in RTC
+ * memory, and subtracted from the clock after every deep sleep wake. The
+ * remaining uncertainty grows with the time since the last sync, and a sync
+ * is only scheduled as a network window job once it would exceed
+ * PIN_TIME_ERROR_BUDGET_MS. The job becomes eligible half way there, so it
+ * usually rides along with a window some plugin opened anyway.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIN_TIME_SNTP_SERVER "pool.ntp.org"
+#define PIN_TIME_SYNC_TIMEOUT_MS 10000
+#define PIN_TIME_ERROR_BUDGET_MS 2000       // Sync before the estimated error passes this
+#define PIN_TIME_SYNC_ERROR_MS 100          // Error left right after an SNTP sync
+#define PIN_TIME_DEFAULT_DRIFT_PPM 500      // Assumed until a drift has been measured
+#define PIN_TIME_MIN_DRIFT_PPM 20           // Floor for the learned uncertainty
+#define PIN_TIME_MIN_LEARN_S 600            // Shorter sync intervals are too noisy to learn from
+#define PIN_TIME_RETRY_MS (5 * 60 * 1000)   // Next try after a failed sync
+
+typedef struct {
+    bool synced;                // The clock has been set since the last cold boot
+    int64_t last_sync;          // Wall clock seconds of the last sync
+    float drift_ppm;            // Learned drift, positive when the local clock runs fast
+    uint32_t uncertainty_ppm;   // Drift left after compensation
+    uint32_t error_ms;          // Estimated error right now
+    uint32_t syncs;             // Since the last cold boot
+    uint32_t failures;
+    uint16_t samples;           // Syncs the drift was learned from
+} pin_time_status_t;
+
+/**
+ * @brief Restore the learned drift, correct the clock after a deep sleep
+ *        and schedule the next sync; call after pin_netwin_init()
+ * @return ESP_OK on success
+ */
+esp_err_t pin_time_init(void);
+
+/**
+ * @brief Check whether the wall clock has been set
+ * @return true after the first successful sync
+ */
+bool pin_time_is_synced(void);
+
+/**
+ * @brief Get the time service status
+ * @param status Output status
+ * @return ESP_OK on success
+ */
+esp_err_t pin_time_get_status(pin_time_status_t* status);
+
+#ifdef __cplusplus
+}
+#endif
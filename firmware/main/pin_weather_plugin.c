@@ -5,11 +5,13 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <time.h>
 #include <math.h>
 #include "pin_plugin.h"
+#include "pin_json_stream.h"
+#include "nvs.h"
 #include "esp_log.h"
-#include "cJSON.h"
 
 static const char* TAG = "WEATHER_PLUGIN";
 
@@ -31,9 +33,53 @@ typedef struct {
 
 static weather_data_t g_weather_data = {0};
 
+#define WEATHER_UPDATE_INTERVAL_S 600
+#define WEATHER_RETAINED_VERSION 1
+
+// Fields picked out of the OpenWeatherMap response
+enum {
+    WEATHER_FIELD_NAME,
+    WEATHER_FIELD_COUNTRY,
+    WEATHER_FIELD_TEMP,
+    WEATHER_FIELD_FEELS_LIKE,
+    WEATHER_FIELD_HUMIDITY,
+    WEATHER_FIELD_PRESSURE,
+    WEATHER_FIELD_CONDITION,
+    WEATHER_FIELD_DESCRIPTION,
+    WEATHER_FIELD_ICON,
+    WEATHER_FIELD_WIND_SPEED,
+    WEATHER_FIELD_WIND_DEG,
+    WEATHER_FIELD_COUNT
+};
+
+static const char* const g_weather_fields[WEATHER_FIELD_COUNT] = {
+    [WEATHER_FIELD_NAME] = "name",
+    [WEATHER_FIELD_COUNTRY] = "sys.country",
+    [WEATHER_FIELD_TEMP] = "main.temp",
+    [WEATHER_FIELD_FEELS_LIKE] = "main.feels_like",
+    [WEATHER_FIELD_HUMIDITY] = "main.humidity",
+    [WEATHER_FIELD_PRESSURE] = "main.pressure",
+    [WEATHER_FIELD_CONDITION] = "weather[0].main",
+    [WEATHER_FIELD_DESCRIPTION] = "weather[0].description",
+    [WEATHER_FIELD_ICON] = "weather[0].icon",
+    [WEATHER_FIELD_WIND_SPEED] = "wind.speed",
+    [WEATHER_FIELD_WIND_DEG] = "wind.deg",
+};
+
+static pin_json_path_t g_weather_paths[WEATHER_FIELD_COUNT];
+
+// Parse state for one streamed response; committed to g_weather_data on success
+typedef struct {
+    pin_json_stream_t parser;
+    weather_data_t data;
+    char country[8];
+    bool have_temperature;
+} weather_parse_t;
+
 // Forward declarations
 static esp_err_t fetch_weather_data(pin_plugin_context_t* ctx);
-static esp_err_t parse_weather_response(const char* json_response);
+static esp_err_t weather_on_chunk(const char* data, size_t len, void* user_data);
+static void weather_on_value(uint8_t field, pin_json_type_t type, const char* value, void* user_data);
 static const char* get_weather_emoji(const char* icon);
 static void format_weather_display(char* output, size_t max_len);
 
@@ -41,6 +87,14 @@ static void format_weather_display(char* output, size_t max_len);
 static esp_err_t weather_init(pin_plugin_context_t* ctx) {
     ESP_LOGI(TAG, "Weather plugin initialized");
     
+    for (int i = 0; i < WEATHER_FIELD_COUNT; i++) {
+        esp_err_t ret = pin_json_path_compile(g_weather_fields[i], &g_weather_paths[i]);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Bad field path: %s", g_weather_fields[i]);
+            return ret;
+        }
+    }
+    
     // Set default configuration if not exists
     char config_value[64];
     if (ctx->api.config_get("api_key", config_value, sizeof(config_value)) != ESP_OK) {
@@ -62,6 +116,14 @@ static esp_err_t weather_init(pin_plugin_context_t* ctx) {
 static esp_err_t weather_start(pin_plugin_context_t* ctx) {
     ESP_LOGI(TAG, "Weather plugin started");
     
+    // Data kept over deep sleep is reused until the next scheduled update
+    if (ctx->state_restored && g_weather_data.data_valid &&
+        time(NULL) - (time_t)g_weather_data.last_update < WEATHER_UPDATE_INTERVAL_S) {
+        ESP_LOGI(TAG, "Resuming with weather from %u s ago",
+                 (unsigned)(time(NULL) - (time_t)g_weather_data.last_update));
+        return ESP_OK;
+    }
+    
     // Fetch initial weather data
     esp_err_t ret = fetch_weather_data(ctx);
     if (ret != ESP_OK) {
@@ -72,15 +134,12 @@ static esp_err_t weather_start(pin_plugin_context_t* ctx) {
 }
 
 static esp_err_t weather_update(pin_plugin_context_t* ctx) {
-    // Check if we need to update (every 10 minutes)
-    time_t now = time(NULL);
-    if (g_weather_data.data_valid && (now - g_weather_data.last_update) < 600) {
-        ESP_LOGD(TAG, "Weather data still fresh, skipping update");
-        return ESP_OK;
-    }
-    
+    // Freshness is handled by the HTTP cache (http_cache_ttl below)
     ESP_LOGI(TAG, "Updating weather data");
-    return fetch_weather_data(ctx);
+    esp_err_t ret = fetch_weather_data(ctx);
+    
+    // Being rate limited is not a failure; it must not count towards disabling the plugin
+    return ret == PIN_PLUGIN_ERR_RATE_LIMITED ? ESP_OK : ret;
 }
 
 static esp_err_t weather_render(pin_plugin_context_t* ctx, pin_widget_region_t* region) {
@@ -91,11 +150,12 @@ static esp_err_t weather_render(pin_plugin_context_t* ctx, pin_widget_region_t*
     char weather_display[256];
     format_weather_display(weather_display, sizeof(weather_display));
     
-    // Update region content
-    if (region->content) {
-        free(region->content);
+    // Update region content (owned by the plugin's arena)
+    pin_plugin_free(ctx, region->content);
+    region->content = pin_plugin_strdup(ctx, weather_display);
+    if (!region->content) {
+        return ESP_ERR_NO_MEM;
     }
-    region->content = strdup(weather_display);
     region->dirty = true;
     
     return ESP_OK;
@@ -129,10 +189,15 @@ static esp_err_t fetch_weather_data(pin_plugin_context_t* ctx) {
     char units[16];
     
     // Get configuration
-    if (ctx->api.config_get("api_key", api_key, sizeof(api_key)) != ESP_OK) {
+    esp_err_t key_ret = ctx->api.config_get("api_key", api_key, sizeof(api_key));
+    if (key_ret == ESP_ERR_NVS_NOT_FOUND) {
         ESP_LOGE(TAG, "No API key configured");
         return ESP_ERR_INVALID_ARG;
     }
+    if (key_ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read API key: %s", esp_err_to_name(key_ret));
+        return key_ret;
+    }
     
     if (ctx->api.config_get("city", city, sizeof(city)) != ESP_OK) {
         strcpy(city, "London,UK");
@@ -151,110 +216,121 @@ static esp_err_t fetch_weather_data(pin_plugin_context_t* ctx) {
     // Build API URL
     char url[512];
     snprintf(url, sizeof(url), 
-             "http://api.openweathermap.org/data/2.5/weather?q=%s&appid=%s&units=%s",
+             "https://api.openweathermap.org/data/2.5/weather?q=%s&appid=%s&units=%s",
              city, api_key, units);
     
-    char response[2048];
-    esp_err_t ret = ctx->api.http_get(url, response, sizeof(response));
+    // Stream the body through the path extractor; only the fields above are kept
+    weather_parse_t parse = {0};
+    pin_json_stream_init(&parse.parser, g_weather_paths, WEATHER_FIELD_COUNT, weather_on_value, &parse);
+    
+    esp_err_t ret = ctx->api.http_get_stream(url, weather_on_chunk, &parse);
+    if (ret == PIN_PLUGIN_ERR_RATE_LIMITED) {
+        ESP_LOGW(TAG, "Weather request rate limited, keeping the last reading");
+        return ret;
+    }
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "HTTP GET failed: %s", esp_err_to_name(ret));
         return ret;
     }
     
-    ret = parse_weather_response(response);
-    if (ret == ESP_OK) {
-        g_weather_data.last_update = time(NULL);
-        g_weather_data.data_valid = true;
-        ESP_LOGI(TAG, "Weather data updated: %.1f°C in %s", 
-                g_weather_data.temperature, g_weather_data.location);
-    }
-    
-    return ret;
-}
-
-static esp_err_t parse_weather_response(const char* json_response) {
-    cJSON *json = cJSON_Parse(json_response);
-    if (!json) {
+    if (pin_json_stream_finish(&parse.parser) != ESP_OK || !parse.have_temperature) {
         ESP_LOGE(TAG, "Failed to parse weather JSON response");
         return ESP_FAIL;
     }
     
-    // Parse location name
-    cJSON *name = cJSON_GetObjectItem(json, "name");
-    cJSON *sys = cJSON_GetObjectItem(json, "sys");
-    if (cJSON_IsString(name)) {
-        strncpy(g_weather_data.location, name->valuestring, sizeof(g_weather_data.location) - 1);
-        
-        // Add country code if available
-        if (sys) {
-            cJSON *country = cJSON_GetObjectItem(sys, "country");
-            if (cJSON_IsString(country)) {
-                strncat(g_weather_data.location, ", ", sizeof(g_weather_data.location) - strlen(g_weather_data.location) - 1);
-                strncat(g_weather_data.location, country->valuestring, sizeof(g_weather_data.location) - strlen(g_weather_data.location) - 1);
-            }
-        }
+    if (parse.country[0]) {
+        size_t used = strlen(parse.data.location);
+        snprintf(parse.data.location + used, sizeof(parse.data.location) - used, ", %s", parse.country);
     }
+    g_weather_data = parse.data;
+    g_weather_data.last_update = time(NULL);
+    g_weather_data.data_valid = true;
+    ESP_LOGI(TAG, "Weather data updated: %.1f°C in %s", 
+            g_weather_data.temperature, g_weather_data.location);
     
-    // Parse main weather data
-    cJSON *main = cJSON_GetObjectItem(json, "main");
-    if (main) {
-        cJSON *temp = cJSON_GetObjectItem(main, "temp");
-        cJSON *feels_like = cJSON_GetObjectItem(main, "feels_like");
-        cJSON *humidity = cJSON_GetObjectItem(main, "humidity");
-        cJSON *pressure = cJSON_GetObjectItem(main, "pressure");
-        
-        if (cJSON_IsNumber(temp)) g_weather_data.temperature = (float)temp->valuedouble;
-        if (cJSON_IsNumber(feels_like)) g_weather_data.feels_like = (float)feels_like->valuedouble;
-        if (cJSON_IsNumber(humidity)) g_weather_data.humidity = humidity->valueint;
-        if (cJSON_IsNumber(pressure)) g_weather_data.pressure = (float)pressure->valuedouble;
+    // Share the reading so other plugins need not fetch it themselves
+    if (ctx->api.emit_event) {
+        char event_data[64];
+        snprintf(event_data, sizeof(event_data), "temp=%.1f;humidity=%d;icon=%s",
+                 g_weather_data.temperature, g_weather_data.humidity, g_weather_data.icon);
+        ctx->api.emit_event("weather.updated", event_data);
     }
     
-    // Parse weather condition
-    cJSON *weather = cJSON_GetObjectItem(json, "weather");
-    if (cJSON_IsArray(weather) && cJSON_GetArraySize(weather) > 0) {
-        cJSON *weather_item = cJSON_GetArrayItem(weather, 0);
-        cJSON *condition = cJSON_GetObjectItem(weather_item, "main");
-        cJSON *description = cJSON_GetObjectItem(weather_item, "description");
-        cJSON *icon = cJSON_GetObjectItem(weather_item, "icon");
-        
-        if (cJSON_IsString(condition)) {
-            strncpy(g_weather_data.condition, condition->valuestring, sizeof(g_weather_data.condition) - 1);
-        }
-        if (cJSON_IsString(description)) {
-            strncpy(g_weather_data.description, description->valuestring, sizeof(g_weather_data.description) - 1);
-        }
-        if (cJSON_IsString(icon)) {
-            strncpy(g_weather_data.icon, icon->valuestring, sizeof(g_weather_data.icon) - 1);
-        }
+    return ESP_OK;
+}
+
+static esp_err_t weather_on_chunk(const char* data, size_t len, void* user_data) {
+    weather_parse_t* parse = (weather_parse_t*)user_data;
+    return pin_json_stream_feed(&parse->parser, data, len);
+}
+
+static void weather_on_value(uint8_t field, pin_json_type_t type, const char* value, void* user_data) {
+    weather_parse_t* parse = (weather_parse_t*)user_data;
+    weather_data_t* data = &parse->data;
+    
+    switch (field) {
+        case WEATHER_FIELD_NAME:
+            strncpy(data->location, value, sizeof(data->location) - 1);
+            return;
+        case WEATHER_FIELD_COUNTRY:
+            strncpy(parse->country, value, sizeof(parse->country) - 1);
+            return;
+        case WEATHER_FIELD_CONDITION:
+            strncpy(data->condition, value, sizeof(data->condition) - 1);
+            return;
+        case WEATHER_FIELD_DESCRIPTION:
+            strncpy(data->description, value, sizeof(data->description) - 1);
+            return;
+        case WEATHER_FIELD_ICON:
+            strncpy(data->icon, value, sizeof(data->icon) - 1);
+            return;
+        default:
+            break;
     }
     
-    // Parse wind data
-    cJSON *wind = cJSON_GetObjectItem(json, "wind");
-    if (wind) {
-        cJSON *speed = cJSON_GetObjectItem(wind, "speed");
-        cJSON *deg = cJSON_GetObjectItem(wind, "deg");
-        
-        if (cJSON_IsNumber(speed)) g_weather_data.wind_speed = (float)speed->valuedouble;
-        if (cJSON_IsNumber(deg)) g_weather_data.wind_direction = deg->valueint;
+    // The remaining fields are numbers
+    if (type != PIN_JSON_PRIMITIVE) {
+        return;
     }
     
-    cJSON_Delete(json);
-    return ESP_OK;
+    switch (field) {
+        case WEATHER_FIELD_TEMP:
+            data->temperature = strtof(value, NULL);
+            parse->have_temperature = true;
+            break;
+        case WEATHER_FIELD_FEELS_LIKE:
+            data->feels_like = strtof(value, NULL);
+            break;
+        case WEATHER_FIELD_HUMIDITY:
+            data->humidity = atoi(value);
+            break;
+        case WEATHER_FIELD_PRESSURE:
+            data->pressure = strtof(value, NULL);
+            break;
+        case WEATHER_FIELD_WIND_SPEED:
+            data->wind_speed = strtof(value, NULL);
+            break;
+        case WEATHER_FIELD_WIND_DEG:
+            data->wind_direction = atoi(value);
+            break;
+    }
 }
 
 static const char* get_weather_emoji(const char* icon) {
-    if (!icon || strlen(icon) < 2) return "🌍";
-    
-    switch (icon[0]) {
-        case '01': return icon[2] == 'd' ? "☀️" : "🌙";  // clear sky
-        case '02': return icon[2] == 'd' ? "⛅" : "🌙";  // few clouds
-        case '03': return "☁️";   // scattered clouds
-        case '04': return "☁️";   // broken clouds
-        case '09': return "🌧️";   // shower rain
-        case '10': return "🌦️";   // rain
-        case '11': return "⛈️";   // thunderstorm
-        case '13': return "❄️";   // snow
-        case '50': return "🌫️";   // mist
+    if (!icon || strlen(icon) < 3) return "🌍";
+    
+    // Icon codes are two digits plus 'd' (day) or 'n' (night), e.g. "10d"
+    bool day = icon[2] == 'd';
+    switch ((icon[0] - '0') * 10 + (icon[1] - '0')) {
+        case 1:  return day ? "☀️" : "🌙";  // clear sky
+        case 2:  return day ? "⛅" : "🌙";  // few clouds
+        case 3:  return "☁️";   // scattered clouds
+        case 4:  return "☁️";   // broken clouds
+        case 9:  return "🌧️";   // shower rain
+        case 10: return "🌦️";   // rain
+        case 11: return "⛈️";   // thunderstorm
+        case 13: return "❄️";   // snow
+        case 50: return "🌫️";   // mist
         default: return "🌍";
     }
 }
@@ -295,11 +371,17 @@ pin_plugin_t weather_plugin = {
     },
     .config = {
         .memory_limit = 8192,
-        .update_interval = 600,  // Update every 10 minutes
-        .api_rate_limit = 60,    // 60 API calls per hour max
+        .update_interval = WEATHER_UPDATE_INTERVAL_S,  // Update every 10 minutes
+        .api_rate_limit = 1,     // Calls per minute for each API class, the old 60 per hour
+        .http_cache_ttl = 600,   // OpenWeatherMap data changes at most every 10 minutes
         .auto_start = true,
         .persistent = true
     },
+    .retained = {
+        .data = &g_weather_data,
+        .size = sizeof(g_weather_data),
+        .version = WEATHER_RETAINED_VERSION
+    },
     .init = weather_init,
     .start = weather_start,
     .update = weather_update,
@@ -0,0 +1,34 @@
+/**
+ * @file pin_web_assets.h
+ * @brief Pin Embedded Web Assets
+ *
+ * The files in www/ are minified and gzipped at build time by
+ * tools/web_assets.py, which generates the table below. Each asset carries
+ * a strong ETag derived from its compressed bytes, so a browser revalidating
+ * after a firmware update gets the new file and otherwise a 304.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    const char* name;           // File name in www/, e.g. "app.js"
+    const char* content_type;
+    const char* etag;           // Quoted, ready for the ETag header
+    const uint8_t* data;        // gzip stream
+    size_t size;
+    size_t original_size;       // Before minifying and compression
+} pin_web_asset_t;
+
+extern const pin_web_asset_t pin_web_assets[];
+extern const size_t pin_web_asset_count;
+
+#ifdef __cplusplus
+}
+#endif
@@ -18,107 +18,176 @@
 #include "cJSON.h"
 
 #include "pin_webserver.h"
+#include "pin_web_assets.h"
+#include "pin_json_writer.h"
 #include "pin_display.h"
 #include "pin_wifi.h"
 #include "esp_timer.h"
 #include "pin_ota.h"
 #include "pin_canvas.h"
+#include "pin_plugin.h"
+#include "pin_config.h"
+#include "pin_init.h"
+#include "pin_sleep.h"
+#include "pin_power.h"
+#include "pin_netwin.h"
+#include "pin_time.h"
+#include "pin_jobs.h"
 
 static const char *TAG = "PIN_WEBSERVER";
 
+#define CANVAS_LIST_BATCH 4             // Index entries copied out per lock
+#define IMAGE_UPLOAD_CHUNK_SIZE 1024    // Receive buffer for streamed uploads
+#define OTA_UPDATE_URL "https://api.github.com/repos/MePride/pin/releases/latest"
+
 static httpd_handle_t server = NULL;
 static pin_canvas_handle_t g_canvas_handle = NULL;
 
-// Embedded web files
-extern const uint8_t index_html_start[] asm("_binary_index_html_start");
-extern const uint8_t index_html_end[]   asm("_binary_index_html_end");
-extern const uint8_t app_js_start[] asm("_binary_app_js_start");
-extern const uint8_t app_js_end[]   asm("_binary_app_js_end");
-extern const uint8_t manifest_json_start[] asm("_binary_manifest_json_start");
-extern const uint8_t manifest_json_end[]   asm("_binary_manifest_json_end");
-extern const uint8_t sw_js_start[] asm("_binary_sw_js_start");
-extern const uint8_t sw_js_end[]   asm("_binary_sw_js_end");
-
 // Helper functions
 static esp_err_t send_json_response(httpd_req_t *req, cJSON *json, int status_code);
+static void json_response_begin(httpd_req_t *req, pin_json_writer_t *writer, int status_code);
+static esp_err_t json_response_end(httpd_req_t *req, pin_json_writer_t *writer);
 static esp_err_t send_error_response(httpd_req_t *req, int status_code, const char *message);
 static char* get_request_body(httpd_req_t *req);
+static esp_err_t submit_job(httpd_req_t *req, const char *name, pin_job_fn_t fn, const void *arg, size_t arg_size);
 
 // Static file handlers
+static const pin_web_asset_t* find_web_asset(const char *name) {
+    for (size_t i = 0; i < pin_web_asset_count; i++) {
+        if (strcmp(pin_web_assets[i].name, name) == 0) {
+            return &pin_web_assets[i];
+        }
+    }
+    return NULL;
+}
+
+// True if the request's If-None-Match lists this ETag
+static bool web_asset_not_modified(httpd_req_t *req, const pin_web_asset_t *asset) {
+    char if_none_match[128];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) != ESP_OK) {
+        return false;
+    }
+    return strcmp(if_none_match, "*") == 0 || strstr(if_none_match, asset->etag) != NULL;
+}
+
+// Assets are stored gzipped only; every browser that can run the UI accepts gzip.
+// Revalidating with the ETag picks up new assets after a firmware update.
+static esp_err_t send_web_asset(httpd_req_t *req, const char *name) {
+    const pin_web_asset_t *asset = find_web_asset(name);
+    if (!asset) {
+        return send_error_response(req, 404, "Not found");
+    }
+    
+    httpd_resp_set_hdr(req, "ETag", asset->etag);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    if (web_asset_not_modified(req, asset)) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+    
+    httpd_resp_set_type(req, asset->content_type);
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    return httpd_resp_send(req, (const char*)asset->data, asset->size);
+}
+
 static esp_err_t index_handler(httpd_req_t *req) {
-    httpd_resp_set_type(req, "text/html");
-    httpd_resp_set_hdr(req, "Cache-Control", "public, max-age=31536000");
-    return httpd_resp_send(req, (const char*)index_html_start, index_html_end - index_html_start);
+    return send_web_asset(req, "index.html");
 }
 
 static esp_err_t app_js_handler(httpd_req_t *req) {
-    httpd_resp_set_type(req, "application/javascript");
-    httpd_resp_set_hdr(req, "Cache-Control", "public, max-age=31536000");
-    return httpd_resp_send(req, (const char*)app_js_start, app_js_end - app_js_start);
+    return send_web_asset(req, "app.js");
 }
 
 static esp_err_t manifest_handler(httpd_req_t *req) {
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_set_hdr(req, "Cache-Control", "public, max-age=31536000");
-    return httpd_resp_send(req, (const char*)manifest_json_start, manifest_json_end - manifest_json_start);
+    return send_web_asset(req, "manifest.json");
 }
 
 static esp_err_t sw_js_handler(httpd_req_t *req) {
-    httpd_resp_set_type(req, "application/javascript");
-    httpd_resp_set_hdr(req, "Cache-Control", "public, max-age=31536000");
-    return httpd_resp_send(req, (const char*)sw_js_start, sw_js_end - sw_js_start);
+    return send_web_asset(req, "sw.js");
 }
 
 // Device API handlers
 static esp_err_t api_status_handler(httpd_req_t *req) {
-    cJSON *response = cJSON_CreateObject();
+    pin_json_writer_t w;
+    json_response_begin(req, &w, 200);
+    pin_json_writer_object_begin(&w, NULL);
     
     // Add device information
-    cJSON_AddStringToObject(response, "firmware_version", "1.0.0");
-    cJSON_AddStringToObject(response, "device_name", "Pin E-ink Display");
+    pin_json_writer_string(&w, "firmware_version", "1.0.0");
+    pin_json_writer_string(&w, "device_name", "Pin E-ink Display");
     
     // Add battery information
     float battery_voltage = pin_battery_get_voltage();
     uint8_t battery_percentage = pin_battery_get_percentage(battery_voltage);
-    cJSON_AddNumberToObject(response, "battery_voltage", battery_voltage);
-    cJSON_AddNumberToObject(response, "battery_percentage", battery_percentage);
+    pin_json_writer_number(&w, "battery_voltage", battery_voltage);
+    pin_json_writer_int(&w, "battery_percentage", battery_percentage);
     
     // Add WiFi information
-    cJSON *wifi_info = cJSON_CreateObject();
-    cJSON_AddBoolToObject(wifi_info, "connected", pin_wifi_is_connected());
+    pin_json_writer_object_begin(&w, "wifi");
+    pin_json_writer_bool(&w, "connected", pin_wifi_is_connected());
     
     if (pin_wifi_is_connected()) {
         char ssid[32] = {0};
         if (pin_wifi_get_current_ssid(ssid, sizeof(ssid)) == ESP_OK) {
-            cJSON_AddStringToObject(wifi_info, "ssid", ssid);
+            pin_json_writer_string(&w, "ssid", ssid);
         }
-        cJSON_AddNumberToObject(wifi_info, "rssi", pin_wifi_get_rssi());
+        pin_json_writer_int(&w, "rssi", pin_wifi_get_rssi());
+    }
+    pin_wifi_stats_t wifi_stats;
+    if (pin_wifi_get_stats(&wifi_stats) == ESP_OK) {
+        pin_json_writer_int(&w, "connects", wifi_stats.connects);
+        pin_json_writer_int(&w, "fast_connects", wifi_stats.fast_connects);
+        pin_json_writer_int(&w, "fallbacks", wifi_stats.fallbacks);
+        pin_json_writer_int(&w, "failures", wifi_stats.failures);
+        pin_json_writer_int(&w, "last_connect_ms", wifi_stats.last_connect_ms);
+        pin_json_writer_bool(&w, "last_connect_fast", wifi_stats.last_was_fast);
+        pin_json_writer_int(&w, "radio_on_ms", wifi_stats.radio_on_ms);
+    }
+    pin_netwin_stats_t netwin_stats;
+    if (pin_netwin_get_stats(&netwin_stats) == ESP_OK) {
+        pin_json_writer_bool(&w, "radio_on", netwin_stats.radio_on);
+        pin_json_writer_int(&w, "windows", netwin_stats.windows);
+        pin_json_writer_int(&w, "network_jobs_run", netwin_stats.jobs_run);
+    }
+    pin_json_writer_object_end(&w);
+    
+    pin_time_status_t time_status;
+    if (pin_time_get_status(&time_status) == ESP_OK) {
+        pin_json_writer_object_begin(&w, "time");
+        pin_json_writer_bool(&w, "synced", time_status.synced);
+        pin_json_writer_int(&w, "last_sync", time_status.last_sync);
+        pin_json_writer_number(&w, "drift_ppm", time_status.drift_ppm);
+        pin_json_writer_int(&w, "uncertainty_ppm", time_status.uncertainty_ppm);
+        if (time_status.synced) {
+            pin_json_writer_int(&w, "error_ms", time_status.error_ms);
+        }
+        pin_json_writer_int(&w, "syncs", time_status.syncs);
+        pin_json_writer_int(&w, "failures", time_status.failures);
+        pin_json_writer_int(&w, "samples", time_status.samples);
+        pin_json_writer_object_end(&w);
     }
-    cJSON_AddItemToObject(response, "wifi", wifi_info);
     
     // Add system information
-    cJSON *system_info = cJSON_CreateObject();
-    cJSON_AddNumberToObject(system_info, "free_heap", esp_get_free_heap_size());
-    cJSON_AddNumberToObject(system_info, "uptime", esp_timer_get_time() / 1000000);
-    cJSON_AddItemToObject(response, "system", system_info);
+    pin_json_writer_object_begin(&w, "system");
+    pin_json_writer_int(&w, "free_heap", esp_get_free_heap_size());
+    pin_json_writer_int(&w, "uptime", esp_timer_get_time() / 1000000);
+    pin_json_writer_object_end(&w);
     
-    return send_json_response(req, response, 200);
+    pin_json_writer_object_end(&w);
+    return json_response_end(req, &w);
+}
+
+// A full refresh takes seconds, so it runs on the job worker
+static esp_err_t display_refresh_job(void *arg) {
+    return pin_display_refresh(PIN_REFRESH_FULL);
 }
 
 static esp_err_t api_display_refresh_handler(httpd_req_t *req) {
-    fpc_a005_handle_t display_handle = pin_display_get_handle();
-    if (!display_handle) {
+    if (!pin_display_get_handle()) {
         return send_error_response(req, 500, "Display not initialized");
     }
     
-    esp_err_t ret = fpc_a005_refresh(display_handle, FPC_A005_REFRESH_FULL);
-    if (ret != ESP_OK) {
-        return send_error_response(req, 500, "Failed to refresh display");
-    }
-    
-    cJSON *response = cJSON_CreateObject();
-    cJSON_AddStringToObject(response, "message", "Display refreshed successfully");
-    return send_json_response(req, response, 200);
+    return submit_job(req, "refresh", display_refresh_job, NULL, 0);
 }
 
 static esp_err_t api_display_clear_handler(httpd_req_t *req) {
@@ -140,45 +209,47 @@ static esp_err_t api_ota_status_handler(httpd_req_t *req) {
         return send_error_response(req, 500, "Failed to get OTA status");
     }
     
-    cJSON *response = cJSON_CreateObject();
+    pin_json_writer_t w;
+    json_response_begin(req, &w, 200);
+    pin_json_writer_object_begin(&w, NULL);
     
     // OTA state
     const char* state_names[] = {"idle", "checking", "downloading", "installing", "complete", "error"};
-    cJSON_AddStringToObject(response, "state", state_names[ota_status.state]);
-    cJSON_AddNumberToObject(response, "progress", ota_status.progress_percent);
-    cJSON_AddStringToObject(response, "current_version", ota_status.current_version);
+    pin_json_writer_string(&w, "state", state_names[ota_status.state]);
+    pin_json_writer_int(&w, "progress", ota_status.progress_percent);
+    pin_json_writer_string(&w, "current_version", ota_status.current_version);
     
     if (strlen(ota_status.error_message) > 0) {
-        cJSON_AddStringToObject(response, "error_message", ota_status.error_message);
+        pin_json_writer_string(&w, "error_message", ota_status.error_message);
     }
     
-    cJSON_AddBoolToObject(response, "update_available", ota_status.update_available);
-    cJSON_AddNumberToObject(response, "last_check_time", ota_status.last_check_time);
+    pin_json_writer_bool(&w, "update_available", ota_status.update_available);
+    pin_json_writer_int(&w, "last_check_time", ota_status.last_check_time);
     
     if (ota_status.update_available) {
-        cJSON *update_info = cJSON_CreateObject();
-        cJSON_AddStringToObject(update_info, "version", ota_status.available_update.version);
-        cJSON_AddStringToObject(update_info, "description", ota_status.available_update.description);
-        cJSON_AddNumberToObject(update_info, "size", ota_status.available_update.size);
-        cJSON_AddBoolToObject(update_info, "force_update", ota_status.available_update.force_update);
-        cJSON_AddItemToObject(response, "available_update", update_info);
+        pin_json_writer_object_begin(&w, "available_update");
+        pin_json_writer_string(&w, "version", ota_status.available_update.version);
+        pin_json_writer_string(&w, "description", ota_status.available_update.description);
+        pin_json_writer_int(&w, "size", ota_status.available_update.size);
+        pin_json_writer_bool(&w, "force_update", ota_status.available_update.force_update);
+        pin_json_writer_object_end(&w);
     }
     
-    return send_json_response(req, response, 200);
+    pin_json_writer_object_end(&w);
+    return json_response_end(req, &w);
+}
+
+// pin_ota_check_update() holds the network window itself
+static esp_err_t ota_check_job(void *arg) {
+    pin_power_acquire(PIN_POWER_CLIENT_HTTP);
+    esp_err_t ret = pin_ota_check_update(OTA_UPDATE_URL);
+    pin_power_release(PIN_POWER_CLIENT_HTTP);
+    return ret;
 }
 
 static esp_err_t api_ota_check_handler(httpd_req_t *req) {
-    // Use GitHub releases API as default
-    const char* update_url = "https://api.github.com/repos/MePride/pin/releases/latest";
-    
-    esp_err_t ret = pin_ota_check_update(update_url);
-    if (ret != ESP_OK) {
-        return send_error_response(req, 500, "Failed to check for updates");
-    }
-    
-    cJSON *response = cJSON_CreateObject();
-    cJSON_AddStringToObject(response, "message", "Update check initiated");
-    return send_json_response(req, response, 200);
+    // Use GitHub releases API as default; the result shows up in /api/ota/status
+    return submit_job(req, "ota_check", ota_check_job, NULL, 0);
 }
 
 static esp_err_t api_ota_update_handler(httpd_req_t *req) {
@@ -226,41 +297,244 @@ static esp_err_t api_ota_rollback_handler(httpd_req_t *req) {
     return send_json_response(req, response, 200);
 }
 
+// Plugin API handlers
+static esp_err_t api_plugins_stats_handler(httpd_req_t *req) {
+    pin_plugin_t* plugins[PIN_MAX_PLUGINS];
+    uint8_t count = 0;
+    if (pin_plugin_get_list(plugins, PIN_MAX_PLUGINS, &count) != ESP_OK) {
+        return send_error_response(req, 500, "Failed to list plugins");
+    }
+
+    cJSON *json = cJSON_CreateObject();
+    cJSON *list = cJSON_CreateArray();
+
+    for (uint8_t i = 0; i < count; i++) {
+        pin_plugin_stats_t stats;
+        if (pin_plugin_get_stats(plugins[i], &stats) != ESP_OK) {
+            continue;
+        }
+
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "name", plugins[i]->metadata.name);
+        cJSON_AddBoolToObject(item, "enabled", plugins[i]->enabled);
+        cJSON_AddBoolToObject(item, "throttled", stats.throttled);
+        cJSON_AddNumberToObject(item, "cpu_budget_ms", plugins[i]->config.cpu_budget_ms);
+        cJSON_AddNumberToObject(item, "cpu_time_ms", stats.cpu_time_us / 1000.0);
+        cJSON_AddNumberToObject(item, "blocked_http_ms", stats.blocked_http_us / 1000.0);
+        cJSON_AddNumberToObject(item, "blocked_display_ms", stats.blocked_display_us / 1000.0);
+        cJSON_AddNumberToObject(item, "update_p50_ms", stats.update_p50_us / 1000.0);
+        cJSON_AddNumberToObject(item, "update_p99_ms", stats.update_p99_us / 1000.0);
+        cJSON_AddNumberToObject(item, "update_max_ms", stats.update_max_us / 1000.0);
+        cJSON_AddNumberToObject(item, "update_count", stats.update_count);
+        cJSON_AddNumberToObject(item, "error_count", stats.error_count);
+        cJSON_AddNumberToObject(item, "throttle_count", stats.throttle_count);
+        cJSON_AddNumberToObject(item, "unchanged_updates", stats.unchanged_updates);
+        cJSON_AddNumberToObject(item, "api_calls", stats.api_calls_count);
+        cJSON_AddNumberToObject(item, "rate_limited", stats.rate_limited_count);
+        cJSON_AddNumberToObject(item, "memory_limit", stats.memory_limit);
+        cJSON_AddNumberToObject(item, "memory_used", stats.memory_used);
+        cJSON_AddNumberToObject(item, "memory_peak", stats.memory_peak);
+        cJSON_AddItemToArray(list, item);
+    }
+
+    cJSON_AddItemToObject(json, "plugins", list);
+    cJSON_AddNumberToObject(json, "memory_pool_size", CONFIG_PIN_PLUGIN_HEAP_SIZE);
+    cJSON_AddNumberToObject(json, "memory_pool_free", pin_arena_pool_free());
+    cJSON_AddNumberToObject(json, "uptime_ms", esp_timer_get_time() / 1000);
+
+    return send_json_response(req, json, 200);
+}
+
+static esp_err_t api_boot_timeline_handler(httpd_req_t *req) {
+    pin_init_record_t records[PIN_INIT_MAX_STAGES];
+    uint8_t count = 0;
+    if (pin_init_get_timeline(records, PIN_INIT_MAX_STAGES, &count) != ESP_OK) {
+        return send_error_response(req, 500, "Failed to read boot timeline");
+    }
+
+    cJSON *json = cJSON_CreateObject();
+    cJSON *list = cJSON_CreateArray();
+    int64_t boot_end_us = 0;
+    int64_t serial_us = 0;
+
+    for (uint8_t i = 0; i < count; i++) {
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "name", records[i].name);
+        cJSON_AddStringToObject(item, "state", pin_init_state_name(records[i].state));
+        cJSON_AddStringToObject(item, "result", esp_err_to_name(records[i].result));
+        cJSON_AddNumberToObject(item, "start_ms", records[i].start_us / 1000.0);
+        cJSON_AddNumberToObject(item, "end_ms", records[i].end_us / 1000.0);
+        if (records[i].start_us > 0) {
+            cJSON_AddNumberToObject(item, "duration_ms", (records[i].end_us - records[i].start_us) / 1000.0);
+            serial_us += records[i].end_us - records[i].start_us;
+        }
+        if (records[i].end_us > boot_end_us) {
+            boot_end_us = records[i].end_us;
+        }
+        cJSON_AddItemToArray(list, item);
+    }
+
+    cJSON_AddItemToObject(json, "stages", list);
+    cJSON_AddNumberToObject(json, "boot_ms", boot_end_us / 1000.0);
+    cJSON_AddNumberToObject(json, "serial_ms", serial_us / 1000.0);
+
+    return send_json_response(req, json, 200);
+}
+
+// Power state statistics
+static esp_err_t api_power_stats_handler(httpd_req_t *req) {
+    pin_power_stats_t stats;
+    if (pin_power_get_stats(&stats) != ESP_OK) {
+        return send_error_response(req, 500, "Failed to read power statistics");
+    }
+
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddBoolToObject(json, "dfs_enabled", stats.dfs_enabled);
+    cJSON_AddBoolToObject(json, "light_sleep_enabled", stats.light_sleep_enabled);
+    cJSON_AddNumberToObject(json, "uptime_ms", stats.uptime_us / 1000.0);
+
+    cJSON *states = cJSON_CreateObject();
+    cJSON_AddNumberToObject(states, "active_ms", stats.active_us / 1000.0);
+    cJSON_AddNumberToObject(states, "idle_ms", stats.idle_us / 1000.0);
+    cJSON_AddNumberToObject(states, "light_sleep_ms", stats.light_sleep_us / 1000.0);
+    cJSON_AddItemToObject(json, "states", states);
+
+    cJSON *clients = cJSON_CreateArray();
+    for (int i = 0; i < PIN_POWER_CLIENT_COUNT; i++) {
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "name", pin_power_client_name((pin_power_client_t)i));
+        cJSON_AddNumberToObject(item, "active_ms", stats.clients[i].active_us / 1000.0);
+        cJSON_AddNumberToObject(item, "acquisitions", stats.clients[i].acquisitions);
+        cJSON_AddItemToArray(clients, item);
+    }
+    cJSON_AddItemToObject(json, "clients", clients);
+
+    return send_json_response(req, json, 200);
+}
+
 // Canvas API handlers
+
+// Same layout as pin_canvas_export_json(), streamed instead of printed
+static void write_canvas_json(pin_json_writer_t *w, const pin_canvas_t *canvas) {
+    pin_json_writer_object_begin(w, NULL);
+    pin_json_writer_string(w, "id", canvas->id);
+    pin_json_writer_string(w, "name", canvas->name);
+    pin_json_writer_int(w, "background_color", canvas->background_color);
+    pin_json_writer_int(w, "created_time", canvas->created_time);
+    pin_json_writer_int(w, "modified_time", canvas->modified_time);
+
+    pin_json_writer_array_begin(w, "elements");
+    for (int i = 0; i < canvas->element_count; i++) {
+        const pin_canvas_element_t *elem = &canvas->elements[i];
+
+        pin_json_writer_object_begin(w, NULL);
+        pin_json_writer_string(w, "id", elem->id);
+        pin_json_writer_int(w, "type", elem->type);
+        pin_json_writer_int(w, "x", elem->bounds.position.x);
+        pin_json_writer_int(w, "y", elem->bounds.position.y);
+        pin_json_writer_int(w, "width", elem->bounds.size.width);
+        pin_json_writer_int(w, "height", elem->bounds.size.height);
+        pin_json_writer_int(w, "z_index", elem->z_index);
+        pin_json_writer_bool(w, "visible", elem->visible);
+
+        pin_json_writer_object_begin(w, "props");
+        switch (elem->type) {
+            case PIN_CANVAS_ELEMENT_TEXT:
+                pin_json_writer_string(w, "text", elem->props.text.text);
+                pin_json_writer_int(w, "font_size", elem->props.text.font_size);
+                pin_json_writer_int(w, "color", elem->props.text.color);
+                pin_json_writer_int(w, "align", elem->props.text.align);
+                pin_json_writer_bool(w, "bold", elem->props.text.bold);
+                pin_json_writer_bool(w, "italic", elem->props.text.italic);
+                break;
+            case PIN_CANVAS_ELEMENT_IMAGE:
+                pin_json_writer_string(w, "image_id", elem->props.image.image_id);
+                pin_json_writer_int(w, "format", elem->props.image.format);
+                pin_json_writer_bool(w, "maintain_aspect_ratio", elem->props.image.maintain_aspect_ratio);
+                pin_json_writer_int(w, "opacity", elem->props.image.opacity);
+                break;
+            default:
+                pin_json_writer_int(w, "fill_color", elem->props.shape.fill_color);
+                pin_json_writer_int(w, "border_color", elem->props.shape.border_color);
+                pin_json_writer_int(w, "border_width", elem->props.shape.border_width);
+                pin_json_writer_bool(w, "filled", elem->props.shape.filled);
+                break;
+        }
+        pin_json_writer_object_end(w);
+        pin_json_writer_object_end(w);
+    }
+    pin_json_writer_array_end(w);
+    pin_json_writer_object_end(w);
+}
+
+static uint32_t query_get_uint(const char *query, const char *key, uint32_t default_value) {
+    char value[16];
+    if (!query || httpd_query_key_value(query, key, value, sizeof(value)) != ESP_OK) {
+        return default_value;
+    }
+    return (uint32_t)strtoul(value, NULL, 10);
+}
+
+// The canvas id comes from ?id=, which may sit among other parameters such as pretty
+static bool query_get_canvas_id(httpd_req_t *req, char *canvas_id, size_t size) {
+    char query[96];
+    return httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+           httpd_query_key_value(query, "id", canvas_id, size) == ESP_OK &&
+           canvas_id[0] != '\0';
+}
+
+// GET /api/canvas?offset=&limit=&modified_since= lists summaries from the canvas index
 static esp_err_t canvas_list_handler(httpd_req_t *req) {
     if (!g_canvas_handle) {
         return send_error_response(req, 500, "Canvas system not initialized");
     }
 
-    char canvas_ids[50][32];
-    size_t count;
-    esp_err_t ret = pin_canvas_list(g_canvas_handle, canvas_ids, 50, &count);
-    
+    char query[96];
+    bool has_query = httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK;
+    size_t offset = query_get_uint(has_query ? query : NULL, "offset", 0);
+    size_t limit = query_get_uint(has_query ? query : NULL, "limit", PIN_CANVAS_INDEX_MAX);
+    uint32_t modified_since = query_get_uint(has_query ? query : NULL, "modified_since", 0);
+
+    // Copied out of the index a few at a time so the mutex is not held while sending
+    pin_canvas_meta_t batch[CANVAS_LIST_BATCH];
+    size_t count = 0;
+    size_t total = 0;
+    esp_err_t ret = pin_canvas_list_meta(g_canvas_handle, modified_since, offset, batch,
+                                         MIN(limit, CANVAS_LIST_BATCH), &count, &total);
     if (ret != ESP_OK) {
         return send_error_response(req, 500, "Failed to list canvases");
     }
 
-    cJSON *json = cJSON_CreateObject();
-    cJSON *canvases = cJSON_CreateArray();
-
-    for (size_t i = 0; i < count; i++) {
-        pin_canvas_t canvas;
-        ret = pin_canvas_get(g_canvas_handle, canvas_ids[i], &canvas);
-        if (ret == ESP_OK) {
-            cJSON *canvas_info = cJSON_CreateObject();
-            cJSON_AddStringToObject(canvas_info, "id", canvas.id);
-            cJSON_AddStringToObject(canvas_info, "name", canvas.name);
-            cJSON_AddNumberToObject(canvas_info, "created_time", canvas.created_time);
-            cJSON_AddNumberToObject(canvas_info, "modified_time", canvas.modified_time);
-            cJSON_AddNumberToObject(canvas_info, "element_count", canvas.element_count);
-            cJSON_AddItemToArray(canvases, canvas_info);
+    pin_json_writer_t w;
+    json_response_begin(req, &w, 200);
+    pin_json_writer_object_begin(&w, NULL);
+    pin_json_writer_array_begin(&w, "canvases");
+
+    size_t written = 0;
+    while (count > 0) {
+        for (size_t i = 0; i < count; i++) {
+            pin_json_writer_object_begin(&w, NULL);
+            pin_json_writer_string(&w, "id", batch[i].id);
+            pin_json_writer_string(&w, "name", batch[i].name);
+            pin_json_writer_int(&w, "created_time", batch[i].created_time);
+            pin_json_writer_int(&w, "modified_time", batch[i].modified_time);
+            pin_json_writer_int(&w, "element_count", batch[i].element_count);
+            pin_json_writer_object_end(&w);
+        }
+        written += count;
+        if (written >= limit ||
+            pin_canvas_list_meta(g_canvas_handle, modified_since, offset + written, batch,
+                                 MIN(limit - written, CANVAS_LIST_BATCH), &count, NULL) != ESP_OK) {
+            break;
         }
     }
 
-    cJSON_AddItemToObject(json, "canvases", canvases);
-    cJSON_AddNumberToObject(json, "total", count);
-
-    return send_json_response(req, json, 200);
+    pin_json_writer_array_end(&w);
+    pin_json_writer_int(&w, "total", total);
+    pin_json_writer_int(&w, "offset", offset);
+    pin_json_writer_int(&w, "limit", limit);
+    pin_json_writer_object_end(&w);
+    return json_response_end(req, &w);
 }
 
 static esp_err_t canvas_create_handler(httpd_req_t *req) {
@@ -308,28 +582,26 @@ static esp_err_t canvas_get_handler(httpd_req_t *req) {
     }
 
     char canvas_id[32];
-    if (httpd_req_get_url_query_str(req, canvas_id, sizeof(canvas_id)) != ESP_OK) {
+    if (!query_get_canvas_id(req, canvas_id, sizeof(canvas_id))) {
         return send_error_response(req, 400, "Missing canvas_id parameter");
     }
 
-    // Extract canvas_id from query string
-    char *id_param = strstr(canvas_id, "id=");
-    if (!id_param) {
-        return send_error_response(req, 400, "Missing canvas_id parameter");
+    pin_canvas_t *canvas = malloc(sizeof(pin_canvas_t));
+    if (!canvas) {
+        return send_error_response(req, 500, "Failed to allocate memory");
     }
-    id_param += 3; // Skip "id="
 
-    char *json_str;
-    esp_err_t ret = pin_canvas_export_json(g_canvas_handle, id_param, &json_str);
+    esp_err_t ret = pin_canvas_get(g_canvas_handle, canvas_id, canvas);
     if (ret != ESP_OK) {
+        free(canvas);
         return send_error_response(req, 404, "Canvas not found");
     }
 
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, json_str, strlen(json_str));
-    free(json_str);
-
-    return ESP_OK;
+    pin_json_writer_t w;
+    json_response_begin(req, &w, 200);
+    write_canvas_json(&w, canvas);
+    free(canvas);
+    return json_response_end(req, &w);
 }
 
 static esp_err_t canvas_update_handler(httpd_req_t *req) {
@@ -361,18 +633,11 @@ static esp_err_t canvas_delete_handler(httpd_req_t *req) {
     }
 
     char canvas_id[32];
-    if (httpd_req_get_url_query_str(req, canvas_id, sizeof(canvas_id)) != ESP_OK) {
-        return send_error_response(req, 400, "Missing canvas_id parameter");
-    }
-
-    // Extract canvas_id from query string
-    char *id_param = strstr(canvas_id, "id=");
-    if (!id_param) {
+    if (!query_get_canvas_id(req, canvas_id, sizeof(canvas_id))) {
         return send_error_response(req, 400, "Missing canvas_id parameter");
     }
-    id_param += 3; // Skip "id="
 
-    esp_err_t ret = pin_canvas_delete(g_canvas_handle, id_param);
+    esp_err_t ret = pin_canvas_delete(g_canvas_handle, canvas_id);
     if (ret != ESP_OK) {
         return send_error_response(req, 404, "Canvas not found or failed to delete");
     }
@@ -383,6 +648,13 @@ static esp_err_t canvas_delete_handler(httpd_req_t *req) {
     return send_json_response(req, response, 200);
 }
 
+static esp_err_t canvas_display_job(void *arg) {
+    esp_err_t ret = pin_canvas_display(g_canvas_handle, (const char *)arg);
+    // The canvas covers the whole panel, plugin widgets included
+    pin_display_invalidate();
+    return ret;
+}
+
 static esp_err_t canvas_display_handler(httpd_req_t *req) {
     if (!g_canvas_handle) {
         return send_error_response(req, 500, "Canvas system not initialized");
@@ -406,17 +678,19 @@ static esp_err_t canvas_display_handler(httpd_req_t *req) {
         return send_error_response(req, 400, "Missing canvas_id field");
     }
 
-    esp_err_t ret = pin_canvas_display(g_canvas_handle, canvas_id_item->valuestring);
+    // The job keeps its own copy of the id
+    char canvas_id[PIN_JOBS_ARG_MAX_LEN] = {0};
+    bool id_fits = strlen(canvas_id_item->valuestring) < sizeof(canvas_id);
+    if (id_fits) {
+        strcpy(canvas_id, canvas_id_item->valuestring);
+    }
     cJSON_Delete(json);
 
-    if (ret != ESP_OK) {
-        return send_error_response(req, 500, "Failed to display canvas");
+    if (!id_fits) {
+        return send_error_response(req, 400, "canvas_id too long");
     }
 
-    cJSON *response = cJSON_CreateObject();
-    cJSON_AddStringToObject(response, "message", "Canvas displayed successfully");
-
-    return send_json_response(req, response, 200);
+    return submit_job(req, "canvas_display", canvas_display_job, canvas_id, sizeof(canvas_id));
 }
 
 static esp_err_t canvas_element_add_handler(httpd_req_t *req) {
@@ -501,76 +775,212 @@ static esp_err_t image_upload_handler(httpd_req_t *req) {
         return send_error_response(req, 400, "Missing image_id parameter");
     }
 
-    // Allocate buffer for image data
-    size_t content_len = req->content_len;
-    if (content_len > PIN_CANVAS_MAX_IMAGE_SIZE) {
-        return send_error_response(req, 413, "Image too large");
+    // Stream the body to flash; only one chunk is ever held in RAM
+    pin_canvas_image_writer_t writer = NULL;
+    esp_err_t ret = pin_canvas_image_begin(g_canvas_handle, image_id, req->content_len, &writer);
+    if (ret == ESP_ERR_NO_MEM) {
+        return send_error_response(req, 413, "Image too large for free storage");
+    } else if (ret == ESP_ERR_INVALID_ARG) {
+        return send_error_response(req, 400, "Invalid image_id or empty image");
+    } else if (ret != ESP_OK) {
+        return send_error_response(req, 500, "Image storage unavailable");
     }
 
-    uint8_t *buffer = malloc(content_len);
-    if (!buffer) {
+    char *chunk = malloc(IMAGE_UPLOAD_CHUNK_SIZE);
+    if (!chunk) {
+        pin_canvas_image_abort(writer);
         return send_error_response(req, 500, "Failed to allocate memory");
     }
 
-    // Read image data
     size_t received = 0;
-    while (received < content_len) {
-        size_t ret = httpd_req_recv(req, (char*)buffer + received, content_len - received);
-        if (ret <= 0) {
-            free(buffer);
+    while (received < req->content_len) {
+        size_t want = req->content_len - received;
+        int n = httpd_req_recv(req, chunk, want < IMAGE_UPLOAD_CHUNK_SIZE ? want : IMAGE_UPLOAD_CHUNK_SIZE);
+        if (n == HTTPD_SOCK_ERR_TIMEOUT) {
+            continue;
+        }
+        if (n <= 0) {
+            free(chunk);
+            pin_canvas_image_abort(writer);
             return send_error_response(req, 400, "Failed to receive image data");
         }
-        received += ret;
-    }
-
-    // Detect image format (simple detection)
-    pin_canvas_image_format_t format = PIN_CANVAS_IMAGE_BMP;
-    if (content_len >= 8) {
-        if (buffer[0] == 0x89 && buffer[1] == 0x50 && buffer[2] == 0x4E && buffer[3] == 0x47) {
-            format = PIN_CANVAS_IMAGE_PNG;
-        } else if (buffer[0] == 0xFF && buffer[1] == 0xD8) {
-            format = PIN_CANVAS_IMAGE_JPG;
+        ret = pin_canvas_image_write(writer, (const uint8_t *)chunk, n);
+        if (ret != ESP_OK) {
+            free(chunk);
+            pin_canvas_image_abort(writer);
+            return send_error_response(req, 500, "Failed to store image");
         }
+        received += n;
     }
+    free(chunk);
 
-    esp_err_t ret = pin_canvas_store_image(g_canvas_handle, image_id, buffer, content_len, format);
-    free(buffer);
-
+    pin_canvas_image_info_t info;
+    ret = pin_canvas_image_commit(writer, &info);
     if (ret != ESP_OK) {
         return send_error_response(req, 500, "Failed to store image");
     }
 
+    char sha256[65];
+    for (int i = 0; i < 32; i++) {
+        snprintf(sha256 + i * 2, 3, "%02x", info.sha256[i]);
+    }
+
     cJSON *response = cJSON_CreateObject();
     cJSON_AddStringToObject(response, "message", "Image uploaded successfully");
     cJSON_AddStringToObject(response, "image_id", image_id);
-    cJSON_AddNumberToObject(response, "format", format);
-    cJSON_AddNumberToObject(response, "size", content_len);
+    cJSON_AddNumberToObject(response, "format", info.format);
+    cJSON_AddNumberToObject(response, "size", info.size);
+    cJSON_AddStringToObject(response, "sha256", sha256);
 
     return send_json_response(req, response, 201);
 }
 
+// Job API handlers
+static void write_job_json(pin_json_writer_t *w, const pin_job_info_t *info) {
+    pin_json_writer_object_begin(w, NULL);
+    pin_json_writer_int(w, "id", info->id);
+    pin_json_writer_string(w, "name", info->name);
+    pin_json_writer_string(w, "state", pin_jobs_state_name(info->state));
+    if (info->state == PIN_JOB_STATE_FAILED) {
+        pin_json_writer_string(w, "error", esp_err_to_name(info->result));
+    }
+    pin_json_writer_int(w, "queued_ms", info->queued_ms);
+    pin_json_writer_int(w, "run_ms", info->run_ms);
+    pin_json_writer_int(w, "age_ms", info->age_ms);
+    pin_json_writer_object_end(w);
+}
+
+static esp_err_t jobs_list_handler(httpd_req_t *req) {
+    pin_job_info_t infos[PIN_JOBS_MAX];
+    size_t count = 0;
+    pin_jobs_list(infos, PIN_JOBS_MAX, &count);
+    
+    pin_json_writer_t w;
+    json_response_begin(req, &w, 200);
+    pin_json_writer_object_begin(&w, NULL);
+    pin_json_writer_array_begin(&w, "jobs");
+    for (size_t i = 0; i < count; i++) {
+        write_job_json(&w, &infos[i]);
+    }
+    pin_json_writer_array_end(&w);
+    pin_json_writer_object_end(&w);
+    return json_response_end(req, &w);
+}
+
+// GET /api/jobs/{id}
+static esp_err_t job_get_handler(httpd_req_t *req) {
+    const char *id_str = req->uri + strlen("/api/jobs/");
+    char *end = NULL;
+    unsigned long id = strtoul(id_str, &end, 10);
+    if (end == id_str || (*end != '\0' && *end != '?')) {
+        return send_error_response(req, 400, "Invalid job id");
+    }
+    
+    pin_job_info_t info;
+    if (pin_jobs_get((uint32_t)id, &info) != ESP_OK) {
+        return send_error_response(req, 404, "Job not found");
+    }
+    
+    pin_json_writer_t w;
+    json_response_begin(req, &w, 200);
+    write_job_json(&w, &info);
+    return json_response_end(req, &w);
+}
+
 // Device status handler (basic implementation)
 // Helper functions implementation
-static esp_err_t send_json_response(httpd_req_t *req, cJSON *json, int status_code) {
-    char *json_str = cJSON_Print(json);
-    if (!json_str) {
-        cJSON_Delete(json);
-        return send_error_response(req, 500, "Failed to serialize JSON");
+// Queue a long operation and answer 202 with where to poll for it
+static esp_err_t submit_job(httpd_req_t *req, const char *name, pin_job_fn_t fn, const void *arg, size_t arg_size) {
+    uint32_t id;
+    esp_err_t ret = pin_jobs_submit(name, fn, arg, arg_size, &id);
+    if (ret == ESP_ERR_NO_MEM) {
+        return send_error_response(req, 503, "Too many jobs pending");
+    } else if (ret != ESP_OK) {
+        return send_error_response(req, 500, "Failed to queue job");
     }
+    
+    char location[32];
+    snprintf(location, sizeof(location), "/api/jobs/%lu", (unsigned long)id);
+    httpd_resp_set_hdr(req, "Location", location);
+    
+    pin_json_writer_t w;
+    json_response_begin(req, &w, 202);
+    pin_json_writer_object_begin(&w, NULL);
+    pin_json_writer_int(&w, "job_id", id);
+    pin_json_writer_string(&w, "status_url", location);
+    pin_json_writer_object_end(&w);
+    return json_response_end(req, &w);
+}
+
+static esp_err_t json_chunk_flush(const char *data, size_t len, void *ctx) {
+    return httpd_resp_send_chunk((httpd_req_t *)ctx, data, len);
+}
+
+// Responses are compact unless the query has pretty=1
+static void json_response_begin(httpd_req_t *req, pin_json_writer_t *writer, int status_code) {
+    // Every API request means someone is using the device
+    pin_sleep_note_activity();
+
+    char query[64];
+    char pretty[4];
+    bool formatted = httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+                     httpd_query_key_value(query, "pretty", pretty, sizeof(pretty)) == ESP_OK &&
+                     strcmp(pretty, "1") == 0;
 
     httpd_resp_set_type(req, "application/json");
     httpd_resp_set_status(req, status_code == 200 ? "200 OK" : 
                               status_code == 201 ? "201 Created" :
+                              status_code == 202 ? "202 Accepted" :
                               status_code == 400 ? "400 Bad Request" :
                               status_code == 404 ? "404 Not Found" :
-                              status_code == 500 ? "500 Internal Server Error" : "200 OK");
-    
-    esp_err_t ret = httpd_resp_send(req, json_str, strlen(json_str));
-    
-    free(json_str);
+                              status_code == 413 ? "413 Payload Too Large" :
+                              status_code == 500 ? "500 Internal Server Error" :
+                              status_code == 503 ? "503 Service Unavailable" : "200 OK");
+    pin_json_writer_init(writer, json_chunk_flush, req, formatted);
+}
+
+// Once the first chunk is out the status is sent, so a failure can only drop the connection
+static esp_err_t json_response_end(httpd_req_t *req, pin_json_writer_t *writer) {
+    esp_err_t ret = pin_json_writer_finish(writer);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "JSON response aborted after %u bytes: %s", (unsigned)writer->total, esp_err_to_name(ret));
+        return ret;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+static void write_cjson(pin_json_writer_t *writer, const char *key, const cJSON *item) {
+    const cJSON *child;
+    if (cJSON_IsObject(item)) {
+        pin_json_writer_object_begin(writer, key);
+        cJSON_ArrayForEach(child, item) {
+            write_cjson(writer, child->string, child);
+        }
+        pin_json_writer_object_end(writer);
+    } else if (cJSON_IsArray(item)) {
+        pin_json_writer_array_begin(writer, key);
+        cJSON_ArrayForEach(child, item) {
+            write_cjson(writer, NULL, child);
+        }
+        pin_json_writer_array_end(writer);
+    } else if (cJSON_IsString(item)) {
+        pin_json_writer_string(writer, key, item->valuestring);
+    } else if (cJSON_IsNumber(item)) {
+        pin_json_writer_number(writer, key, item->valuedouble);
+    } else if (cJSON_IsBool(item)) {
+        pin_json_writer_bool(writer, key, cJSON_IsTrue(item));
+    } else {
+        pin_json_writer_null(writer, key);
+    }
+}
+
+// Handlers that still build a cJSON tree stream it without a printed copy
+static esp_err_t send_json_response(httpd_req_t *req, cJSON *json, int status_code) {
+    pin_json_writer_t w;
+    json_response_begin(req, &w, status_code);
+    write_cjson(&w, NULL, json);
     cJSON_Delete(json);
-    
-    return ret;
+    return json_response_end(req, &w);
 }
 
 static esp_err_t send_error_response(httpd_req_t *req, int status_code, const char *message) {
@@ -611,10 +1021,35 @@ esp_err_t pin_webserver_init(pin_canvas_handle_t canvas_handle) {
     return ESP_OK;
 }
 
+// Every handler runs at full clock; idle connections do not hold it
+static esp_err_t webserver_dispatch(httpd_req_t *req) {
+    esp_err_t (*handler)(httpd_req_t *req) = (esp_err_t (*)(httpd_req_t *))req->user_ctx;
+    pin_power_acquire(PIN_POWER_CLIENT_HTTP);
+    esp_err_t ret = handler(req);
+    pin_power_release(PIN_POWER_CLIENT_HTTP);
+    return ret;
+}
+
+static esp_err_t webserver_register(const httpd_uri_t *uri) {
+    httpd_uri_t wrapped = *uri;
+    wrapped.handler = webserver_dispatch;
+    wrapped.user_ctx = (void *)uri->handler;
+    return httpd_register_uri_handler(server, &wrapped);
+}
+
+// A new connection keeps the device awake, e.g. while the web UI loads
+static esp_err_t webserver_session_open(httpd_handle_t hd, int sockfd) {
+    pin_sleep_note_activity();
+    return ESP_OK;
+}
+
 esp_err_t pin_webserver_start(void) {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.lru_purge_enable = true;
     config.server_port = 80;
+    config.max_uri_handlers = 32;
+    config.open_fn = webserver_session_open;
+    config.uri_match_fn = httpd_uri_match_wildcard;     // For /api/jobs/{id}
 
     ESP_LOGI(TAG, "Starting web server on port %d", config.server_port);
 
@@ -630,7 +1065,7 @@ esp_err_t pin_webserver_start(void) {
         .handler = index_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &index_uri);
+    webserver_register(&index_uri);
 
     httpd_uri_t app_js_uri = {
         .uri = "/app.js",
@@ -638,7 +1073,7 @@ esp_err_t pin_webserver_start(void) {
         .handler = app_js_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &app_js_uri);
+    webserver_register(&app_js_uri);
 
     httpd_uri_t manifest_uri = {
         .uri = "/manifest.json",
@@ -646,7 +1081,7 @@ esp_err_t pin_webserver_start(void) {
         .handler = manifest_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &manifest_uri);
+    webserver_register(&manifest_uri);
 
     httpd_uri_t sw_uri = {
         .uri = "/sw.js",
@@ -654,7 +1089,7 @@ esp_err_t pin_webserver_start(void) {
         .handler = sw_js_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &sw_uri);
+    webserver_register(&sw_uri);
 
     // API endpoints
     httpd_uri_t status_uri = {
@@ -663,7 +1098,7 @@ esp_err_t pin_webserver_start(void) {
         .handler = api_status_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &status_uri);
+    webserver_register(&status_uri);
     
     // Display control endpoints
     httpd_uri_t display_refresh_uri = {
@@ -672,7 +1107,7 @@ esp_err_t pin_webserver_start(void) {
         .handler = api_display_refresh_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &display_refresh_uri);
+    webserver_register(&display_refresh_uri);
     
     httpd_uri_t display_clear_uri = {
         .uri = "/api/display/clear", 
@@ -680,7 +1115,7 @@ esp_err_t pin_webserver_start(void) {
         .handler = api_display_clear_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &display_clear_uri);
+    webserver_register(&display_clear_uri);
     
     // OTA API endpoints
     httpd_uri_t ota_status_uri = {
@@ -689,7 +1124,7 @@ esp_err_t pin_webserver_start(void) {
         .handler = api_ota_status_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &ota_status_uri);
+    webserver_register(&ota_status_uri);
     
     httpd_uri_t ota_check_uri = {
         .uri = "/api/ota/check",
@@ -697,7 +1132,7 @@ esp_err_t pin_webserver_start(void) {
         .handler = api_ota_check_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &ota_check_uri);
+    webserver_register(&ota_check_uri);
     
     httpd_uri_t ota_update_uri = {
         .uri = "/api/ota/update",
@@ -705,7 +1140,7 @@ esp_err_t pin_webserver_start(void) {
         .handler = api_ota_update_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &ota_update_uri);
+    webserver_register(&ota_update_uri);
     
     httpd_uri_t ota_cancel_uri = {
         .uri = "/api/ota/cancel",
@@ -713,7 +1148,7 @@ esp_err_t pin_webserver_start(void) {
         .handler = api_ota_cancel_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &ota_cancel_uri);
+    webserver_register(&ota_cancel_uri);
     
     httpd_uri_t ota_rollback_uri = {
         .uri = "/api/ota/rollback",
@@ -721,7 +1156,34 @@ esp_err_t pin_webserver_start(void) {
         .handler = api_ota_rollback_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &ota_rollback_uri);
+    webserver_register(&ota_rollback_uri);
+
+    // Plugin API endpoints
+    httpd_uri_t plugins_stats_uri = {
+        .uri = "/api/plugins/stats",
+        .method = HTTP_GET,
+        .handler = api_plugins_stats_handler,
+        .user_ctx = NULL
+    };
+    webserver_register(&plugins_stats_uri);
+
+    // Boot timeline
+    httpd_uri_t boot_timeline_uri = {
+        .uri = "/api/boot/timeline",
+        .method = HTTP_GET,
+        .handler = api_boot_timeline_handler,
+        .user_ctx = NULL
+    };
+    webserver_register(&boot_timeline_uri);
+
+    // Power statistics
+    httpd_uri_t power_stats_uri = {
+        .uri = "/api/power/stats",
+        .method = HTTP_GET,
+        .handler = api_power_stats_handler,
+        .user_ctx = NULL
+    };
+    webserver_register(&power_stats_uri);
 
     // Canvas API endpoints
     httpd_uri_t canvas_list_uri = {
@@ -730,7 +1192,7 @@ esp_err_t pin_webserver_start(void) {
         .handler = canvas_list_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &canvas_list_uri);
+    webserver_register(&canvas_list_uri);
 
     httpd_uri_t canvas_create_uri = {
         .uri = "/api/canvas",
@@ -738,7 +1200,7 @@ esp_err_t pin_webserver_start(void) {
         .handler = canvas_create_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &canvas_create_uri);
+    webserver_register(&canvas_create_uri);
 
     httpd_uri_t canvas_get_uri = {
         .uri = "/api/canvas/get",
@@ -746,7 +1208,7 @@ esp_err_t pin_webserver_start(void) {
         .handler = canvas_get_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &canvas_get_uri);
+    webserver_register(&canvas_get_uri);
 
     httpd_uri_t canvas_update_uri = {
         .uri = "/api/canvas/update",
@@ -754,7 +1216,7 @@ esp_err_t pin_webserver_start(void) {
         .handler = canvas_update_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &canvas_update_uri);
+    webserver_register(&canvas_update_uri);
 
     httpd_uri_t canvas_delete_uri = {
         .uri = "/api/canvas/delete",
@@ -762,7 +1224,7 @@ esp_err_t pin_webserver_start(void) {
         .handler = canvas_delete_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &canvas_delete_uri);
+    webserver_register(&canvas_delete_uri);
 
     httpd_uri_t canvas_display_uri = {
         .uri = "/api/canvas/display",
@@ -770,7 +1232,7 @@ esp_err_t pin_webserver_start(void) {
         .handler = canvas_display_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &canvas_display_uri);
+    webserver_register(&canvas_display_uri);
 
     httpd_uri_t canvas_element_add_uri = {
         .uri = "/api/canvas/element",
@@ -778,7 +1240,7 @@ esp_err_t pin_webserver_start(void) {
         .handler = canvas_element_add_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &canvas_element_add_uri);
+    webserver_register(&canvas_element_add_uri);
 
     httpd_uri_t image_upload_uri = {
         .uri = "/api/images",
@@ -786,7 +1248,24 @@ esp_err_t pin_webserver_start(void) {
         .handler = image_upload_handler,
         .user_ctx = NULL
     };
-    httpd_register_uri_handler(server, &image_upload_uri);
+    webserver_register(&image_upload_uri);
+
+    // Job API
+    httpd_uri_t jobs_list_uri = {
+        .uri = "/api/jobs",
+        .method = HTTP_GET,
+        .handler = jobs_list_handler,
+        .user_ctx = NULL
+    };
+    webserver_register(&jobs_list_uri);
+
+    httpd_uri_t job_get_uri = {
+        .uri = "/api/jobs/*",
+        .method = HTTP_GET,
+        .handler = job_get_handler,
+        .user_ctx = NULL
+    };
+    webserver_register(&job_get_uri);
 
     ESP_LOGI(TAG, "Web server started with Canvas API endpoints");
     return ESP_OK;
@@ -4,6 +4,7 @@
  */
 
 #include <string.h>
+#include <time.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
@@ -11,22 +12,254 @@
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
 #include "pin_wifi.h"
 #include "pin_config.h"
+#include "pin_retain.h"
 
 static const char *TAG = "PIN_WIFI";
 
+#define PIN_WIFI_FAST_NAME "wifi.fast"
+#define PIN_WIFI_FAST_VERSION 1
+
+// Last successful association, kept in RTC memory over deep sleep
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t bssid[6];
+    uint8_t channel;
+    bool has_lease;
+    esp_netif_ip_info_t ip;
+    esp_ip4_addr_t dns;
+    int64_t lease_time;         // Wall clock seconds when DHCP handed out ip
+} pin_wifi_fast_cache_t;
+
+typedef enum {
+    PIN_WIFI_ATTEMPT_NONE,      // Connected, or not trying
+    PIN_WIFI_ATTEMPT_FAST,      // Cached BSSID and channel, no scan
+    PIN_WIFI_ATTEMPT_SCAN       // Full scan
+} pin_wifi_attempt_t;
+
+static struct {
+    esp_netif_t *sta_netif;
+    pin_wifi_fast_cache_t cache;
+    bool cache_valid;
+    pin_wifi_attempt_t attempt;
+    bool static_ip;             // The current attempt reuses the cached lease
+    int64_t attempt_start_us;
+    uint8_t retries;
+    esp_timer_handle_t retry_timer;
+    EventGroupHandle_t events;  // WIFI_CONNECTED_BIT while the station has an address
+    bool radio_off;             // Stopped on purpose, do not reconnect
+    int64_t radio_on_since_us;  // 0 while the station is stopped
+    pin_wifi_stats_t stats;
+} g_wifi = {0};
+
+// Stats are written on the event loop task and read by the web server
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void pin_wifi_use_dhcp(void) {
+    if (g_wifi.static_ip) {
+        esp_netif_dhcpc_start(g_wifi.sta_netif);
+        g_wifi.static_ip = false;
+    }
+}
+
+// A lease is only reused while the router has surely not handed the address to someone else
+static bool pin_wifi_use_cached_lease(void) {
+    int64_t age = (int64_t)time(NULL) - g_wifi.cache.lease_time;
+    if (!g_wifi.cache.has_lease || age < 0 || age > PIN_WIFI_LEASE_REUSE_S) {
+        return false;
+    }
+
+    esp_netif_dhcpc_stop(g_wifi.sta_netif);
+    if (esp_netif_set_ip_info(g_wifi.sta_netif, &g_wifi.cache.ip) != ESP_OK) {
+        esp_netif_dhcpc_start(g_wifi.sta_netif);
+        return false;
+    }
+    esp_netif_dns_info_t dns = {0};
+    dns.ip.type = ESP_IPADDR_TYPE_V4;
+    dns.ip.u_addr.ip4 = g_wifi.cache.dns;
+    esp_netif_set_dns_info(g_wifi.sta_netif, ESP_NETIF_DNS_MAIN, &dns);
+    return true;
+}
+
+static void pin_wifi_configure_scan(wifi_config_t *config) {
+    config->sta.bssid_set = false;
+    config->sta.channel = 0;
+    config->sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+    config->sta.sort_method = WIFI_CONNECT_AP_BY_SIGNAL;
+    pin_wifi_use_dhcp();
+    g_wifi.attempt = PIN_WIFI_ATTEMPT_SCAN;
+}
+
+// Start connecting to the saved network, directly to the last AP if it is known
+static void pin_wifi_begin_attempt(void) {
+    wifi_config_t config;
+    if (esp_wifi_get_config(WIFI_IF_STA, &config) != ESP_OK || config.sta.ssid[0] == '\0') {
+        return;
+    }
+
+    g_wifi.attempt_start_us = esp_timer_get_time();
+    g_wifi.retries = 0;
+
+    if (g_wifi.cache_valid && memcmp(g_wifi.cache.ssid, config.sta.ssid, sizeof(config.sta.ssid)) == 0) {
+        config.sta.bssid_set = true;
+        memcpy(config.sta.bssid, g_wifi.cache.bssid, sizeof(config.sta.bssid));
+        config.sta.channel = g_wifi.cache.channel;
+        config.sta.scan_method = WIFI_FAST_SCAN;
+        g_wifi.static_ip = pin_wifi_use_cached_lease();
+        g_wifi.attempt = PIN_WIFI_ATTEMPT_FAST;
+        ESP_LOGI(TAG, "Fast connect to " MACSTR " on channel %u%s", MAC2STR(g_wifi.cache.bssid),
+                 (unsigned)g_wifi.cache.channel, g_wifi.static_ip ? " with cached lease" : "");
+    } else {
+        pin_wifi_configure_scan(&config);
+    }
+
+    esp_wifi_set_config(WIFI_IF_STA, &config);
+    esp_wifi_connect();
+}
+
+static void pin_wifi_retry_timer_cb(void *arg) {
+    if (!g_wifi.radio_off) {
+        pin_wifi_begin_attempt();
+    }
+}
+
+static void pin_wifi_on_disconnected(const wifi_event_sta_disconnected_t *event) {
+    xEventGroupClearBits(g_wifi.events, WIFI_CONNECTED_BIT);
+    if (g_wifi.radio_off) {
+        g_wifi.attempt = PIN_WIFI_ATTEMPT_NONE;
+        return;
+    }
+
+    if (g_wifi.attempt == PIN_WIFI_ATTEMPT_NONE) {
+        // Lost an established connection; the cache is still the best guess
+        ESP_LOGW(TAG, "Disconnected (reason %d), reconnecting", event->reason);
+        pin_wifi_begin_attempt();
+        return;
+    }
+
+    if (g_wifi.attempt == PIN_WIFI_ATTEMPT_FAST) {
+        // The AP moved channel, went away, or rejected us: scan like a cold start
+        ESP_LOGW(TAG, "Fast connect failed (reason %d), falling back to a scan", event->reason);
+        portENTER_CRITICAL(&s_stats_lock);
+        g_wifi.stats.fallbacks++;
+        portEXIT_CRITICAL(&s_stats_lock);
+
+        wifi_config_t config;
+        esp_wifi_get_config(WIFI_IF_STA, &config);
+        pin_wifi_configure_scan(&config);
+        esp_wifi_set_config(WIFI_IF_STA, &config);
+        esp_wifi_connect();
+        return;
+    }
+
+    if (++g_wifi.retries < PIN_WIFI_MAX_RETRY) {
+        esp_wifi_connect();
+        return;
+    }
+
+    ESP_LOGW(TAG, "Connection failed (reason %d), retrying in %d s", event->reason,
+             PIN_WIFI_RETRY_INTERVAL_MS / 1000);
+    portENTER_CRITICAL(&s_stats_lock);
+    g_wifi.stats.failures++;
+    portEXIT_CRITICAL(&s_stats_lock);
+    g_wifi.attempt = PIN_WIFI_ATTEMPT_NONE;
+    if (g_wifi.retry_timer) {
+        esp_timer_start_once(g_wifi.retry_timer, PIN_WIFI_RETRY_INTERVAL_MS * 1000ULL);
+    }
+}
+
+static void pin_wifi_on_got_ip(const ip_event_got_ip_t *event) {
+    int64_t elapsed_us = esp_timer_get_time() - g_wifi.attempt_start_us;
+    bool fast = g_wifi.attempt == PIN_WIFI_ATTEMPT_FAST;
+
+    portENTER_CRITICAL(&s_stats_lock);
+    g_wifi.stats.connects++;
+    if (fast) {
+        g_wifi.stats.fast_connects++;
+    }
+    g_wifi.stats.last_connect_ms = (uint32_t)(elapsed_us / 1000);
+    g_wifi.stats.last_was_fast = fast;
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    ESP_LOGI(TAG, "Connected in %lld ms (%s), IP " IPSTR, (long long)(elapsed_us / 1000),
+             fast ? (g_wifi.static_ip ? "fast, cached lease" : "fast") : "scan",
+             IP2STR(&event->ip_info.ip));
+    g_wifi.attempt = PIN_WIFI_ATTEMPT_NONE;
+    xEventGroupSetBits(g_wifi.events, WIFI_CONNECTED_BIT);
+
+    // Remember where we found the AP for the next wake or reconnect
+    wifi_ap_record_t ap_info;
+    wifi_config_t config;
+    if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK || esp_wifi_get_config(WIFI_IF_STA, &config) != ESP_OK) {
+        return;
+    }
+    memcpy(g_wifi.cache.ssid, config.sta.ssid, sizeof(g_wifi.cache.ssid));
+    memcpy(g_wifi.cache.bssid, ap_info.bssid, sizeof(g_wifi.cache.bssid));
+    g_wifi.cache.channel = ap_info.primary;
+
+    // A reused lease keeps its original age
+    if (!g_wifi.static_ip) {
+        esp_netif_dns_info_t dns;
+        g_wifi.cache.has_lease = true;
+        g_wifi.cache.ip = event->ip_info;
+        g_wifi.cache.dns.addr = 0;
+        if (esp_netif_get_dns_info(g_wifi.sta_netif, ESP_NETIF_DNS_MAIN, &dns) == ESP_OK) {
+            g_wifi.cache.dns = dns.ip.u_addr.ip4;
+        }
+        g_wifi.cache.lease_time = (int64_t)time(NULL);
+    }
+    g_wifi.cache_valid = true;
+    pin_retain_save(PIN_WIFI_FAST_NAME, PIN_WIFI_FAST_VERSION, &g_wifi.cache, sizeof(g_wifi.cache));
+}
+
+static void pin_wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data) {
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
+        pin_wifi_begin_attempt();
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        pin_wifi_on_disconnected((const wifi_event_sta_disconnected_t *)event_data);
+    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+        pin_wifi_on_got_ip((const ip_event_got_ip_t *)event_data);
+    }
+}
+
 esp_err_t pin_wifi_init(void) {
     ESP_LOGI(TAG, "WiFi initialization");
     
-    ESP_ERROR_CHECK(esp_netif_init());
-    ESP_ERROR_CHECK(esp_event_loop_create_default());
+    // esp_netif and the default event loop are created by pin_system_init();
+    // creating the loop a second time fails with ESP_ERR_INVALID_STATE
+    g_wifi.sta_netif = esp_netif_create_default_wifi_sta();
+    g_wifi.events = xEventGroupCreate();
+    if (!g_wifi.events) {
+        return ESP_ERR_NO_MEM;
+    }
 
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
 
-    ESP_LOGI(TAG, "WiFi initialized successfully");
+    // The saved network was loaded by esp_wifi_init(); per-attempt BSSID and
+    // channel changes must not be written back to flash
+    ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
+
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID,
+                                                        pin_wifi_event_handler, NULL, NULL));
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
+                                                        pin_wifi_event_handler, NULL, NULL));
+
+    const esp_timer_create_args_t retry_timer_args = {
+        .callback = pin_wifi_retry_timer_cb,
+        .name = "wifi_retry",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&retry_timer_args, &g_wifi.retry_timer));
+
+    // Empty after a cold boot, then the first connect scans
+    g_wifi.cache_valid = pin_retain_restore(PIN_WIFI_FAST_NAME, PIN_WIFI_FAST_VERSION,
+                                            &g_wifi.cache, sizeof(g_wifi.cache)) == ESP_OK;
+
+    ESP_LOGI(TAG, "WiFi initialized successfully%s", g_wifi.cache_valid ? ", last AP cached" : "");
     return ESP_OK;
 }
 
@@ -100,7 +333,90 @@ int8_t pin_wifi_get_rssi(void) {
     return -100; // Very weak signal as default
 }
 
+bool pin_wifi_has_saved_config(void) {
+    wifi_config_t config;
+    return esp_wifi_get_config(WIFI_IF_STA, &config) == ESP_OK && config.sta.ssid[0] != '\0';
+}
+
+esp_err_t pin_wifi_get_stats(pin_wifi_stats_t* stats) {
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    portENTER_CRITICAL(&s_stats_lock);
+    *stats = g_wifi.stats;
+    if (g_wifi.radio_on_since_us > 0) {
+        stats->radio_on_ms += (uint32_t)((esp_timer_get_time() - g_wifi.radio_on_since_us) / 1000);
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+    return ESP_OK;
+}
+
+esp_err_t pin_wifi_radio_on(void) {
+    if (!pin_wifi_has_saved_config()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // WIFI_EVENT_STA_START begins the first attempt
+    g_wifi.radio_off = false;
+    esp_err_t ret = esp_wifi_set_mode(WIFI_MODE_STA);
+    if (ret == ESP_OK) {
+        ret = esp_wifi_start();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start station: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    portENTER_CRITICAL(&s_stats_lock);
+    if (g_wifi.radio_on_since_us == 0) {
+        g_wifi.radio_on_since_us = esp_timer_get_time();
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+    return ESP_OK;
+}
+
+esp_err_t pin_wifi_radio_off(void) {
+    portENTER_CRITICAL(&s_stats_lock);
+    if (g_wifi.radio_on_since_us > 0) {
+        g_wifi.stats.radio_on_ms += (uint32_t)((esp_timer_get_time() - g_wifi.radio_on_since_us) / 1000);
+        g_wifi.radio_on_since_us = 0;
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+    
+    g_wifi.radio_off = true;
+    if (g_wifi.retry_timer) {
+        esp_timer_stop(g_wifi.retry_timer);
+    }
+    xEventGroupClearBits(g_wifi.events, WIFI_CONNECTED_BIT);
+    
+    esp_err_t ret = esp_wifi_stop();
+    if (ret != ESP_OK && ret != ESP_ERR_WIFI_NOT_INIT) {
+        ESP_LOGW(TAG, "Failed to stop station: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+bool pin_wifi_radio_is_on(void) {
+    return g_wifi.radio_on_since_us > 0;
+}
+
+esp_err_t pin_wifi_wait_connected(uint32_t timeout_ms) {
+    if (!g_wifi.events) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    EventBits_t bits = xEventGroupWaitBits(g_wifi.events, WIFI_CONNECTED_BIT, pdFALSE, pdTRUE,
+                                           pdMS_TO_TICKS(timeout_ms));
+    return (bits & WIFI_CONNECTED_BIT) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
 esp_err_t pin_wifi_start_config_task(void) {
     ESP_LOGI(TAG, "Starting WiFi configuration task");
-    return ESP_OK;
+    
+    if (!pin_wifi_has_saved_config()) {
+        ESP_LOGI(TAG, "No saved network");
+        return ESP_OK;
+    }
+    return pin_wifi_radio_on();
 }
\ No newline at end of file
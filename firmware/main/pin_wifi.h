@@ -18,6 +18,10 @@ extern "C" {
 #define WIFI_CONNECTED_BIT BIT0
 #define WIFI_FAIL_BIT      BIT1
 
+#define PIN_WIFI_MAX_RETRY 3                // Scan attempts before backing off
+#define PIN_WIFI_RETRY_INTERVAL_MS 30000
+#define PIN_WIFI_LEASE_REUSE_S 3600         // Cached DHCP lease is reused as a static IP up to this age
+
 // WiFi configuration states
 typedef enum {
     WIFI_CONFIG_STATE_IDLE,
@@ -54,6 +58,17 @@ typedef struct {
     bool force_ap_mode;
 } pin_wifi_config_t;
 
+// Connection statistics since boot
+typedef struct {
+    uint32_t connects;
+    uint32_t fast_connects;             // Associated to the cached BSSID and channel without a scan
+    uint32_t fallbacks;                 // Fast attempts that had to fall back to a scan
+    uint32_t failures;                  // Attempts that gave up until the retry timer
+    uint32_t last_connect_ms;           // Attempt start to IP address
+    bool last_was_fast;
+    uint32_t radio_on_ms;               // Time the station was started
+} pin_wifi_stats_t;
+
 /**
  * @brief Initialize WiFi system
  * @return ESP_OK on success
@@ -161,6 +176,38 @@ void pin_wifi_force_ap_mode(bool force);
  */
 pin_wifi_config_state_t pin_wifi_get_state(void);
 
+/**
+ * @brief Get connection statistics
+ * @param stats Output statistics
+ * @return ESP_OK on success
+ */
+esp_err_t pin_wifi_get_stats(pin_wifi_stats_t* stats);
+
+/**
+ * @brief Start the station and connect to the saved network
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if no network is saved
+ */
+esp_err_t pin_wifi_radio_on(void);
+
+/**
+ * @brief Stop the station and the radio without reconnecting
+ * @return ESP_OK on success
+ */
+esp_err_t pin_wifi_radio_off(void);
+
+/**
+ * @brief Check whether the station is started
+ * @return true between pin_wifi_radio_on() and pin_wifi_radio_off()
+ */
+bool pin_wifi_radio_is_on(void);
+
+/**
+ * @brief Wait until the station has an IP address
+ * @param timeout_ms Maximum wait
+ * @return ESP_OK once connected, ESP_ERR_TIMEOUT otherwise
+ */
+esp_err_t pin_wifi_wait_connected(uint32_t timeout_ms);
+
 /**
  * @brief Get AP SSID for configuration
  * @param ssid Buffer to store AP SSID
@@ -33,13 +33,37 @@ function updateUI() {
     }
 }
 
+// Long operations answer 202 with a job; poll it until it ends, giving up on an
+// error reply, an unknown state or after two minutes
+async function waitForJob(response, timeoutMs = 120000) {
+    const job = await response.json();
+    const deadline = Date.now() + timeoutMs;
+    while (true) {
+        const reply = await fetch(`/api/jobs/${job.job_id}`);
+        if (!reply.ok) {
+            throw new Error(`Job ${job.job_id}: HTTP ${reply.status}`);
+        }
+        const status = await reply.json();
+        if (status.state === 'done' || status.state === 'failed') {
+            return status;
+        }
+        if (status.state !== 'queued' && status.state !== 'running') {
+            throw new Error(`Job ${job.job_id}: unknown state ${status.state}`);
+        }
+        if (Date.now() >= deadline) {
+            throw new Error(`Job ${job.job_id}: timed out`);
+        }
+        await new Promise(resolve => setTimeout(resolve, 1000));
+    }
+}
+
 // Refresh display
 async function refreshDisplay() {
     try {
         const response = await fetch('/api/display/refresh', {
             method: 'POST'
         });
-        if (response.ok) {
+        if (response.ok && (await waitForJob(response)).state === 'done') {
             alert('Display refreshed');
         } else {
             alert('Failed to refresh display');
@@ -104,10 +104,8 @@ static esp_err_t clock_update(pin_plugin_context_t* ctx) {
         data->time_changed = true;
         
         // Update widget content
-        if (ctx->widget_region.content) {
-            free(ctx->widget_region.content);
-        }
-        ctx->widget_region.content = strdup(current_time);
+        pin_plugin_free(ctx, ctx->widget_region.content);
+        ctx->widget_region.content = pin_plugin_strdup(ctx, current_time);
         ctx->widget_region.dirty = true;
         
         // Update display content through API
@@ -239,10 +237,8 @@ static esp_err_t clock_stop(pin_plugin_context_t* ctx) {
     ctx->api.log_info(TAG, "Stopping clock plugin");
     
     // Clear display content
-    if (ctx->widget_region.content) {
-        free(ctx->widget_region.content);
-        ctx->widget_region.content = NULL;
-    }
+    pin_plugin_free(ctx, ctx->widget_region.content);
+    ctx->widget_region.content = NULL;
     
     ctx->widget_region.visible = false;
     ctx->widget_region.dirty = true;
@@ -256,14 +252,12 @@ static esp_err_t clock_cleanup(pin_plugin_context_t* ctx) {
     
     if (ctx->plugin->private_data) {
         clock_private_data_t* data = (clock_private_data_t*)ctx->plugin->private_data;
-        pin_plugin_free(ctx, data, sizeof(clock_private_data_t));
+        pin_plugin_free(ctx, data);
         ctx->plugin->private_data = NULL;
     }
     
-    if (ctx->widget_region.content) {
-        free(ctx->widget_region.content);
-        ctx->widget_region.content = NULL;
-    }
+    pin_plugin_free(ctx, ctx->widget_region.content);
+    ctx->widget_region.content = NULL;
     
     ctx->api.log_info(TAG, "Clock plugin cleaned up");
     return ESP_OK;
@@ -986,6 +986,27 @@ class PinDeviceAPI {
         }
     }
     
+    // 耗时操作返回202和任务ID，轮询到任务结束；请求失败、状态未知或超时则放弃
+    async waitForJob(job, intervalMs = 1000, timeoutMs = 120000) {
+        const deadline = Date.now() + timeoutMs;
+        while (true) {
+            const status = await this.request(`/api/jobs/${job.job_id}`);
+            if (status.state === 'done') {
+                return status;
+            }
+            if (status.state === 'failed') {
+                throw new Error(`任务失败: ${status.error}`);
+            }
+            if (status.state !== 'queued' && status.state !== 'running') {
+                throw new Error(`任务状态未知: ${status.state}`);
+            }
+            if (Date.now() >= deadline) {
+                throw new Error('任务超时');
+            }
+            await new Promise(resolve => setTimeout(resolve, intervalMs));
+        }
+    }
+    
     // API方法
     async getDeviceStatus() {
         return this.request('/api/status');
@@ -1066,10 +1087,11 @@ class PinDeviceAPI {
     }
     
     async displayCanvas(canvasId) {
-        return this.request('/api/canvas/display', {
+        const job = await this.request('/api/canvas/display', {
             method: 'POST',
             body: JSON.stringify({ canvas_id: canvasId })
         });
+        return this.waitForJob(job);
     }
     
     async addCanvasElement(canvasId, element) {
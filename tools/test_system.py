@@ -7,6 +7,7 @@ Pin Device System Test Script
 import requests
 import json
 import time
+import hashlib
 import argparse
 import sys
 from typing import Dict, Any, Optional
@@ -74,7 +75,7 @@ class PinDeviceTest:
             response = self.session.get(f"{self.base_url}/api/status", timeout=self.timeout)
             if response.status_code == 200:
                 status = response.json()
-                required_fields = ["device", "battery", "wifi"]
+                required_fields = ["device", "battery", "wifi", "time"]
                 
                 for field in required_fields:
                     if field not in status:
@@ -176,6 +177,256 @@ class PinDeviceTest:
             self.log_test("Plugin List", False, str(e))
             return False
     
+    def test_plugin_stats(self) -> bool:
+        """测试插件统计API"""
+        try:
+            response = self.session.get(f"{self.base_url}/api/plugins/stats", timeout=self.timeout)
+            if response.status_code == 200:
+                data = response.json()
+                plugins = data.get("plugins")
+                
+                if not isinstance(plugins, list):
+                    self.log_test("Plugin Stats", False, "plugins should be a list")
+                    return False
+                
+                # 验证统计字段
+                for plugin in plugins:
+                    required_fields = ["name", "cpu_time_ms", "blocked_http_ms", "blocked_display_ms",
+                                       "update_p50_ms", "update_p99_ms", "throttled"]
+                    for field in required_fields:
+                        if field not in plugin:
+                            self.log_test("Plugin Stats", False, f"Plugin missing field: {field}")
+                            return False
+                    
+                    if plugin["update_p50_ms"] > plugin["update_p99_ms"]:
+                        self.log_test("Plugin Stats", False, f"{plugin['name']}: p50 above p99")
+                        return False
+                
+                self.log_test("Plugin Stats", True, f"Stats for {len(plugins)} plugins")
+                return True
+            else:
+                self.log_test("Plugin Stats", False, f"HTTP {response.status_code}")
+                return False
+        except (requests.exceptions.RequestException, json.JSONDecodeError) as e:
+            self.log_test("Plugin Stats", False, str(e))
+            return False
+    
+    def test_plugin_memory(self) -> bool:
+        """测试插件内存：每个插件（包括未指定memory_limit的）都分到能放进内存池的arena并已启用"""
+        try:
+            response = self.session.get(f"{self.base_url}/api/plugins/stats", timeout=self.timeout)
+            if response.status_code != 200:
+                self.log_test("Plugin Memory", False, f"HTTP {response.status_code}")
+                return False
+            
+            data = response.json()
+            pool_size = data.get("memory_pool_size", 0)
+            plugins = data.get("plugins", [])
+            if pool_size <= 0:
+                self.log_test("Plugin Memory", False, "memory_pool_size missing")
+                return False
+            
+            reserved = 0
+            for plugin in plugins:
+                limit = plugin.get("memory_limit", 0)
+                if limit <= 0 or limit > pool_size:
+                    self.log_test("Plugin Memory", False,
+                                  f"{plugin['name']}: limit {limit} outside pool of {pool_size}")
+                    return False
+                if not plugin.get("enabled"):
+                    self.log_test("Plugin Memory", False, f"{plugin['name']}: not enabled")
+                    return False
+                if plugin.get("memory_used", 0) > limit:
+                    self.log_test("Plugin Memory", False, f"{plugin['name']}: uses more than its limit")
+                    return False
+                reserved += limit
+            
+            if reserved + data.get("memory_pool_free", 0) > pool_size:
+                self.log_test("Plugin Memory", False, "Arenas and free space exceed the pool")
+                return False
+            
+            self.log_test("Plugin Memory", True, f"{reserved} of {pool_size} bytes reserved by {len(plugins)} plugins")
+            return True
+        except (requests.exceptions.RequestException, json.JSONDecodeError) as e:
+            self.log_test("Plugin Memory", False, str(e))
+            return False
+    
+    def test_boot_timeline(self) -> bool:
+        """测试启动时间线API"""
+        try:
+            response = self.session.get(f"{self.base_url}/api/boot/timeline", timeout=self.timeout)
+            if response.status_code == 200:
+                data = response.json()
+                stages = data.get("stages")
+                
+                if not isinstance(stages, list) or not stages:
+                    self.log_test("Boot Timeline", False, "stages should be a non-empty list")
+                    return False
+                
+                for stage in stages:
+                    for field in ["name", "state", "start_ms", "end_ms"]:
+                        if field not in stage:
+                            self.log_test("Boot Timeline", False, f"Stage missing field: {field}")
+                            return False
+                    
+                    if stage["state"] == "done" and stage["end_ms"] < stage["start_ms"]:
+                        self.log_test("Boot Timeline", False, f"{stage['name']}: ends before it starts")
+                        return False
+                
+                self.log_test("Boot Timeline", True,
+                              f"{len(stages)} stages, {data['boot_ms']:.0f} ms (serial {data['serial_ms']:.0f} ms)")
+                return True
+            else:
+                self.log_test("Boot Timeline", False, f"HTTP {response.status_code}")
+                return False
+        except (requests.exceptions.RequestException, json.JSONDecodeError) as e:
+            self.log_test("Boot Timeline", False, str(e))
+            return False
+    
+    def test_power_stats(self) -> bool:
+        """测试电源状态统计API"""
+        try:
+            response = self.session.get(f"{self.base_url}/api/power/stats", timeout=self.timeout)
+            if response.status_code == 200:
+                data = response.json()
+                states = data.get("states", {})
+                
+                for field in ["active_ms", "idle_ms", "light_sleep_ms"]:
+                    if field not in states:
+                        self.log_test("Power Stats", False, f"Missing state: {field}")
+                        return False
+                
+                # This request itself runs with the HTTP client holding the full clock
+                http = next((c for c in data.get("clients", []) if c.get("name") == "http"), None)
+                if not http or http.get("acquisitions", 0) < 1:
+                    self.log_test("Power Stats", False, "HTTP client lock never taken")
+                    return False
+                
+                self.log_test("Power Stats", True,
+                              f"active {states['active_ms']:.0f} ms, idle {states['idle_ms']:.0f} ms, "
+                              f"light sleep {states['light_sleep_ms']:.0f} ms")
+                return True
+            else:
+                self.log_test("Power Stats", False, f"HTTP {response.status_code}")
+                return False
+        except (requests.exceptions.RequestException, json.JSONDecodeError) as e:
+            self.log_test("Power Stats", False, str(e))
+            return False
+    
+    def test_web_assets(self) -> bool:
+        """测试网页资源的gzip与ETag缓存"""
+        try:
+            response = self.session.get(f"{self.base_url}/app.js", timeout=self.timeout)
+            if response.status_code != 200:
+                self.log_test("Web Assets", False, f"HTTP {response.status_code}")
+                return False
+            
+            etag = response.headers.get("ETag")
+            if response.headers.get("Content-Encoding") != "gzip" or not etag:
+                self.log_test("Web Assets", False, "Missing gzip encoding or ETag")
+                return False
+            
+            # A matching ETag must not resend the body
+            response = self.session.get(f"{self.base_url}/app.js", headers={"If-None-Match": etag},
+                                        timeout=self.timeout)
+            if response.status_code != 304 or response.content:
+                self.log_test("Web Assets", False, f"Revalidation returned HTTP {response.status_code}")
+                return False
+            
+            self.log_test("Web Assets", True, f"gzip, ETag {etag}, 304 on revalidation")
+            return True
+        except requests.exceptions.RequestException as e:
+            self.log_test("Web Assets", False, str(e))
+            return False
+    
+    def test_canvas_list(self) -> bool:
+        """测试画布索引分页列表"""
+        try:
+            response = self.session.get(f"{self.base_url}/api/canvas", params={"limit": 1}, timeout=self.timeout)
+            if response.status_code != 200:
+                self.log_test("Canvas List", False, f"HTTP {response.status_code}")
+                return False
+            
+            data = response.json()
+            for field in ["canvases", "total", "offset", "limit"]:
+                if field not in data:
+                    self.log_test("Canvas List", False, f"Missing field: {field}")
+                    return False
+            
+            if len(data["canvases"]) > 1 or len(data["canvases"]) > data["total"]:
+                self.log_test("Canvas List", False, "Page larger than the limit or total")
+                return False
+            
+            self.log_test("Canvas List", True, f"{data['total']} canvases, page of {len(data['canvases'])}")
+            return True
+        except (requests.exceptions.RequestException, json.JSONDecodeError) as e:
+            self.log_test("Canvas List", False, str(e))
+            return False
+    
+    def test_image_upload(self) -> bool:
+        """测试图片流式上传（超过原64KB内存上限）"""
+        try:
+            # PNG签名加随机内容，校验格式识别和SHA-256
+            data = b"\x89PNG\r\n\x1a\n" + bytes(i * 7 % 251 for i in range(96 * 1024))
+            response = self.session.post(f"{self.base_url}/api/images", params={"id": "test_upload"},
+                                         data=data, timeout=self.timeout * 4)
+            if response.status_code != 201:
+                self.log_test("Image Upload", False, f"HTTP {response.status_code}")
+                return False
+            
+            result = response.json()
+            if result.get("size") != len(data) or result.get("sha256") != hashlib.sha256(data).hexdigest():
+                self.log_test("Image Upload", False, "Size or SHA-256 mismatch")
+                return False
+            if result.get("format") != 1:
+                self.log_test("Image Upload", False, f"Detected format {result.get('format')}, expected PNG")
+                return False
+            
+            self.log_test("Image Upload", True, f"{len(data)} bytes streamed, SHA-256 verified")
+            return True
+        except (requests.exceptions.RequestException, json.JSONDecodeError) as e:
+            self.log_test("Image Upload", False, str(e))
+            return False
+    
+    def test_jobs(self) -> bool:
+        """测试异步任务：刷新返回202，刷新期间服务器仍可响应"""
+        try:
+            response = self.session.post(f"{self.base_url}/api/display/refresh", timeout=self.timeout)
+            if response.status_code != 202:
+                self.log_test("Jobs", False, f"Refresh returned HTTP {response.status_code}, expected 202")
+                return False
+            
+            job_id = response.json().get("job_id")
+            slowest = 0.0
+            deadline = time.time() + 60
+            state = "queued"
+            while state in ("queued", "running") and time.time() < deadline:
+                start = time.time()
+                self.session.get(f"{self.base_url}/api/status", timeout=self.timeout)
+                slowest = max(slowest, time.time() - start)
+                
+                job = self.session.get(f"{self.base_url}/api/jobs/{job_id}", timeout=self.timeout).json()
+                state = job.get("state")
+                time.sleep(0.5)
+            
+            if state not in ("done", "failed"):
+                self.log_test("Jobs", False, f"Job {job_id} still {state} after 60 s")
+                return False
+            if slowest > 2.0:
+                self.log_test("Jobs", False, f"Status took {slowest:.1f} s during the refresh")
+                return False
+            
+            missing = self.session.get(f"{self.base_url}/api/jobs/999999", timeout=self.timeout)
+            if missing.status_code != 404:
+                self.log_test("Jobs", False, f"Unknown job returned HTTP {missing.status_code}")
+                return False
+            
+            self.log_test("Jobs", True, f"Job {job_id} {state}, status answered within {slowest:.2f} s meanwhile")
+            return True
+        except (requests.exceptions.RequestException, json.JSONDecodeError) as e:
+            self.log_test("Jobs", False, str(e))
+            return False
+    
     def test_settings_api(self) -> bool:
         """测试设置API"""
         try:
@@ -223,6 +474,14 @@ class PinDeviceTest:
             self.test_api_status,
             self.test_wifi_scan,
             self.test_plugin_list,
+            self.test_plugin_stats,
+            self.test_plugin_memory,
+            self.test_boot_timeline,
+            self.test_power_stats,
+            self.test_web_assets,
+            self.test_canvas_list,
+            self.test_image_upload,
+            self.test_jobs,
             self.test_settings_api
         ]
         
@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""
+Pin Web Asset Builder
+把网页资源压缩并生成固件内嵌的C源文件
+
+Minifies and gzips the files served by the firmware's web server and writes
+a C source with the compressed bytes, content types and strong ETags (see
+firmware/main/pin_web_assets.h). Run by the main component's CMakeLists.txt
+on every build where an asset changed; `make web-build` runs it by hand and
+prints the size report.
+"""
+
+import argparse
+import gzip
+import hashlib
+import json
+import os
+import re
+import sys
+
+CONTENT_TYPES = {
+    ".html": "text/html",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".css": "text/css",
+    ".svg": "image/svg+xml",
+}
+
+# Whitespace inside these is content, leave it alone
+PRESERVE_TAGS = re.compile(r"<(pre|textarea)\b", re.IGNORECASE)
+PRESERVE_END_TAGS = re.compile(r"</(pre|textarea)>", re.IGNORECASE)
+HTML_COMMENT = re.compile(r"<!--(?!\[if).*?-->", re.DOTALL)
+
+
+def minify_lines(text: str) -> str:
+    """Strip indentation, blank lines and whole-line // comments.
+
+    Works line by line so line breaks (and with them automatic semicolon
+    insertion) are kept. Lines inside a template literal or <pre>/<textarea>
+    are copied unchanged.
+    """
+    out = []
+    in_template = False
+    in_preserve = False
+    for line in text.splitlines():
+        if in_template or in_preserve:
+            out.append(line)
+        else:
+            stripped = line.strip()
+            if stripped and not stripped.startswith("//"):
+                out.append(stripped)
+        if line.count("`") % 2 == 1:
+            in_template = not in_template
+        if PRESERVE_TAGS.search(line):
+            in_preserve = True
+        if PRESERVE_END_TAGS.search(line):
+            in_preserve = False
+    return "\n".join(out) + "\n"
+
+
+def minify(name: str, data: bytes) -> bytes:
+    ext = os.path.splitext(name)[1].lower()
+    if ext == ".json":
+        return json.dumps(json.loads(data), ensure_ascii=False, separators=(",", ":")).encode("utf-8")
+    if ext == ".html":
+        return minify_lines(HTML_COMMENT.sub("", data.decode("utf-8"))).encode("utf-8")
+    if ext in (".js", ".css"):
+        return minify_lines(data.decode("utf-8")).encode("utf-8")
+    return data
+
+
+def c_identifier(name: str) -> str:
+    return "s_" + re.sub(r"[^0-9A-Za-z]", "_", name)
+
+
+def c_bytes(data: bytes) -> str:
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join(f"0x{b:02x}" for b in data[i:i + 16]) + ",")
+    return "\n".join(lines)
+
+
+def build(paths, output):
+    assets = []
+    for path in paths:
+        name = os.path.basename(path)
+        with open(path, "rb") as f:
+            original = f.read()
+        # mtime=0 keeps the stream, and so the ETag, stable across builds
+        compressed = gzip.compress(minify(name, original), compresslevel=9, mtime=0)
+        etag = hashlib.sha256(compressed).hexdigest()[:16]
+        content_type = CONTENT_TYPES.get(os.path.splitext(name)[1].lower(), "application/octet-stream")
+        assets.append((name, content_type, etag, compressed, len(original)))
+
+    parts = [
+        "// Generated by tools/web_assets.py, do not edit",
+        "",
+        '#include "pin_web_assets.h"',
+        "",
+    ]
+    for name, _, _, compressed, _ in assets:
+        parts.append(f"static const uint8_t {c_identifier(name)}[{len(compressed)}] = {{")
+        parts.append(c_bytes(compressed))
+        parts.append("};")
+        parts.append("")
+    parts.append("const pin_web_asset_t pin_web_assets[] = {")
+    for name, content_type, etag, compressed, original_size in assets:
+        parts.append(f'    {{ "{name}", "{content_type}", "\\"{etag}\\"", '
+                     f"{c_identifier(name)}, {len(compressed)}, {original_size} }},")
+    parts.append("};")
+    parts.append("")
+    parts.append(f"const size_t pin_web_asset_count = {len(assets)};")
+    parts.append("")
+
+    with open(output, "w", encoding="utf-8") as f:
+        f.write("\n".join(parts))
+    return assets
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Minify and gzip web assets into a C source")
+    parser.add_argument("-o", "--output", required=True, help="C file to generate")
+    parser.add_argument("-q", "--quiet", action="store_true", help="no size report")
+    parser.add_argument("assets", nargs="+", help="files to embed")
+    args = parser.parse_args()
+
+    assets = build(args.assets, args.output)
+    if not args.quiet:
+        total_in = total_out = 0
+        for name, _, etag, compressed, original_size in assets:
+            total_in += original_size
+            total_out += len(compressed)
+            print(f"{name:<16} {original_size:>7} -> {len(compressed):>6} bytes  etag {etag}")
+        print(f"{'total':<16} {total_in:>7} -> {total_out:>6} bytes")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())